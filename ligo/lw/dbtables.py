@@ -59,6 +59,7 @@ from xml.sax.xmlreader import AttributesImpl
 from . import __author__, __date__, __version__
 from . import ligolw
 from . import lsctables
+from . import tokenizer
 from . import types as ligolwtypes
 from . import utils as ligolw_utils
 
@@ -552,6 +553,105 @@ def get_xml(connection, table_names = None):
 	return ligo_lw
 
 
+#
+# =============================================================================
+#
+#                               In-Memory Tables
+#
+# =============================================================================
+#
+
+
+def register_table(connection, tbl, name = None, verbose = False):
+	"""
+	Make the rows of the ligolw.Table object tbl available to SQL
+	queries on the sqlite3 connection object connection, e.g., to join
+	the contents of a document loaded with ligo.lw.utils.load_filename()
+	against the contents of a database.  A temporary virtual table (it
+	is not written to the database file) named name, or the Table's
+	name if name is None, is created that reads the Table's rows in
+	place, without copying them.  The return value is the name.  An
+	existing temporary table by that name is replaced.
+
+	The virtual table has the Table's columns.  Attributes that are not
+	set in a row are NULL.  Equality and range constraints on the
+	Table's ID column, on the columns containing references to other
+	Tables' IDs, and on columns whose names end in "_time" (GPS times)
+	are satisfied with a sorted index of the rows, built when a query
+	first needs it, so that look-ups by ID and time-range queries, and
+	joins on them, do not scan the Table for every row of the other
+	table.  The class' .constraints are not imposed, because documents
+	that have not yet been merged can contain repeated IDs.
+
+	Queries see the rows of the Table as they are when the query is
+	run.  The Table is kept alive until the temporary table is replaced
+	or the connection is closed.  The virtual table cannot be modified
+	with SQL.
+
+	The virtual table is implemented by the tokenizer module, which
+	must have been built with SQLite's headers and against the SQLite
+	library used by the sqlite3 module.  The database handle is
+	retrieved from the sqlite3.Connection object's internal layout,
+	which is only known for Python 3.8 through 3.13.  RuntimeError is
+	raised if these requirements are not met.
+
+	Example:
+
+	>>> import sqlite3
+	>>> from ligo.lw import lsctables
+	>>> tbl = lsctables.SnglBurstTable.new(["event_id", "ifo", "peak_time", "peak_time_ns", "snr"])
+	>>> for i, ifo in enumerate(("H1", "L1", "V1")):
+	...	tbl.append(tbl.RowType(event_id = i, ifo = ifo, peak_time = 1000000000 + i, peak_time_ns = 0, snr = 5. + i))
+	...
+	>>> connection = sqlite3.connect(":memory:")
+	>>> register_table(connection, tbl)
+	'sngl_burst'
+	>>> connection.execute("SELECT ifo, snr FROM sngl_burst WHERE peak_time >= 1000000001 ORDER BY event_id").fetchall()
+	[('L1', 6.0), ('V1', 7.0)]
+	>>> del tbl[0].snr	# not set
+	>>> connection.execute("SELECT ifo, snr FROM sngl_burst WHERE event_id == 0").fetchall()
+	[('H1', None)]
+	>>> cursor = connection.execute("CREATE TABLE vetoed (ifo TEXT)")
+	>>> cursor = connection.execute("INSERT INTO vetoed VALUES ('L1')")
+	>>> connection.execute("SELECT event_id FROM sngl_burst JOIN vetoed USING (ifo)").fetchall()
+	[(1,)]
+	"""
+	if connection_db_type(connection) != "sqlite":
+		raise ValueError("register_table() requires an SQLite database")
+	try:
+		create_module = tokenizer.sqlite_create_module
+	except AttributeError:
+		raise RuntimeError("the tokenizer module was built without SQLite support")
+	if name is None:
+		name = tbl.Name
+	if verbose:
+		sys.stderr.write("creating virtual table '%s' for %d rows of %s table ...\n" % (name, len(tbl), tbl.Name))
+
+	try:
+		types = [ligolwtypes.ToSQLiteType[coltype] for coltype in tbl.columntypes]
+	except KeyError as e:
+		raise ValueError("column type '%s' not supported" % str(e))
+
+	indexed = []
+	for column in tbl.getElementsByTagName(ligolw.Column.tagName):
+		try:
+			column.table_name
+		except ValueError:
+			is_reference = False
+		else:
+			is_reference = True
+		indexed.append(is_reference or (tbl.next_id is not None and column.Name == tbl.next_id.column_name) or column.Name.endswith("_time"))
+
+	# one module for each virtual table, holding the Table.  replacing
+	# the module releases the previous Table
+	cursor = connection.cursor()
+	cursor.execute("DROP TABLE IF EXISTS temp.%s" % name)
+	create_module(connection, "ligolw_%s" % name, tbl, tbl.columnnames, types, indexed)
+	cursor.execute("CREATE VIRTUAL TABLE temp.%s USING ligolw_%s" % (name, name))
+	cursor.close()
+	return name
+
+
 #
 # =============================================================================
 #
@@ -595,7 +695,8 @@ class DBTable(ligolw.Table):
 	Example:
 
 	>>> import sqlite3
-	>>> connection = sqlite3.connection()
+	>>> from ligo.lw import dbtables
+	>>> connection = sqlite3.connect(":memory:")
 	>>> tbl = dbtables.DBTable(AttributesImpl({"Name": "process:table"}), connection = connection)
 
 	A custom content handler must be created in order to pass the
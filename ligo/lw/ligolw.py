@@ -33,18 +33,22 @@ constructing a parser.
 """
 
 
+import binascii
 import copy
 import datetime
 import dateutil.parser
 import itertools
 import numpy
+import pickle
 import re
 import sys
+import tempfile
 from xml import sax
 from xml.sax.xmlreader import AttributesImpl
 from xml.sax.saxutils import escape as xmlescape
 from xml.sax.saxutils import unescape as xmlunescape
 import yaml
+import zlib
 
 
 from . import __author__, __date__, __version__
@@ -741,6 +745,21 @@ class Param(Element):
 class Stream(Element):
 	"""
 	Stream element.
+
+	The Streams of Tables and Arrays can compute the CRC-32 checksum of
+	their text as it is parsed or written, so that the integrity of a
+	file can be checked without reading it a second time.  When a
+	document is parsed, the checksum is computed if the content
+	handler's .crc32 attribute is True (see the crc32 argument of
+	ligo.lw.utils.load_fileobj()), and when the Stream is written, if
+	the Stream's crc32_param attribute is not None.  The checksum is
+	stored in the .crc32 attribute, which is otherwise None.  The
+	checksum is of the UTF-8 encoding of the Stream's text, all of the
+	text between its start and end tags after XML entities have been
+	replaced, so it depends on the formatting of the rows as well as
+	their values.  If crc32_param is a Param element, its value is set
+	to the checksum when the Stream is written.  See
+	ligo.lw.utils.add_crc32_params().
 	"""
 	tagName = "Stream"
 
@@ -750,11 +769,43 @@ class Stream(Element):
 	Name = attributeproxy("Name")
 	Type = attributeproxy("Type", default = "Local")
 
+	crc32 = None
+	crc32_param = None
+
 	def __init__(self, *args):
 		super(Stream, self).__init__(*args)
 		if self.Type not in ("Remote", "Local"):
 			raise ElementError("invalid Type for Stream: '%s'" % self.Type)
 
+	def update_crc32(self, content):
+		"""
+		Add the text content to the CRC-32 checksum in .crc32.
+		"""
+		self.crc32 = zlib.crc32(content.encode("utf-8"), self.crc32 or 0)
+
+	def crc32_write(self, write):
+		"""
+		If the checksum is to be computed, reset .crc32 and return a
+		function that adds the XML-escaped text passed to it to the
+		checksum, then passes it to write.  Otherwise return write.
+		Used to write the Stream's text.
+		"""
+		if self.crc32_param is None:
+			return write
+		self.crc32 = 0
+		def w(text):
+			self.update_crc32(xmlunescape(text))
+			write(text)
+		return w
+
+	def crc32_done(self):
+		"""
+		Called when the Stream's text has been written.  Records the
+		checksum in crc32_param, if set.
+		"""
+		if self.crc32_param is not None:
+			self.crc32_param.value = self.crc32
+
 
 class Table(EmptyElement, list):
 	"""
@@ -908,6 +959,8 @@ class Table(EmptyElement, list):
 			return self
 
 		def appendData(self, content):
+			if self.crc32 is not None:
+				self.update_crc32(content)
 			# tokenize buffer, pack into row objects, and
 			# append to Table
 			appendfunc = self.parentNode.append
@@ -924,11 +977,44 @@ class Table(EmptyElement, list):
 			# final token was pure whitespace in order to
 			# unambiguously indicate that token's presence
 			if not self._tokenizer.data.isspace():
+				# the delimiter is not part of the text
+				crc32 = self.crc32
 				self.appendData(self.Delimiter)
+				self.crc32 = crc32
 			# now we're done with these
 			del self._tokenizer
 			del self._rowbuilder
 
+		def checkpoint(self):
+			"""
+			Return the state of the parser while the Stream's
+			text is being read:  the unparsed remainder of the
+			text seen so far, the index of the column the next
+			token belongs to, and a tuple of the values already
+			assigned to the incomplete row, if any.  The state
+			contains no row objects, only the values the
+			columns' Python types produce.  Passing it to
+			.restore() on a freshly started Stream in the same
+			Table allows the parsing to continue from the text
+			that follows, without feeding the earlier text
+			again.
+			"""
+			row = self._rowbuilder.row
+			values = tuple(getattr(row, name) for name in self._rowbuilder.attributes[:self._rowbuilder.i]) if row is not None else ()
+			return self._tokenizer.data, self._tokenizer.type_index, values
+
+		def restore(self, state):
+			"""
+			Restore a parser state obtained from .checkpoint().
+			"""
+			data, type_index, values = state
+			self._tokenizer.append(data)
+			self._tokenizer.type_index = type_index
+			# fewer values than a row needs, so this starts
+			# the incomplete row and yields nothing
+			for row in self._rowbuilder.append(values):
+				raise ValueError("invalid parser state")
+
 		def write(self, fileobj = sys.stdout, indent = ""):
 			# retrieve the .write() method of the file object
 			# to avoid doing the attribute lookup in loops
@@ -937,6 +1023,7 @@ class Table(EmptyElement, list):
 			# because we need to not put a delimiter at the end
 			# of the last row unless it ends with a null token
 			w(self.start_tag(indent))
+			w = self.crc32_write(w)
 			rowdumper = tokenizer.RowDumper(self.parentNode.columnnames, [ligolwtypes.FormatFunc[coltype] for coltype in self.parentNode.columntypes], self.Delimiter)
 			rowdumper.dump(self.parentNode)
 			try:
@@ -968,7 +1055,9 @@ class Table(EmptyElement, list):
 					# to indicate that a token is
 					# present
 					w(rowdumper.delimiter)
-			w("\n" + self.end_tag(indent) + "\n")
+			w("\n" + indent)
+			self.crc32_done()
+			fileobj.write(self.end_tag("") + "\n")
 
 	class RowType(object):
 		"""
@@ -990,7 +1079,20 @@ class Table(EmptyElement, list):
 		Also provides .__getstate__() and .__setstate__() methods
 		to allow row objects to be pickled (otherwise, because they
 		all use __slots__ to reduce their memory footprint, they
-		aren't pickleable).
+		aren't pickleable).  If all of the attributes are set, the
+		state is a tuple of the values in __slots__ order, which
+		avoids pickling the attribute names with every row.
+
+		Example:
+
+		>>> import pickle
+		>>> from ligo.lw import lsctables
+		>>> row = lsctables.SnglBurst(ifo = "H1", snr = 8.5)
+		>>> row.__getstate__()	# not all attributes are set
+		{'ifo': 'H1', 'snr': 8.5}
+		>>> row = pickle.loads(pickle.dumps(row))
+		>>> row.ifo, row.snr
+		('H1', 8.5)
 		"""
 		def __init__(self, **kwargs):
 			for key, value in kwargs.items():
@@ -999,10 +1101,17 @@ class Table(EmptyElement, list):
 		def __getstate__(self):
 			if not hasattr(self, "__slots__"):
 				raise NotImplementedError
-			return dict((key, getattr(self, key)) for key in self.__slots__ if hasattr(self, key))
+			try:
+				return tuple(getattr(self, key) for key in self.__slots__)
+			except AttributeError:
+				return dict((key, getattr(self, key)) for key in self.__slots__ if hasattr(self, key))
 
 		def __setstate__(self, state):
-			self.__init__(**state)
+			if isinstance(state, tuple):
+				for key, value in zip(self.__slots__, state):
+					setattr(self, key, value)
+			else:
+				self.__init__(**state)
 
 	@property
 	def columnnames(self):
@@ -1153,6 +1262,79 @@ class Table(EmptyElement, list):
 		new._end_of_columns()
 		return new
 
+	def __copy__(self):
+		# the default would go through .__reduce_ex__(), which
+		# duplicates the rows.  a shallow copy shares them
+		new = list.__new__(type(self))
+		new.__dict__.update(self.__dict__)
+		new.extend(self)
+		return new
+
+	def __reduce_ex__(self, protocol):
+		"""
+		Pickling support.  Rows are not pickled one-by-one, instead
+		the values in each column are packed into typed buffers by
+		the tokenizer module's pack_columns() function and the rows
+		are reconstructed from them by unpack_columns().  This
+		reduces the size of the pickle and the time required to
+		create and load it considerably, which helps when Tables
+		are passed between processes, for example by the
+		multiprocessing module.  Attributes of the rows that are not
+		among the Table's columns, if set on any row, are preserved
+		too, as Python objects, so copy.deepcopy() gives the same
+		rows.  The Table's children, its XML attributes, and its
+		parentNode are pickled normally.  With pickle protocol 5 or higher the
+		buffers are provided as pickle.PickleBuffer objects, so
+		they can be transfered out-of-band.
+
+		Example:
+
+		>>> import pickle
+		>>> from ligo.lw import lsctables
+		>>> tbl = lsctables.SnglBurstTable.new(["event_id", "ifo", "snr"])
+		>>> tbl.append(tbl.RowType(event_id = 0, ifo = "H1", snr = 8.5))
+		>>> tbl.append(tbl.RowType(event_id = 1, ifo = "L1", snr = None))
+		>>> new = pickle.loads(pickle.dumps(tbl))
+		>>> [(row.event_id, row.ifo, row.snr) for row in new]
+		[(0, 'H1', 8.5), (1, 'L1', None)]
+		>>> new.columnnames
+		['event_id', 'ifo', 'snr']
+		>>> import copy
+		>>> tbl = lsctables.SnglBurstTable.new(["event_id", "snr"])
+		>>> tbl.append(tbl.RowType(event_id = 0, snr = 8.5, ifo = "H1"))
+		>>> copy.deepcopy(tbl)[0].ifo
+		'H1'
+		"""
+		names = self.columnnames
+		columns = tokenizer.pack_columns(self, names, "".join(ligolwtypes.ToBufferCode[coltype] for coltype in self.columntypes))
+		if self:
+			# keep the other attributes that are set in at
+			# least one row.  mask is None or has a 2 for each
+			# row in which the attribute is not set
+			for name in [name for name in getattr(self.RowType, "__slots__", ()) if name not in names]:
+				column, = tokenizer.pack_columns(self, (name,), "O")
+				mask = column[1]
+				if mask is None or mask.count(2) != len(mask):
+					names.append(name)
+					columns += (column,)
+		if protocol >= 5:
+			columns = tuple((code, mask, data if code == "O" else pickle.PickleBuffer(data), blob if blob is None else pickle.PickleBuffer(blob)) for code, mask, data, blob in columns)
+		return self._from_packed_columns, (names, len(self), columns, sys.byteorder), self.__dict__
+
+	@classmethod
+	def _from_packed_columns(cls, names, n, columns, byteorder):
+		"""
+		Used by .__reduce_ex__().  For internal use only.
+		"""
+		if byteorder != sys.byteorder:
+			# pickle was created on a machine with the other
+			# byte order.  all packed buffers except the masks
+			# and the blobs are made of 8 byte words
+			columns = [(code, mask, data if code == "O" else numpy.frombuffer(data, dtype = "uint64").byteswap().tobytes(), blob) for code, mask, data, blob in columns]
+		new = list.__new__(cls)
+		new.extend(tokenizer.unpack_columns(cls.RowType, names, n, columns))
+		return new
+
 	@classmethod
 	def ensure_exists(cls, xmldoc, create_new = True, columns = None):
 		"""
@@ -1315,6 +1497,182 @@ class Table(EmptyElement, list):
 		self.append(row)
 		return row
 
+	def extend_columns(self, columns):
+		"""
+		Append rows built from columns of values.  columns is a
+		dictionary mapping the names of some or all of this
+		Table's columns to sequences of values, for example numpy
+		arrays, all of the same length.  One row is appended for
+		each element.  Columns not named in the dictionary are left
+		unset in the new rows.
+
+		The rows are constructed and their attributes assigned in C
+		by the tokenizer module's unpack_columns() function, and
+		RowType's __init__() method is not called, as when rows are
+		parsed from a document.  Numeric numpy arrays whose type
+		can be converted to the column's type without loss are used
+		directly, with no Python objects being created for their
+		elements until the row attributes are assigned.  The
+		masked elements of numpy masked arrays become None.  The
+		elements of other sequences are assigned to the rows as-is.
+
+		Example:
+
+		>>> import numpy
+		>>> from ligo.lw import lsctables
+		>>> tbl = lsctables.SnglBurstTable.new(["event_id", "ifo", "snr"])
+		>>> tbl.extend_columns({
+		...	"event_id": numpy.arange(3),
+		...	"ifo": ["H1", "L1", "V1"],
+		...	"snr": numpy.ma.masked_array([5., 6., 7.], mask = [False, True, False])
+		... })
+		>>> [(row.event_id, row.ifo, row.snr) for row in tbl]
+		[(0, 'H1', 5.0), (1, 'L1', None), (2, 'V1', 7.0)]
+
+		64-bit integers are not converted to floating-point columns'
+		types, because not all of them can be represented exactly.
+
+		>>> tbl.extend_columns({"snr": numpy.array([2**53 + 1])})
+		>>> tbl[-1].snr
+		9007199254740993
+		"""
+		names = []
+		packed = []
+		n = None
+		for name, values in columns.items():
+			try:
+				column = self.getColumnByName(name)
+			except KeyError:
+				raise ValueError("'%s' is not a column of %s" % (name, self.Name))
+			if n is None:
+				n = len(values)
+			elif len(values) != n:
+				raise ValueError("column '%s' has %d values, expected %d" % (name, len(values), n))
+			names.append(column.Name)
+			packed.append(self._pack_values(column.Type, values))
+		if not names:
+			return
+		self.extend(tokenizer.unpack_columns(self.RowType, names, n, packed))
+
+	@staticmethod
+	def _lossless(dtype, code):
+		"""
+		Used by ._pack_values().  Return True if every value of the
+		numpy dtype can be converted to the buffer type identified
+		by code without loss.  64-bit integers are not, in general,
+		representable in double precision.
+		"""
+		kind, size = dtype.kind, dtype.itemsize
+		if code == "q":
+			return kind in "bi" or (kind == "u" and size < 8)
+		if code == "Q":
+			return kind in "bu"
+		if code in "dD":
+			return kind == "b" or (kind in "iu" and size <= 4) or (kind == "f" and size <= 8) or (code == "D" and kind == "c" and size <= 16)
+		return False
+
+	@staticmethod
+	def _pack_values(coltype, values):
+		"""
+		Used by .extend_columns().  For internal use only.
+		"""
+		code = ligolwtypes.ToBufferCode[coltype]
+		if isinstance(values, numpy.ndarray) and Table._lossless(values.dtype, code):
+			mask = numpy.ma.getmask(values)
+			data = numpy.ascontiguousarray(numpy.ma.getdata(values), dtype = {"q": "int64", "Q": "uint64", "d": "float64", "D": "complex128"}[code])
+			return code, (None if mask is numpy.ma.nomask else numpy.ascontiguousarray(mask, dtype = "uint8")), data, None
+		if isinstance(values, numpy.ndarray):
+			# convert numpy scalars to Python objects
+			values = values.tolist()
+		return "O", None, tuple(values), None
+
+	def sort_by(self, *columns, reverse = False):
+		"""
+		Sort the rows in place in order of the values in one or
+		more columns.  Each argument is the name of a column, or
+		the name of a GPS time property of the RowType class (e.g.,
+		"end" for lsctables.SnglInspiral) whose value is stored in
+		a pair of seconds and nanoseconds columns.  Rows are
+		ordered by the first column, rows with equal values in the
+		first column by the second, and so on.  The sort is
+		stable, None sorts before all other values, and reverse
+		has the same meaning as for list.sort().
+
+		This is equivalent to, but much faster than, sorting with
+		a key function that returns a tuple of the values, because
+		the values are extracted and compared in C.  See
+		ligo.lw.tokenizer.sort_rows() for more information.
+
+		Example:
+
+		>>> from ligo.lw import lsctables
+		>>> tbl = lsctables.SnglBurstTable.new(["event_id", "ifo", "peak_time", "peak_time_ns"])
+		>>> for event_id, ifo, peak in ((0, "L1", 12.5), (1, "H1", 10.75), (2, "H1", 12.25)):
+		...	row = tbl.RowType(event_id = event_id, ifo = ifo)
+		...	row.peak = peak
+		...	tbl.append(row)
+		...
+		>>> tbl.sort_by("peak")
+		>>> [row.event_id for row in tbl]
+		[1, 2, 0]
+		>>> tbl.sort_by("ifo", "peak", reverse = True)
+		>>> [row.event_id for row in tbl]
+		[0, 2, 1]
+		"""
+		keys = []
+		for name in columns:
+			if name in self.columnnames:
+				keys.append(name)
+				continue
+			for cls in self.RowType.__mro__:
+				if name in cls.__dict__:
+					prop = cls.__dict__[name]
+					break
+			else:
+				prop = None
+			# GPS time properties are lsctables.gpsproperty
+			# instances, and provide the names of the columns
+			if hasattr(prop, "s_name") and hasattr(prop, "ns_name"):
+				keys.append((prop.s_name, prop.ns_name))
+			else:
+				raise ValueError("'%s' is not a column or GPS time property of %s" % (name, self.Name))
+		tokenizer.sort_rows(self, keys, reverse = reverse)
+
+	def unique(self, columns = None):
+		"""
+		Remove duplicate rows in place, for example after merging
+		documents with overlapping contents.  Two rows are
+		duplicates if their values in all of the named columns are
+		equal.  If columns is None (the default) all of the Table's
+		columns are compared.  The first of each set of duplicates
+		is retained and the order of the rows is otherwise
+		preserved.  Returns the number of rows removed.
+
+		The rows are hashed and compared in a single pass in C.
+		See ligo.lw.tokenizer.unique_rows() for more information.
+
+		Example:
+
+		>>> from ligo.lw import lsctables
+		>>> tbl = lsctables.SnglBurstTable.new(["event_id", "ifo", "snr"])
+		>>> for event_id, ifo, snr in ((0, "H1", 8.), (1, "L1", 7.), (2, "H1", 8.), (1, "L1", 7.)):
+		...	tbl.append(tbl.RowType(event_id = event_id, ifo = ifo, snr = snr))
+		...
+		>>> tbl.unique()
+		1
+		>>> tbl.unique(("ifo", "snr"))
+		1
+		>>> [row.event_id for row in tbl]
+		[0, 1]
+		"""
+		if columns is None:
+			columns = self.columnnames
+		else:
+			for name in columns:
+				if name not in self.columnnames:
+					raise ValueError("'%s' is not a column of %s" % (name, self.Name))
+		return tokenizer.unique_rows(self, columns)
+
 
 	#
 	# Element methods
@@ -1945,24 +2303,89 @@ class Array(EmptyElement):
 
 		def __init__(self, *args):
 			super(Array.Stream, self).__init__(*args)
+			if self.byteorder is None:
+				self._tokenizer = tokenizer.Tokenizer(self.Delimiter)
+
+		@property
+		def byteorder(self):
+			"""
+			None if the Stream's Encoding attribute selects
+			delimited text (the default), or "big" or "little"
+			if it selects base64-encoded binary data in that
+			byte order.  The Encoding attribute is a comma-
+			separated list containing "base64" and optionally
+			one of "BigEndian" or "LittleEndian" (big-endian
+			is assumed if neither is given), e.g.
+			"LittleEndian,base64", or "Text".
+			"""
 			try:
-				self.Encoding
+				encoding = self.Encoding
 			except AttributeError:
-				pass
-			else:
-				raise ElementError("non-default encoding '%s' not supported.  if this is critical, please report." % self.Encoding)
-			self._tokenizer = tokenizer.Tokenizer(self.Delimiter)
+				return None
+			tokens = set(token.strip() for token in encoding.split(","))
+			if tokens == set(["Text"]):
+				return None
+			if "base64" not in tokens or not tokens <= set(["base64", "BigEndian", "LittleEndian"]) or len(tokens) > 2:
+				raise ElementError("unsupported Encoding '%s'" % encoding)
+			return "little" if "LittleEndian" in tokens else "big"
 
 		def config(self, parentNode):
 			# some initialization that can only be done once
 			# parentNode has been set.
+			shape = parentNode.shape
+			dtype = ligolwtypes.ToNumPyType[parentNode.Type]
+			if self.byteorder is not None:
+				if parentNode.Type not in ligolwtypes.NumericTypes:
+					raise ElementError("base64 encoding not supported for Array of type '%s'" % parentNode.Type)
+				# the bytes are stored in the array's
+				# Fortran-order buffer as they are decoded
+				if parentNode.scratch_dir is not None and numpy.prod(shape, dtype = "int64"):
+					parentNode.array = parentNode._scratch_array(shape, dtype)
+				else:
+					parentNode.array = numpy.zeros(shape, dtype, order = "F")
+				self._array_view = memoryview(parentNode.array.T).cast("B")
+				self._binary = True
+				self._pending = []
+				self._pending_length = 0
+				self._index = 0
+				return self
+			self._binary = False
 			self._tokenizer.set_types([ligolwtypes.ToPyType[parentNode.Type]])
-			parentNode.array = numpy.zeros(parentNode.shape, ligolwtypes.ToNumPyType[parentNode.Type])
+			if parentNode.scratch_dir is not None and numpy.prod(shape, dtype = "int64") and numpy.dtype(dtype).kind != "O":
+				parentNode.array = parentNode._scratch_array(shape, dtype)
+			else:
+				parentNode.array = numpy.zeros(shape, dtype)
 			self._array_view = parentNode.array.T.flat
 			self._index = 0
 			return self
 
+		def _decode(self):
+			# decode the complete 4-character groups of
+			# base64 data collected so far and copy the bytes
+			# into the array.  the remainder is kept for the
+			# next call
+			content = "".join("".join(self._pending).split())
+			n = len(content) - len(content) % 4
+			self._pending = [content[n:]]
+			self._pending_length = len(content) - n
+			data = binascii.a2b_base64(content[:n])
+			next_index = self._index + len(data)
+			if next_index > len(self._array_view):
+				raise ValueError("length of Stream exceeds array size (%d bytes)" % len(self._array_view))
+			self._array_view[self._index : next_index] = data
+			self._index = next_index
+
 		def appendData(self, content):
+			if self.crc32 is not None:
+				self.update_crc32(content)
+			if self._binary:
+				# the parser delivers base64 data a line
+				# at a time, decode it in larger blocks
+				self._pending.append(content)
+				self._pending_length += len(content)
+				if self._pending_length >= 65536:
+					self._decode()
+				return
 			# tokenize buffer, and assign to array
 			tokens = tuple(self._tokenizer.append(content))
 			next_index = self._index + len(tokens)
@@ -1970,10 +2393,27 @@ class Array(EmptyElement):
 			self._index = next_index
 
 		def endElement(self):
+			if self._binary:
+				self._decode()
+				if self._pending_length:
+					raise ValueError("incomplete base64 data in Stream")
+				if self._index != len(self._array_view):
+					raise ValueError("length of Stream (%d bytes) does not match array size (%d bytes)" % (self._index, len(self._array_view)))
+				self._array_view.release()
+				if self.byteorder != sys.byteorder:
+					self.parentNode.array.byteswap(inplace = True)
+				del self._array_view
+				del self._pending
+				del self._pending_length
+				del self._index
+				return
 			# stream tokenizer uses delimiter to identify end
 			# of each token, so add a final delimiter to induce
-			# the last token to get parsed.
+			# the last token to get parsed.  the delimiter is
+			# not part of the text
+			crc32 = self.crc32
 			self.appendData(self.Delimiter)
+			self.crc32 = crc32
 			if self._index != len(self._array_view):
 				raise ValueError("length of Stream (%d elements) does not match array size (%d elements)" % (self._index, len(self._array_view)))
 			del self._array_view
@@ -1983,9 +2423,23 @@ class Array(EmptyElement):
 			# avoid symbol and attribute look-ups in inner loop
 			w = fileobj.write
 			w(self.start_tag(indent))
+			w = self.crc32_write(w)
 
 			array = self.parentNode.array
-			if array is not None and array.size:
+			byteorder = self.byteorder
+			if byteorder is not None and array is not None and array.size:
+				# sanity check the Dim elements
+				self.parentNode.shape
+				# encode blocks of a multiple of 768 bytes,
+				# which become whole 1024 character lines
+				dtype = array.dtype.newbyteorder("<" if byteorder == "little" else ">")
+				flat = array.T.flat
+				newline = "\n" + indent + Indent
+				for start in range(0, array.size, 12288):
+					data = binascii.b2a_base64(flat[start : start + 12288].astype(dtype).tobytes(), newline = False).decode("ascii")
+					w(newline)
+					w(newline.join(data[i : i + 1024] for i in range(0, len(data), 1024)))
+			elif array is not None and array.size:
 				# avoid symbol and attribute look-ups in
 				# inner loop.  we use self.parentNode.shape
 				# to retrieve the array's shape, rather
@@ -2005,7 +2459,9 @@ class Array(EmptyElement):
 				for i in range(lines - 1):
 					w(newline)
 					w(xmlescape(join(islice(tokens, linelen))))
-			w("\n" + self.end_tag(indent) + "\n")
+			w("\n" + indent)
+			self.crc32_done()
+			fileobj.write(self.end_tag("") + "\n")
 
 	def __init__(self, *args):
 		"""
@@ -2013,6 +2469,46 @@ class Array(EmptyElement):
 		"""
 		super(Array, self).__init__(*args)
 		self.array = None
+		# if not None, the array is loaded into a temporary file
+		# in this directory instead of into memory.  set by the
+		# content handler, see ._scratch_array()
+		self.scratch_dir = None
+
+	def _scratch_array(self, shape, dtype):
+		"""
+		Create a zeroed numpy.memmap of the given shape and dtype
+		backed by a temporary file in the .scratch_dir directory.
+		Used by the Stream element's .config() method when
+		.scratch_dir is not None, which allows arrays larger than
+		the available memory to be loaded:  the operating system
+		moves the array's contents between memory and the file as
+		needed.  The file is deleted immediately so nothing is left
+		behind in the directory, its storage is released when the
+		array is garbage collected.  The array is in Fortran order,
+		the order in which its elements appear in the Stream, so
+		that loading and writing it access the file sequentially.
+
+		Example:
+
+		>>> import io, numpy, os, tempfile
+		>>> from ligo.lw import utils as ligolw_utils
+		>>> xmldoc = Document()
+		>>> elem = xmldoc.appendChild(LIGO_LW()).appendChild(Array.build("psd", numpy.arange(12.).reshape(3, 4)))
+		>>> fileobj = io.BytesIO()
+		>>> ligolw_utils.write_fileobj(xmldoc, fileobj)
+		>>> with tempfile.TemporaryDirectory() as scratch_dir:
+		...	xmldoc = ligolw_utils.load_fileobj(io.BytesIO(fileobj.getvalue()), scratch_dir = scratch_dir)
+		...	array = Array.get_array(xmldoc, "psd").array
+		...	print(type(array).__name__, os.listdir(scratch_dir))
+		...
+		memmap []
+		>>> array
+		memmap([[ 0.,  1.,  2.,  3.],
+		        [ 4.,  5.,  6.,  7.],
+		        [ 8.,  9., 10., 11.]])
+		"""
+		with tempfile.NamedTemporaryFile(dir = self.scratch_dir, prefix = "ligolw_array_", suffix = ".dat") as f:
+			return numpy.memmap(f, dtype = dtype, mode = "w+", shape = shape, order = "F")
 
 	@property
 	def shape(self):
@@ -2087,10 +2583,15 @@ class Array(EmptyElement):
 			dim.n = n
 
 	@classmethod
-	def build(cls, name, array, dim_names = None):
+	def build(cls, name, array, dim_names = None, encoding = None):
 		"""
 		Construct a LIGO Light Weight XML Array document subtree
-		from a numpy array object.
+		from a numpy array object.  If encoding is not None it sets
+		the Stream's Encoding attribute, for example
+		"LittleEndian,base64" to store the array's contents in
+		binary form, which preserves their values exactly and is
+		much faster to read and write than the default delimited
+		text.  See Array.Stream.byteorder.
 
 		Example:
 
@@ -2107,6 +2608,14 @@ class Array(EmptyElement):
 				2 5 8 11
 			</Stream>
 		</Array>
+		>>> Array.build("test", a[:, :2], encoding = "LittleEndian,base64").write(sys.stdout)	# doctest: +NORMALIZE_WHITESPACE
+		<Array Type="real_8" Name="test:array">
+			<Dim>2</Dim>
+			<Dim>4</Dim>
+			<Stream Type="Local" Encoding="LittleEndian,base64">
+				AAAAAAAAAAAAAAAAAAAIQAAAAAAAABhAAAAAAAAAIkAAAAAAAADwPwAAAAAAABBAAAAAAAAAHEAAAAAAAAAkQA==
+			</Stream>
+		</Array>
 		"""
 		# Type must be set for .__init__();  easier to set Name
 		# afterwards to take advantage of encoding handled by
@@ -2119,7 +2628,10 @@ class Array(EmptyElement):
 				raise ValueError("dim_names must be same length as number of dimensions")
 			for child, name in zip(self.getElementsByTagName(Dim.tagName), reversed(dim_names)):
 				child.Name = name
-		self.appendChild(self.Stream(AttributesImpl({"Type": self.Stream.Type.default, "Delimiter": self.Stream.Delimiter.default})))
+		if encoding is None:
+			self.appendChild(self.Stream(AttributesImpl({"Type": self.Stream.Type.default, "Delimiter": self.Stream.Delimiter.default})))
+		else:
+			self.appendChild(self.Stream(AttributesImpl({"Type": self.Stream.Type.default, "Encoding": encoding})))
 		self.array = array
 		return self
 
@@ -2479,6 +2991,13 @@ class LIGOLWContentHandler(sax.handler.ContentHandler, object):
 		into which the parsed file will be loaded.
 		"""
 		self.current = self.document = document
+		# if not None, Arrays are loaded into temporary files in
+		# this directory instead of into memory.  see
+		# Array._scratch_array()
+		self.scratch_dir = None
+		# if True, the CRC-32 checksums of Streams are computed as
+		# they are parsed.  see Stream
+		self.crc32 = False
 
 		self._startElementHandlers = {
 			(None, AdcData.tagName): self.startAdcData,
@@ -2504,7 +3023,9 @@ class LIGOLWContentHandler(sax.handler.ContentHandler, object):
 		return AdcInterval(attrs)
 
 	def startArray(self, parent, attrs):
-		return Array(attrs)
+		elem = Array(attrs)
+		elem.scratch_dir = self.scratch_dir
+		return elem
 
 	def startColumn(self, parent, attrs):
 		return Column(attrs)
@@ -2530,10 +3051,14 @@ class LIGOLWContentHandler(sax.handler.ContentHandler, object):
 	def startStream(self, parent, attrs):
 		if parent.tagName == Table.tagName:
 			parent._end_of_columns()
-			return parent.Stream(attrs).config(parent)
+			elem = parent.Stream(attrs).config(parent)
 		elif parent.tagName == Array.tagName:
-			return parent.Stream(attrs).config(parent)
-		return Stream(attrs)
+			elem = parent.Stream(attrs).config(parent)
+		else:
+			return Stream(attrs)
+		if self.crc32:
+			elem.crc32 = 0
+		return elem
 
 	def startTable(self, parent, attrs):
 		return Table(attrs)
@@ -2612,6 +3137,52 @@ class PartialLIGOLWContentHandler(LIGOLWContentHandler):
 			super(PartialLIGOLWContentHandler, self).characters(content)
 
 
+class TableSelectingLIGOLWContentHandler(PartialLIGOLWContentHandler):
+	"""
+	LIGO LW content handler that loads only the named Tables, and
+	optionally only some of their columns.  tables is a dictionary
+	mapping Table names to sequences of the names of the columns to
+	load, or to None to load all columns.  The columns to load are
+	recorded in each Table element's .loadcolumns attribute, so unlike
+	setting the .loadcolumns attribute of the Table classes, this does
+	not affect other documents being loaded at the same time.  Values
+	in columns that are not loaded are not converted to Python
+	objects, and the row objects do not have the corresponding
+	attributes.
+
+	Example:
+
+	>>> from ligo.lw import utils as ligolw_utils
+	>>> from ligo.lw import lsctables
+	>>> def contenthandler(document):
+	...	return TableSelectingLIGOLWContentHandler(document, {"sngl_inspiral": ["ifo", "snr"], "process": None})
+	...
+	>>> xmldoc = ligolw_utils.load_filename("inspiral_event_id_test_in1.xml.gz", contenthandler = contenthandler)
+	>>> [tbl.Name for tbl in xmldoc.getElementsByTagName(Table.tagName)]
+	['process', 'sngl_inspiral']
+	>>> row = lsctables.SnglInspiralTable.get_table(xmldoc)[0]
+	>>> row.ifo, row.snr
+	('H1', 4.018403)
+	>>> hasattr(row, "mass1")
+	False
+
+	See also ligo.lw.utils.load_filename().
+	"""
+	def __init__(self, document, tables):
+		self.tables = dict((Table.TableName(name), None if columns is None else frozenset(map(Column.ColumnName, columns))) for name, columns in tables.items())
+		super(TableSelectingLIGOLWContentHandler, self).__init__(document, lambda name, attrs: name == Table.tagName and Table.TableName(attrs["Name"]) in self.tables)
+
+	def startTable(self, parent, attrs):
+		elem = super(TableSelectingLIGOLWContentHandler, self).startTable(parent, attrs)
+		loadcolumns = self.tables[elem.Name]
+		if loadcolumns is not None:
+			if elem.loadcolumns is not None:
+				loadcolumns &= set(elem.loadcolumns)
+			# an instance attribute, overriding the class'
+			elem.loadcolumns = loadcolumns
+		return elem
+
+
 class FilteringLIGOLWContentHandler(LIGOLWContentHandler):
 	"""
 	LIGO LW content handler that loads everything but those parts of a
@@ -49,7 +49,6 @@ import functools
 import itertools
 import math
 import numpy
-import operator
 import os
 import socket
 import time
@@ -61,6 +60,7 @@ import lal
 from lal import LIGOTimeGPS
 from . import __author__, __date__, __version__
 from . import ligolw
+from . import tokenizer
 from . import types as ligolwtypes
 
 
@@ -109,10 +109,13 @@ def HasNonLSCTables(elem):
 	return any(t.Name not in ligolw.Table.TableByName for t in elem.getElementsByTagName(ligolw.Table.tagName))
 
 
-class instrumentsproperty(object):
-	def __init__(self, name):
-		self.name = name
-
+class instrumentsproperty(tokenizer.InstrumentsProperty):
+	"""
+	Descriptor used internally to expose the "ifos" and
+	"instruments" columns found in many tables as sets of instrument
+	names.  Reading is implemented in C, and parsed instrument strings
+	are cached, see .get() for the decoding rules.
+	"""
 	@staticmethod
 	def get(instruments):
 		"""
@@ -166,11 +169,7 @@ class instrumentsproperty(object):
 		>>> assert instrumentsproperty.get("H1L1") == set(['H1L1'])
 		>>> assert instrumentsproperty.get("H1+L1") == set(['H1+L1'])
 		"""
-		if instruments is None:
-			return None
-		instruments = set(instrument.strip() for instrument in instruments.split(","))
-		instruments.discard("")
-		return instruments
+		return tokenizer.parse_instruments(instruments)
 
 	@staticmethod
 	def set(instruments):
@@ -210,14 +209,11 @@ class instrumentsproperty(object):
 		"""
 		return None if instruments is None else ",".join(sorted(set(instruments)))
 
-	def __get__(self, obj, cls = None):
-		return self.get(getattr(obj, self.name))
-
 	def __set__(self, obj, instruments):
 		setattr(obj, self.name, self.set(instruments))
 
 
-class gpsproperty(object):
+class gpsproperty(tokenizer.GPSProperty):
 	"""
 	Descriptor used internally to implement LIGOTimeGPS-valued
 	properties using pairs of integer attributes on row objects, one
@@ -241,30 +237,18 @@ class gpsproperty(object):
 	normalized GPS times, times with nanosecond components whose
 	magnitudes are not greater than 999999999.  When decoded, the
 	values reported are segments.PosInfinity or segments.NegInfinity.
+
+	Reading is implemented in C, using the row class' slot offsets to
+	retrieve the integer attributes.
 	"""
 	def __init__(self, s_name, ns_name):
-		self.s_name = s_name
-		self.get_s = operator.attrgetter(s_name)
-		self.ns_name = ns_name
-		self.get_ns = operator.attrgetter(ns_name)
+		super(gpsproperty, self).__init__(s_name, ns_name, LIGOTimeGPS, segments.PosInfinity, segments.NegInfinity)
 
+	# NOTE:  these must match the encodings in tokenizer.properties.c
 	posinf = 0x7FFFFFFF, 0xFFFFFFFF
 	neginf = 0xFFFFFFFF, 0xFFFFFFFF
 	infs = posinf, neginf
 
-	def __get__(self, obj, cls = None):
-		s = self.get_s(obj)
-		ns = self.get_ns(obj)
-		if s is None and ns is None:
-			return None
-		if ns == 0xFFFFFFFF:
-			if (s, ns) == self.posinf:
-				return segments.PosInfinity
-			elif (s, ns) == self.neginf:
-				return segments.NegInfinity
-			raise ValueError("unrecognized denormalized number LIGOTimeGPS(%d,%d)" % (s, ns))
-		return LIGOTimeGPS(s, ns)
-
 	def __set__(self, obj, gps):
 		if gps is None:
 			s = ns = None
@@ -325,7 +309,7 @@ class gpsproperty_with_gmst(gpsproperty):
 				raise ValueError(gps)
 
 
-class segmentproperty(object):
+class segmentproperty(tokenizer.SegmentProperty):
 	"""
 	Descriptor used internally to expose pairs of GPS-valued properties
 	as segment-valued properties.  A segment may be set to None, which
@@ -338,15 +322,7 @@ class segmentproperty(object):
 	create.
 	"""
 	def __init__(self, start_name, stop_name):
-		self.start = start_name
-		self.stop = stop_name
-
-	def __get__(self, obj, cls = None):
-		start = getattr(obj, self.start)
-		stop = getattr(obj, self.stop)
-		if start is None and stop is None:
-			return None
-		return segments.segment(start, stop)
+		super(segmentproperty, self).__init__(start_name, stop_name, segments.segment)
 
 	def __set__(self, obj, seg):
 		if seg is None:
@@ -357,6 +333,245 @@ class segmentproperty(object):
 		setattr(obj, self.stop, stop)
 
 
+#
+# =============================================================================
+#
+#                              Columnar Computations
+#
+# =============================================================================
+#
+
+
+def _float_columns(tbl, names):
+	"""
+	Gather the values of the named columns from the rows of tbl into
+	numpy float64 arrays, one for each column, using the tokenizer
+	module's pack_columns() function so that no Python code is run
+	per-row.  None and unset values are reported as NaN.  For internal
+	use by the columnar methods of the table classes.
+	"""
+	codes = "".join(ligolwtypes.ToBufferCode[tbl.validcolumns[name]] for name in names)
+	arrays = []
+	for code, mask, data, blob in tokenizer.pack_columns(tbl, names, codes):
+		if code == "d":
+			array = numpy.frombuffer(data, dtype = "double").copy()
+		elif code == "q":
+			array = numpy.frombuffer(data, dtype = "int64").astype("double")
+		elif code == "O":
+			array = numpy.array([numpy.nan if value is None else value for value in data], dtype = "double")
+		else:
+			raise TypeError("column is not numeric")
+		if mask is not None:
+			array[numpy.frombuffer(mask, dtype = "uint8") != 0] = numpy.nan
+		arrays.append(array)
+	return arrays
+
+
+def _object_columns(tbl, names):
+	"""
+	Gather the values of the named columns from the rows of tbl into
+	numpy object arrays, one for each column, for use in vectorized
+	comparisons.  Unset values are reported as None.
+	"""
+	return [numpy.array(data, dtype = "object") for code, mask, data, blob in tokenizer.pack_columns(tbl, names, "O" * len(names))]
+
+
+def _gps_column(tbl, s_name, ns_name):
+	"""
+	Gather the GPS times stored in a pair of integer seconds and
+	nanoseconds columns into a numpy float64 array.  Times set to None
+	are reported as NaN, and the +/-inf encodings of gpsproperty as
+	+/-inf.  float64 has a resolution of about 0.2 us at present-day
+	GPS times.
+	"""
+	s, ns = _float_columns(tbl, (s_name, ns_name))
+	gps = s + ns * 1e-9
+	denormal = ns == gpsproperty.posinf[1]
+	if denormal.any():
+		posinf = denormal & (s == gpsproperty.posinf[0])
+		neginf = denormal & (s == gpsproperty.neginf[0])
+		if (denormal & ~(posinf | neginf)).any():
+			raise ValueError("unrecognized denormalized GPS time in columns %s, %s" % (s_name, ns_name))
+		gps[posinf] = float("+inf")
+		gps[neginf] = float("-inf")
+	return gps
+
+
+def _greenwich_mean_sidereal_time(gps):
+	"""
+	Compute lal.GreenwichMeanSiderealTime() for an array of GPS times.
+	LAL is called at the start and end of each GPS day spanned by the
+	times, and the sidereal times in between interpolated linearly,
+	which is exact to well below a nanoradian.  Any day containing a
+	leap second is computed time-by-time.  Non-finite times yield NaN.
+	"""
+	gmst = numpy.full(gps.shape, numpy.nan)
+	finite = numpy.isfinite(gps)
+	if not finite.any():
+		return gmst
+	days, inverse = numpy.unique(numpy.floor(gps[finite] / 86400.), return_inverse = True)
+	start = numpy.array([lal.GreenwichMeanSiderealTime(LIGOTimeGPS(int(day) * 86400)) for day in days])
+	stop = numpy.array([lal.GreenwichMeanSiderealTime(LIGOTimeGPS(int(day) * 86400 + 86400)) for day in days])
+	# sidereal advance in one day, unwrapped.  a leap second
+	# displaces it by about 7e-5 rad
+	advance = 2. * math.pi * 1.002737909350795
+	residual = numpy.mod(stop - start - advance + math.pi, 2. * math.pi) - math.pi
+	gmst[finite] = start[inverse] + (advance + residual[inverse]) * (gps[finite] / 86400. - days[inverse])
+	leap = numpy.flatnonzero(finite)[abs(residual[inverse]) > 1e-6]
+	gmst[leap] = [lal.GreenwichMeanSiderealTime(LIGOTimeGPS(t)) for t in gps[leap].tolist()]
+	return gmst
+
+
+def _time_delay_from_earth_center(location, ra, dec, gmst):
+	"""
+	Compute lal.TimeDelayFromEarthCenter() for arrays of sky positions
+	and Greenwich mean sidereal times.
+	"""
+	gha = gmst - ra
+	cosdec = numpy.cos(dec)
+	return -(location[0] * cosdec * numpy.cos(gha) - location[1] * cosdec * numpy.sin(gha) + location[2] * numpy.sin(dec)) / lal.C_SI
+
+
+def _antenna_responses(responses, ra, dec, psi, gmst):
+	"""
+	Compute lal.ComputeDetAMResponse() for arrays of sky positions,
+	polarization angles and Greenwich mean sidereal times, for each of
+	a sequence of detector response tensors.  Yields the arrays (F+,
+	Fx) for each detector in turn.  The polarization basis vectors are
+	computed once and shared by all detectors.
+	"""
+	gha = gmst - ra
+	cosgha, singha = numpy.cos(gha), numpy.sin(gha)
+	cosdec, sindec = numpy.cos(dec), numpy.sin(dec)
+	cospsi, sinpsi = numpy.cos(psi), numpy.sin(psi)
+	X = numpy.array((-cospsi * singha - sinpsi * cosgha * sindec, -cospsi * cosgha + sinpsi * singha * sindec, sinpsi * cosdec))
+	Y = numpy.array((sinpsi * singha - cospsi * cosgha * sindec, sinpsi * cosgha + cospsi * singha * sindec, cospsi * cosdec))
+	for response in responses:
+		response = numpy.asarray(response, dtype = "double")
+		DX = numpy.dot(response, X)
+		DY = numpy.dot(response, Y)
+		yield (X * DX - Y * DY).sum(axis = 0), (X * DY + Y * DX).sum(axis = 0)
+
+
+#
+# GPS times as int64 integer nanoseconds.  +/-inf are represented by the
+# extreme values of int64
+#
+
+
+_GPS_POSINF_NS = numpy.iinfo("int64").max
+_GPS_NEGINF_NS = numpy.iinfo("int64").min
+
+
+def _gps_ns_column(tbl, s_name, ns_name):
+	"""
+	Gather the GPS times stored in a pair of integer seconds and
+	nanoseconds columns into a numpy int64 array of integer
+	nanoseconds.  The +/-inf encodings of gpsproperty are mapped to
+	_GPS_POSINF_NS and _GPS_NEGINF_NS.  Returns None if any time is
+	None, unset or not an integer, in which case the caller should
+	fall back to using the rows' properties.
+	"""
+	columns = tokenizer.pack_columns(tbl, (s_name, ns_name), "qq")
+	if any(code != "q" or mask is not None for code, mask, data, blob in columns):
+		return None
+	(code, mask, s, blob), (code, mask, ns, blob) = columns
+	s = numpy.frombuffer(s, dtype = "int64")
+	ns = numpy.frombuffer(ns, dtype = "int64")
+	gps = s * 1000000000 + ns
+	denormal = ns == gpsproperty.posinf[1]
+	if denormal.any():
+		posinf = denormal & (s == gpsproperty.posinf[0])
+		neginf = denormal & (s == gpsproperty.neginf[0])
+		if (denormal & ~(posinf | neginf)).any():
+			raise ValueError("unrecognized denormalized GPS time in columns %s, %s" % (s_name, ns_name))
+		gps[posinf] = _GPS_POSINF_NS
+		gps[neginf] = _GPS_NEGINF_NS
+	return gps
+
+
+def _gps_from_ns(t):
+	"""
+	Convert a time from _gps_ns_column() to a LIGOTimeGPS or to
+	segments.PosInfinity or segments.NegInfinity.
+	"""
+	if t == _GPS_POSINF_NS:
+		return segments.PosInfinity
+	if t == _GPS_NEGINF_NS:
+		return segments.NegInfinity
+	return LIGOTimeGPS(*divmod(t, 1000000000))
+
+
+def _segmentlist_from_ns(starts, stops, coalesce = False):
+	"""
+	Construct a segments.segmentlist from arrays of segment boundaries
+	in integer nanoseconds.  If coalesce is True the segments are
+	sorted and coalesced before the segment objects are constructed,
+	which is much faster than coalescing the segmentlist afterwards
+	when there are many segments.
+	"""
+	# segments.segment() swaps reversed boundaries
+	starts, stops = numpy.minimum(starts, stops), numpy.maximum(starts, stops)
+	if coalesce and len(starts):
+		order = numpy.lexsort((stops, starts))
+		starts, stops = starts[order], numpy.maximum.accumulate(stops[order])
+		# a new segment begins wherever a start is above every
+		# preceding stop.  touching segments are merged
+		first = numpy.concatenate(([0], numpy.flatnonzero(starts[1:] > stops[:-1]) + 1))
+		last = numpy.concatenate((first[1:], [len(starts)])) - 1
+		starts, stops = starts[first], stops[last]
+	if numpy.isin((starts, stops), (_GPS_POSINF_NS, _GPS_NEGINF_NS)).any():
+		return segments.segmentlist(segments.segment(_gps_from_ns(start), _gps_from_ns(stop)) for start, stop in zip(starts.tolist(), stops.tolist()))
+	segment = segments.segment
+	start_s, start_ns = numpy.divmod(starts, 1000000000)
+	stop_s, stop_ns = numpy.divmod(stops, 1000000000)
+	return segments.segmentlist(segment(LIGOTimeGPS(a, b), LIGOTimeGPS(c, d)) for a, b, c, d in zip(start_s.tolist(), start_ns.tolist(), stop_s.tolist(), stop_ns.tolist()))
+
+
+def _chirp_mass(mass1, mass2):
+	"""
+	Compute the chirp masses for arrays of component masses.
+	"""
+	return (mass1 * mass2)**(3./5) / (mass1 + mass2)**(1./5)
+
+
+def _mass_ratio(mass1, mass2):
+	"""
+	Compute the mass ratios, smaller mass / larger mass, for arrays of
+	component masses.
+	"""
+	return numpy.minimum(mass1, mass2) / numpy.maximum(mass1, mass2)
+
+
+def _injection_times_at_instrument(tbl, time_names, radec_names, instrument, offsetvector):
+	"""
+	Columnar implementation of the .time_at_instrument() methods of
+	the sim_* row classes.
+	"""
+	t_geocent = _gps_column(tbl, *time_names) - offsetvector[instrument]
+	ra, dec = _float_columns(tbl, radec_names)
+	return t_geocent + _time_delay_from_earth_center(lal.cached_detector_by_prefix[instrument].location, ra, dec, _greenwich_mean_sidereal_time(t_geocent))
+
+
+def _injection_snr_geometry_factors(tbl, time_names, angle_names, instruments):
+	"""
+	Columnar implementation of the .snr_geometry_factors() methods of
+	the sim_* row classes.  angle_names are the names of the right
+	ascension, declination, polarization, inclination and coalescence
+	phase columns.
+	"""
+	ra, dec, psi, inclination, coa_phase = _float_columns(tbl, angle_names)
+	cosi = numpy.cos(inclination)
+	cos2i = cosi**2.
+	gmst = _greenwich_mean_sidereal_time(_gps_column(tbl, *time_names))
+	phase = numpy.exp(-2.j * coa_phase)
+	instruments = tuple(instruments)
+	snr_geometry_factors = {}
+	for instrument, (fp, fc) in zip(instruments, _antenna_responses([lal.cached_detector_by_prefix[instrument].response for instrument in instruments], ra, dec, psi, gmst)):
+		snr_geometry_factors[instrument] = (-fc * cosi + 1.j * fp * (1. + cos2i) / 2.) * phase
+	return snr_geometry_factors
+
+
 #
 # =============================================================================
 #
@@ -1033,6 +1248,71 @@ class SnglInspiralTable(ligolw.Table):
 	constraints = "PRIMARY KEY (event_id)"
 	next_id = SnglInspiralID(0)
 
+	def get_spin1(self):
+		"""
+		Return an (N, 3) numpy array of the spin1 vectors of the
+		rows in the table, gathered from the spin1x, spin1y and
+		spin1z columns without constructing a vector for each row.
+		Components set to None are reported as NaN.  See also
+		SnglInspiral.spin1.
+
+		Example:
+
+		>>> tbl = SnglInspiralTable.new()
+		>>> for m1, m2 in ((1.4, 1.4), (10., 5.)):
+		...	row = tbl.RowType()
+		...	row.spin1 = (0., 0., m2 / m1)
+		...	row.spin2 = None
+		...	row.mass1, row.mass2 = m1, m2
+		...	row.eff_distance = 100.
+		...	tbl.append(row)
+		...
+		>>> tbl.get_spin1()
+		array([[0. , 0. , 1. ],
+		       [0. , 0. , 0.5]])
+		>>> tbl.get_spin2()
+		array([[nan, nan, nan],
+		       [nan, nan, nan]])
+		>>> tbl.get_mass_ratio()
+		array([1. , 0.5])
+		>>> tbl.get_chirp_distance().round(3)
+		array([100.  ,  26.19])
+		"""
+		return numpy.stack(_float_columns(self, ("spin1x", "spin1y", "spin1z")), axis = 1)
+
+	def get_spin2(self):
+		"""
+		Return an (N, 3) numpy array of the spin2 vectors of the
+		rows in the table, gathered from the spin2x, spin2y and
+		spin2z columns.  Components set to None are reported as
+		NaN.  See also SnglInspiral.spin2.
+		"""
+		return numpy.stack(_float_columns(self, ("spin2x", "spin2y", "spin2z")), axis = 1)
+
+	def get_mchirp(self):
+		"""
+		Return a numpy array of the chirp masses of the rows in the
+		table, computed from the mass1 and mass2 columns.
+		"""
+		return _chirp_mass(*_float_columns(self, ("mass1", "mass2")))
+
+	def get_mass_ratio(self):
+		"""
+		Return a numpy array of the mass ratios, smaller mass /
+		larger mass, of the rows in the table, computed from the
+		mass1 and mass2 columns.
+		"""
+		return _mass_ratio(*_float_columns(self, ("mass1", "mass2")))
+
+	def get_chirp_distance(self, ref_mass = 1.4):
+		"""
+		Return a numpy array of the chirp distances of the rows in
+		the table, computed from the eff_distance column and the
+		chirp masses.  See SnglInspiral.chirp_distance().
+		"""
+		mass1, mass2, dist = _float_columns(self, ("mass1", "mass2", "eff_distance"))
+		return SnglInspiral.chirp_distance(dist, _chirp_mass(mass1, mass2), ref_mass = ref_mass)
+
 
 class SnglInspiral(ligolw.Table.RowType):
 	__slots__ = tuple(map(ligolw.Column.ColumnName, SnglInspiralTable.validcolumns))
@@ -1332,6 +1612,55 @@ class SimInspiralTable(ligolw.Table):
 	constraints = "PRIMARY KEY (simulation_id)"
 	next_id = SimInspiralID(0)
 
+	def time_at_instrument(self, instrument, offsetvector):
+		"""
+		Return a numpy array containing the time of each injection
+		in the table, delay corrected for the displacement from the
+		geocentre to the given instrument.  This is the columnar
+		equivalent of SimInspiral.time_at_instrument():  the
+		columns are gathered once and the delays computed for all
+		rows together.  The times are float64 GPS times, which
+		have a resolution of about 0.2 us.
+
+		Example:
+
+		>>> tbl = SimInspiralTable.new()
+		>>> for t, ra in ((6e8, 0.), (6e8 + 3600.25, 1.)):
+		...	row = tbl.RowType()
+		...	row.time_geocent = t
+		...	row.ra_dec = ra, 0.5
+		...	row.distance = 100.
+		...	row.inclination = row.coa_phase = row.polarization = 0.
+		...	tbl.append(row)
+		...
+		>>> t = tbl.time_at_instrument("H1", {"H1": 0.})
+		>>> numpy.allclose(t, [float(row.time_at_instrument("H1", {"H1": 0.})) for row in tbl], rtol = 0., atol = 1e-6)
+		True
+		>>> d = tbl.effective_distances(("H1", "L1"))
+		>>> numpy.allclose(d["L1"], [row.effective_distances(("L1",))["L1"] for row in tbl])
+		True
+		"""
+		return _injection_times_at_instrument(self, ("geocent_end_time", "geocent_end_time_ns"), ("longitude", "latitude"), instrument, offsetvector)
+
+	def snr_geometry_factors(self, instruments):
+		"""
+		Return a dictionary mapping each instrument to a numpy
+		array of the complex SNR geometry factors of the injections
+		in the table.  This is the columnar equivalent of
+		SimInspiral.snr_geometry_factors().
+		"""
+		return _injection_snr_geometry_factors(self, ("geocent_end_time", "geocent_end_time_ns"), ("longitude", "latitude", "polarization", "inclination", "coa_phase"), instruments)
+
+	def effective_distances(self, instruments):
+		"""
+		Return a dictionary mapping each instrument to a numpy
+		array of the complex effective distances of the injections
+		in the table.  This is the columnar equivalent of
+		SimInspiral.effective_distances().
+		"""
+		distance, = _float_columns(self, ("distance",))
+		return {instrument: distance / snr_geometry_factor for instrument, snr_geometry_factor in self.snr_geometry_factors(instruments).items()}
+
 
 class SimInspiral(ligolw.Table.RowType):
 	"""
@@ -1568,6 +1897,18 @@ class SimBurstTable(ligolw.Table):
 	constraints = "PRIMARY KEY (simulation_id)"
 	next_id = SimBurstID(0)
 
+	def time_at_instrument(self, instrument, offsetvector):
+		"""
+		Return a numpy array containing the time of each injection
+		in the table, delay corrected for the displacement from the
+		geocentre to the given instrument.  This is the columnar
+		equivalent of SimBurst.time_at_instrument():  the
+		columns are gathered once and the delays computed for all
+		rows together.  The times are float64 GPS times, which
+		have a resolution of about 0.2 us.
+		"""
+		return _injection_times_at_instrument(self, ("time_geocent_gps", "time_geocent_gps_ns"), ("ra", "dec"), instrument, offsetvector)
+
 
 class SimBurst(ligolw.Table.RowType):
 	"""
@@ -1690,6 +2031,18 @@ class SimRingdownTable(ligolw.Table):
 	constraints = "PRIMARY KEY (simulation_id)"
 	next_id = SimRingdownID(0)
 
+	def time_at_instrument(self, instrument, offsetvector):
+		"""
+		Return a numpy array containing the time of each injection
+		in the table, delay corrected for the displacement from the
+		geocentre to the given instrument.  This is the columnar
+		equivalent of SimRingdown.time_at_instrument():  the
+		columns are gathered once and the delays computed for all
+		rows together.  The times are float64 GPS times, which
+		have a resolution of about 0.2 us.
+		"""
+		return _injection_times_at_instrument(self, ("geocent_start_time", "geocent_start_time_ns"), ("longitude", "latitude"), instrument, offsetvector)
+
 
 class SimRingdown(ligolw.Table.RowType):
 	__slots__ = tuple(map(ligolw.Column.ColumnName, SimRingdownTable.validcolumns))
@@ -1912,6 +2265,80 @@ class SimCBCTable(ligolw.Table):
 	constraints = "PRIMARY KEY (cbc_sim_id)"
 	next_id = SimCBCID(0)
 
+	def get_spin1(self):
+		"""
+		Return an (N, 3) numpy array of the spin1 vectors of the
+		rows in the table, gathered from the spin1x, spin1y and
+		spin1z columns without constructing a vector for each row.
+		Components set to None are reported as NaN.  See also
+		SimCBC.spin1.
+		"""
+		return numpy.stack(_float_columns(self, ("spin1x", "spin1y", "spin1z")), axis = 1)
+
+	def get_spin2(self):
+		"""
+		Return an (N, 3) numpy array of the spin2 vectors of the
+		rows in the table, gathered from the spin2x, spin2y and
+		spin2z columns.  Components set to None are reported as
+		NaN.  See also SimCBC.spin2.
+		"""
+		return numpy.stack(_float_columns(self, ("spin2x", "spin2y", "spin2z")), axis = 1)
+
+	def get_mchirp(self):
+		"""
+		Return a numpy array of the chirp masses of the rows in the
+		table, computed from the mass1_det and mass2_det columns.
+		"""
+		return _chirp_mass(*_float_columns(self, ("mass1_det", "mass2_det")))
+
+	def get_mass_ratio(self):
+		"""
+		Return a numpy array of the mass ratios, smaller mass /
+		larger mass, of the rows in the table, computed from the
+		mass1_det and mass2_det columns.
+		"""
+		return _mass_ratio(*_float_columns(self, ("mass1_det", "mass2_det")))
+
+	def get_chirp_distance(self, ref_mass = 1.4):
+		"""
+		Return a numpy array of the chirp distances of the rows in
+		the table, computed from the d_lum column and the chirp
+		masses.  See SnglInspiral.chirp_distance().
+		"""
+		mass1, mass2, dist = _float_columns(self, ("mass1_det", "mass2_det", "d_lum"))
+		return SnglInspiral.chirp_distance(dist, _chirp_mass(mass1, mass2), ref_mass = ref_mass)
+
+	def time_at_instrument(self, instrument, offsetvector):
+		"""
+		Return a numpy array containing the time of each injection
+		in the table, delay corrected for the displacement from the
+		geocentre to the given instrument.  This is the columnar
+		equivalent of SimCBC.time_at_instrument():  the
+		columns are gathered once and the delays computed for all
+		rows together.  The times are float64 GPS times, which
+		have a resolution of about 0.2 us.
+		"""
+		return _injection_times_at_instrument(self, ("geocent_end_time", "geocent_end_time_ns"), ("ra", "dec"), instrument, offsetvector)
+
+	def snr_geometry_factors(self, instruments):
+		"""
+		Return a dictionary mapping each instrument to a numpy
+		array of the complex SNR geometry factors of the injections
+		in the table.  This is the columnar equivalent of
+		SimCBC.snr_geometry_factors().
+		"""
+		return _injection_snr_geometry_factors(self, ("geocent_end_time", "geocent_end_time_ns"), ("ra", "dec", "polarization", "inclination", "coa_phase"), instruments)
+
+	def effective_distances(self, instruments):
+		"""
+		Return a dictionary mapping each instrument to a numpy
+		array of the complex effective distances of the injections
+		in the table.  This is the columnar equivalent of
+		SimCBC.effective_distances().
+		"""
+		distance, = _float_columns(self, ("d_lum",))
+		return {instrument: distance / snr_geometry_factor for instrument, snr_geometry_factor in self.snr_geometry_factors(instruments).items()}
+
 
 class SimCBC(ligolw.Table.RowType):
 	"""
@@ -2384,18 +2811,47 @@ class SegmentSumTable(ligolw.Table):
 	constraints = "PRIMARY KEY (segment_sum_id)"
 	next_id = SegmentSumID(0)
 
-	def get(self, segment_def_id = None):
+	def get(self, segment_def_id = None, coalesce = False):
 		"""
 		Return a segmentlist object describing the times spanned by
 		the segments carrying the given segment_def_id.  If
 		segment_def_id is None then all segments are returned.
 
-		Note:  the result is not coalesced, the segmentlist
-		contains the segments as they appear in the table.
+		Note:  by default the result is not coalesced, the
+		segmentlist contains the segments as they appear in the
+		table.  If coalesce is True the segmentlist is coalesced.
+		This is done before constructing the segment objects, so it
+		is much faster than calling .coalesce() on the result.
+
+		Example:
+
+		>>> tbl = SegmentSumTable.new()
+		>>> for start, end, segment_def_id in ((10, 20, 0), (0, 5, 1), (15, 30, 0), (30, 40, 0)):
+		...	row = tbl.RowType()
+		...	row.segment = start, end
+		...	row.segment_def_id = segment_def_id
+		...	tbl.append(row)
+		...
+		>>> tbl.get(0)
+		[segment(LIGOTimeGPS(10, 0), LIGOTimeGPS(20, 0)), segment(LIGOTimeGPS(15, 0), LIGOTimeGPS(30, 0)), segment(LIGOTimeGPS(30, 0), LIGOTimeGPS(40, 0))]
+		>>> tbl.get(0, coalesce = True)
+		[segment(LIGOTimeGPS(10, 0), LIGOTimeGPS(40, 0))]
 		"""
-		if segment_def_id is None:
-			return segments.segmentlist(row.segment for row in self)
-		return segments.segmentlist(row.segment for row in self if row.segment_def_id == segment_def_id)
+		starts = _gps_ns_column(self, "start_time", "start_time_ns")
+		stops = _gps_ns_column(self, "end_time", "end_time_ns")
+		if starts is None or stops is None:
+			# a time is None or not an integer.  do it the
+			# slow way
+			if segment_def_id is None:
+				seglist = segments.segmentlist(row.segment for row in self)
+			else:
+				seglist = segments.segmentlist(row.segment for row in self if row.segment_def_id == segment_def_id)
+			return seglist.coalesce() if coalesce else seglist
+		if segment_def_id is not None:
+			segment_def_ids, = _object_columns(self, ("segment_def_id",))
+			selected = segment_def_ids == segment_def_id
+			starts, stops = starts[selected], stops[selected]
+		return _segmentlist_from_ns(starts, stops, coalesce = coalesce)
 
 
 class SegmentSum(Segment):
@@ -2676,6 +3132,65 @@ class CoincMapTable(ligolw.Table):
 			except KeyError:
 				pass
 
+	def group_rows(self, *tables):
+		"""
+		Group the rows of one or more Tables by the coincidences
+		to which they belong.  tables are the Tables whose rows are
+		referenced by the map, for example SnglInspiralTable or
+		CoincTable.  Each Table's rows are identified by its
+		.next_id column, and the map's entries for a Table are
+		those whose table_name matches the Table's name.
+
+		The return value is a tuple (coinc_event_ids, groups).
+		coinc_event_ids is a sorted numpy array of the distinct
+		coinc_event_ids in the map.  groups is a dictionary mapping
+		the name of each Table to a pair of numpy arrays (starts,
+		rows) in CSR form:  the indexes in the Table of the rows
+		that are members of coinc_event_ids[i] are
+		rows[starts[i]:starts[i + 1]], in the order in which they
+		appear in the map.  Map entries referring to rows that are
+		not in the Table are ignored.
+
+		The Tables' ID columns are indexed with a hash table in C
+		(see ligo.lw.tokenizer.find_rows()), so the cost is
+		proportional to the total number of rows.
+
+		Example:
+
+		>>> sngls = SnglBurstTable.new(["event_id", "ifo"])
+		>>> for event_id, ifo in ((10, "H1"), (11, "L1"), (12, "V1")):
+		...	sngls.append(sngls.RowType(event_id = event_id, ifo = ifo))
+		...
+		>>> coinc_map = CoincMapTable.new()
+		>>> for coinc_event_id, event_id in ((1, 12), (0, 10), (1, 11), (0, 11)):
+		...	coinc_map.append(coinc_map.RowType(coinc_event_id = coinc_event_id, table_name = "sngl_burst", event_id = event_id))
+		...
+		>>> coinc_event_ids, groups = coinc_map.group_rows(sngls)
+		>>> coinc_event_ids
+		array([0, 1])
+		>>> starts, rows = groups["sngl_burst"]
+		>>> [[sngls[j].ifo for j in rows[starts[i]:starts[i + 1]]] for i in range(len(coinc_event_ids))]
+		[['H1', 'L1'], ['V1', 'L1']]
+		"""
+		columns = tokenizer.pack_columns(self, ("event_id", "coinc_event_id"), "qq")
+		if any(code != "q" or mask is not None for code, mask, data, blob in columns):
+			raise ValueError("coinc_event_map contains IDs that are not integers")
+		event_ids, coinc_event_ids = (numpy.frombuffer(data, dtype = "int64") for code, mask, data, blob in columns)
+		coinc_event_ids, inverse = numpy.unique(coinc_event_ids, return_inverse = True)
+		table_names = numpy.array(self.getColumnByName("table_name"), dtype = "object")
+
+		groups = {}
+		for tbl in tables:
+			selected = table_names == tbl.Name
+			rows = numpy.frombuffer(tokenizer.find_rows(tbl, tbl.next_id.column_name, numpy.ascontiguousarray(event_ids[selected])), dtype = "int64")
+			group = inverse[selected]
+			found = rows >= 0
+			rows, group = rows[found], group[found]
+			order = numpy.argsort(group, kind = "stable")
+			starts = numpy.searchsorted(group[order], numpy.arange(len(coinc_event_ids) + 1))
+			groups[tbl.Name] = (starts, rows[order])
+		return coinc_event_ids, groups
+
 
 class CoincMap(ligolw.Table.RowType):
 	__slots__ = tuple(map(ligolw.Column.ColumnName, CoincMapTable.validcolumns))
@@ -2718,9 +3233,35 @@ class DQSpec(ligolw.Table.RowType):
 		"""
 		Apply our low and high windows to the segments in a
 		segmentlist.
+
+		If the segments are segments.segment objects with
+		LIGOTimeGPS boundaries, the windows are applied using
+		arrays of the boundaries in integer nanoseconds, as is done
+		by VetoDefTable.segmentlistdict(), otherwise the segments
+		are padded one at a time.
+
+		Example:
+
+		>>> row = DQSpec()
+		>>> row.low_window, row.high_window = 0.5, 2.
+		>>> seglist = segments.segmentlist([segments.segment(LIGOTimeGPS(10), LIGOTimeGPS(20)), segments.segment(LIGOTimeGPS(30, 250000000), LIGOTimeGPS(40))])
+		>>> row.apply_to_segmentlist(seglist)
+		>>> seglist
+		[segment(LIGOTimeGPS(9, 500000000), LIGOTimeGPS(22, 0)), segment(LIGOTimeGPS(29, 750000000), LIGOTimeGPS(42, 0))]
 		"""
-		for i, seg in enumerate(seglist):
-			seglist[i] = seg.__class__(seg[0] - self.low_window, seg[1] + self.high_window)
+		low_window, high_window = self.low_window, self.high_window
+		if seglist and all(type(seg) is segments.segment for seg in seglist):
+			try:
+				boundaries = numpy.array([(t.gpsSeconds, t.gpsNanoSeconds) for seg in seglist for t in seg], dtype = "int64")
+			except AttributeError:
+				# a boundary is not a LIGOTimeGPS, e.g., it's
+				# infinite
+				pass
+			else:
+				boundaries = boundaries[:, 0] * 1000000000 + boundaries[:, 1]
+				seglist[:] = _segmentlist_from_ns(boundaries[0::2] - int(round(low_window * 1e9)), boundaries[1::2] + int(round(high_window * 1e9)))
+				return
+		seglist[:] = [seg.__class__(seg[0] - low_window, seg[1] + high_window) for seg in seglist]
 
 
 DQSpecListTable.RowType = DQSpec
@@ -2750,14 +3291,24 @@ class VetoDefTable(ligolw.Table):
 		"comment": "lstring"
 	}
 
+	def _select(self, name, category):
+		"""
+		Return a numpy array of booleans selecting the rows for the
+		(name, category) pair, and a numpy object array of the
+		versions.
+		"""
+		names, categories, versions = _object_columns(self, ("name", "category", "version"))
+		return (names == name) & (categories == category), versions
+
 	def versions(self, name, category):
 		"""
 		Report the versions available for the (name, category)
 		pair.
 		"""
-		return set(row.version for row in self if row.name == name and row.category == category)
+		selected, versions = self._select(name, category)
+		return set(versions[selected])
 
-	def segmentlistdict(self, name, category, version = None, padded = False):
+	def segmentlistdict(self, name, category, version = None, padded = False, coalesce = False):
 		"""
 		Return a segments.segmentlistdict mapping instrument to the
 		segments for the (name, category) pair.  If version is None
@@ -2765,21 +3316,57 @@ class VetoDefTable(ligolw.Table):
 		reported, otherwise the segments for the requested version
 		are reported.  If padded is boolean False (the default) the
 		non-padded segments are reported, otherwise the padded
-		segments are reported.
+		segments are reported.  If coalesce is True the
+		segmentlists are coalesced, which is much faster than
+		coalescing the result.
+
+		The rows are selected and the paddings applied using
+		arrays of the table's columns, and segment objects are only
+		constructed for the segments that are reported.
+
+		Example:
+
+		>>> tbl = VetoDefTable.new()
+		>>> for ifo, version, start, end in (("H1", 1, 0, 10), ("H1", 2, 0, 10), ("L1", 2, 5, 25), ("H1", 2, 20, 30)):
+		...	row = tbl.RowType()
+		...	row.ifo, row.name, row.category, row.version = ifo, "DMT-FLAG", 2, version
+		...	row.start_time, row.end_time, row.start_pad, row.end_pad = start, end, 1, 2
+		...	tbl.append(row)
+		...
+		>>> sorted(tbl.versions("DMT-FLAG", 2))
+		[1, 2]
+		>>> seglists = tbl.segmentlistdict("DMT-FLAG", 2, padded = True)
+		>>> seglists["H1"]
+		[segment(LIGOTimeGPS(-1, 0), LIGOTimeGPS(12, 0)), segment(LIGOTimeGPS(19, 0), LIGOTimeGPS(32, 0))]
+		>>> seglists["L1"]
+		[segment(LIGOTimeGPS(4, 0), LIGOTimeGPS(27, 0))]
 		"""
 		seglists = segments.segmentlistdict()
+		selected, versions = self._select(name, category)
 		if version is None:
 			# not an error if there are no versions, just means
 			# the segmentlists are empty
-			version = max(self.versions(name, category) or (None,))
-		for row in self:
-			if row.name != name or row.category != category or row.version != version:
-				continue
-			try:
-				seglist = seglists[row.ifo]
-			except KeyError:
-				seglist = seglists[row.ifo] = segments.segmentlist()
-			seglist.append(row.segment_padded if padded else row.segment)
+			version = max(set(versions[selected]) or (None,))
+		selected &= versions == version
+		if not selected.any():
+			return seglists
+		ifos, = _object_columns(self, ("ifo",))
+		ifos = ifos[selected]
+		columns = tokenizer.pack_columns(self, ("start_time", "end_time", "start_pad", "end_pad"), "qqqq")
+		if any(code != "q" or mask is not None for code, mask, data, blob in columns):
+			# a value is None or not an integer.  do it the slow
+			# way
+			for ifo, row in zip(ifos, (row for row, keep in zip(self, selected) if keep)):
+				seglists.setdefault(ifo, segments.segmentlist()).append(row.segment_padded if padded else row.segment)
+			if coalesce:
+				seglists.coalesce()
+		else:
+			starts, stops, start_pads, end_pads = (numpy.frombuffer(data, dtype = "int64")[selected] * 1000000000 for code, mask, data, blob in columns)
+			if padded:
+				starts = starts - start_pads
+				stops = stops + end_pads
+			for ifo in set(ifos):
+				seglists[ifo] = _segmentlist_from_ns(starts[ifos == ifo], stops[ifos == ifo], coalesce = coalesce)
 		return seglists
 
 
@@ -2811,7 +3398,7 @@ class VetoDef(ligolw.Table.RowType):
 
 	start = gpsproperty("start_time", "start_time_ns")
 	end = gpsproperty("end_time", "end_time_ns")
-	segment = gpsproperty("start", "end")
+	segment = segmentproperty("start", "end")
 
 	@property
 	def start_padded(self):
@@ -2820,7 +3407,7 @@ class VetoDef(ligolw.Table.RowType):
 	def end_padded(self):
 		return self.end + self.end_pad
 
-	segment_padded = gpsproperty("start_padded", "end_padded")
+	segment_padded = segmentproperty("start_padded", "end_padded")
 
 
 VetoDefTable.RowType = VetoDef
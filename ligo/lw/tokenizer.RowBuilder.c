@@ -52,15 +52,49 @@ typedef struct {
 	PyTypeObject *rowtype;
 	/* tuple of attribute names */
 	PyObject *attributes;
+	/* the type for which offsets was computed */
+	PyTypeObject *offsets_type;
+	/* slot offset of each attribute, or -1 */
+	Py_ssize_t *offsets;
 	/* current row */
 	PyObject *row;
 	/* current attribute index */
 	int i;
 	/* the iterable passed to append() */
 	PyObject *iter;
+	/* rows parsed by the Tokenizer fast path and not yet returned */
+	PyObject *pending;
+	Py_ssize_t pending_pos;
+	/* error that stopped the fast path, raised after the pending
+	 * rows have been returned */
+	PyObject *error_type;
+	PyObject *error_value;
+	PyObject *error_traceback;
 } ligolw_RowBuilder;
 
 
+/*
+ * Release the state.  Used by __del__() and __init__(), which can be
+ * called more than once.
+ */
+
+
+static void clear(ligolw_RowBuilder *rowbuilder)
+{
+	Py_CLEAR(rowbuilder->rowtype);
+	Py_CLEAR(rowbuilder->attributes);
+	Py_CLEAR(rowbuilder->offsets_type);
+	free(rowbuilder->offsets);
+	rowbuilder->offsets = NULL;
+	Py_CLEAR(rowbuilder->row);
+	Py_CLEAR(rowbuilder->iter);
+	Py_CLEAR(rowbuilder->pending);
+	Py_CLEAR(rowbuilder->error_type);
+	Py_CLEAR(rowbuilder->error_value);
+	Py_CLEAR(rowbuilder->error_traceback);
+}
+
+
 /*
  * append() method
  */
@@ -71,6 +105,10 @@ static PyObject *append(PyObject *self, PyObject *iter)
 	ligolw_RowBuilder *rowbuilder = (ligolw_RowBuilder *) self;
 
 	Py_XDECREF(rowbuilder->iter);
+	Py_CLEAR(rowbuilder->pending);
+	Py_CLEAR(rowbuilder->error_type);
+	Py_CLEAR(rowbuilder->error_value);
+	Py_CLEAR(rowbuilder->error_traceback);
 	rowbuilder->iter = PyObject_GetIter(iter);
 	if(!rowbuilder->iter)
 		return NULL;
@@ -87,12 +125,7 @@ static PyObject *append(PyObject *self, PyObject *iter)
 
 static void __del__(PyObject *self)
 {
-	ligolw_RowBuilder *rowbuilder = (ligolw_RowBuilder *) self;
-
-	Py_XDECREF(rowbuilder->rowtype);
-	Py_XDECREF(rowbuilder->attributes);
-	Py_XDECREF(rowbuilder->row);
-	Py_XDECREF(rowbuilder->iter);
+	clear((ligolw_RowBuilder *) self);
 
 	self->ob_type->tp_free(self);
 }
@@ -106,26 +139,123 @@ static void __del__(PyObject *self)
 static int __init__(PyObject *self, PyObject *args, PyObject *kwds)
 {
 	ligolw_RowBuilder *rowbuilder = (ligolw_RowBuilder *) self;
+	PyObject *rowtype, *attributes;
+	Py_ssize_t *offsets;
 
-	if(!PyArg_ParseTuple(args, "OO", &rowbuilder->rowtype, &rowbuilder->attributes))
+	if(!PyArg_ParseTuple(args, "OO", &rowtype, &attributes))
 		return -1;
 
-	Py_INCREF(rowbuilder->rowtype);
-
-	rowbuilder->attributes = llwtokenizer_build_attributes(rowbuilder->attributes);
+	attributes = llwtokenizer_build_attributes(attributes);
+	if(!attributes)
+		return -1;
 
-	if(!rowbuilder->attributes)
+	offsets = malloc((PyTuple_GET_SIZE(attributes) + 1) * sizeof(*offsets));
+	if(!offsets) {
+		Py_DECREF(attributes);
+		PyErr_NoMemory();
 		return -1;
+	}
+
+	/* release the state from an earlier call */
+	clear(rowbuilder);
 
+	Py_INCREF(rowtype);
+	rowbuilder->rowtype = (PyTypeObject *) rowtype;
+	rowbuilder->attributes = attributes;
+	rowbuilder->offsets = offsets;
 	rowbuilder->row = Py_None;
 	Py_INCREF(rowbuilder->row);
 	rowbuilder->i = 0;
-	rowbuilder->iter = NULL;
+	rowbuilder->pending_pos = 0;
+
+	return 0;
+}
+
+
+/*
+ * Start a new row.  The tokens are assigned to the row object's slots
+ * directly, bypassing the attribute protocol, using offsets that are
+ * computed once for each row class.  The offsets are recomputed if the
+ * rowtype attribute has been changed.
+ */
+
+
+static int update_offsets(ligolw_RowBuilder *rowbuilder)
+{
+	if(!PyType_Check(rowbuilder->rowtype)) {
+		PyErr_SetString(PyExc_TypeError, "rowtype must be a class");
+		return -1;
+	}
+	if(rowbuilder->offsets_type != rowbuilder->rowtype) {
+		if(llwtokenizer_slot_offsets(rowbuilder->rowtype, rowbuilder->attributes, rowbuilder->offsets) < 0)
+			return -1;
+		Py_INCREF(rowbuilder->rowtype);
+		Py_XDECREF(rowbuilder->offsets_type);
+		rowbuilder->offsets_type = rowbuilder->rowtype;
+	}
 
 	return 0;
 }
 
 
+static PyObject *new_row(ligolw_RowBuilder *rowbuilder)
+{
+	if(update_offsets(rowbuilder) < 0)
+		return NULL;
+
+	return PyType_GenericNew(rowbuilder->rowtype, NULL, NULL);
+}
+
+
+/*
+ * Fast path for tokens that come directly from a Tokenizer:  whole rows
+ * are parsed by llwtokenizer_build_rows() into the pending list, and
+ * returned from it one at a time.  Returns a new reference to the next
+ * row, or NULL with StopIteration set when the Tokenizer's buffer has been
+ * used up, or NULL with no exception set if the fast path cannot be used,
+ * or NULL with an exception set on error.  The rows completed before a
+ * token that cannot be converted are returned before the error is raised,
+ * as they are by the slow path.
+ */
+
+
+static PyObject *next_pending(ligolw_RowBuilder *rowbuilder)
+{
+	PyObject *row;
+	int result;
+
+	if(!rowbuilder->pending || rowbuilder->pending_pos >= PyList_GET_SIZE(rowbuilder->pending)) {
+		Py_CLEAR(rowbuilder->pending);
+		if(rowbuilder->error_type) {
+			PyErr_Restore(rowbuilder->error_type, rowbuilder->error_value, rowbuilder->error_traceback);
+			rowbuilder->error_type = rowbuilder->error_value = rowbuilder->error_traceback = NULL;
+			return NULL;
+		}
+		rowbuilder->pending = PyList_New(0);
+		rowbuilder->pending_pos = 0;
+		if(!rowbuilder->pending || update_offsets(rowbuilder) < 0)
+			return NULL;
+		result = llwtokenizer_build_rows(rowbuilder->iter, rowbuilder->rowtype, rowbuilder->attributes, rowbuilder->offsets, &rowbuilder->row, &rowbuilder->i, rowbuilder->pending);
+		if(result < 0 && PyList_GET_SIZE(rowbuilder->pending))
+			PyErr_Fetch(&rowbuilder->error_type, &rowbuilder->error_value, &rowbuilder->error_traceback);
+		else if(result <= 0) {
+			Py_CLEAR(rowbuilder->pending);
+			return NULL;
+		}
+		if(!PyList_GET_SIZE(rowbuilder->pending)) {
+			Py_CLEAR(rowbuilder->pending);
+			PyErr_SetNone(PyExc_StopIteration);
+			return NULL;
+		}
+	}
+
+	row = PyList_GET_ITEM(rowbuilder->pending, rowbuilder->pending_pos);
+	Py_INCREF(row);
+	rowbuilder->pending_pos++;
+	return row;
+}
+
+
 /*
  * __iter__() method
  */
@@ -153,17 +283,48 @@ static PyObject *next(PyObject *self)
 		return NULL;
 	}
 
+	if(Py_TYPE(rowbuilder->iter) == &ligolw_Tokenizer_Type) {
+		/* .i and .row are writable so that a saved state can be
+		 * restored, check them */
+		if(PyTuple_GET_SIZE(rowbuilder->attributes) && (rowbuilder->i < 0 || rowbuilder->i >= PyTuple_GET_SIZE(rowbuilder->attributes) || !rowbuilder->row)) {
+			PyErr_SetString(PyExc_ValueError, "invalid row or attribute index");
+			return NULL;
+		}
+		item = next_pending(rowbuilder);
+		if(item)
+			return item;
+		if(PyErr_Occurred()) {
+			if(PyErr_ExceptionMatches(PyExc_StopIteration)) {
+				Py_DECREF(rowbuilder->iter);
+				rowbuilder->iter = NULL;
+			}
+			return NULL;
+		}
+		/* the fast path cannot be used */
+	}
+
 	while((item = PyIter_Next(rowbuilder->iter))) {
 		int result;
+		/* .i and .row are writable so that a saved state can be
+		 * restored, check them */
+		if(rowbuilder->i < 0 || rowbuilder->i >= PyTuple_GET_SIZE(rowbuilder->attributes) || !rowbuilder->row) {
+			PyErr_SetString(PyExc_ValueError, "invalid row or attribute index");
+			Py_DECREF(item);
+			return NULL;
+		}
 		if(rowbuilder->row == Py_None) {
-			rowbuilder->row = PyType_GenericNew(rowbuilder->rowtype, NULL, NULL);
+			rowbuilder->row = new_row(rowbuilder);
 			if(!rowbuilder->row) {
 				rowbuilder->row = Py_None;
+				Py_DECREF(item);
 				return NULL;
 			}
 			Py_DECREF(Py_None);
 		}
-		result = PyObject_SetAttr(rowbuilder->row, PyTuple_GET_ITEM(rowbuilder->attributes, rowbuilder->i), item);
+		if(Py_TYPE(rowbuilder->row) == rowbuilder->offsets_type)
+			result = llwtokenizer_slot_set(rowbuilder->row, PyTuple_GET_ITEM(rowbuilder->attributes, rowbuilder->i), rowbuilder->offsets[rowbuilder->i], item);
+		else
+			result = PyObject_SetAttr(rowbuilder->row, PyTuple_GET_ITEM(rowbuilder->attributes, rowbuilder->i), item);
 		Py_DECREF(item);
 		if(result < 0)
 			return NULL;
@@ -172,6 +333,7 @@ static PyObject *next(PyObject *self)
 			rowbuilder->row = Py_None;
 			Py_INCREF(rowbuilder->row);
 			rowbuilder->i = 0;
+			LIGOLW_PROBE1(rowbuilder_row, PyTuple_GET_SIZE(rowbuilder->attributes));
 			return row;
 		}
 	}
@@ -194,7 +356,7 @@ static PyObject *next(PyObject *self)
 static struct PyMemberDef members[] = {
 	{"rowtype", T_OBJECT, offsetof(ligolw_RowBuilder, rowtype), 0, "row class"},
 	{"attributes", T_OBJECT, offsetof(ligolw_RowBuilder, attributes), READONLY, "in-order tuple of attribute names"},
-	{"row", T_OBJECT, offsetof(ligolw_RowBuilder, row), 0, "current row object"},
+	{"row", T_OBJECT, offsetof(ligolw_RowBuilder, row), 0, "current row object (None if no row is in progress)"},
 	{"i", T_INT, offsetof(ligolw_RowBuilder, i), 0, "current attribute index"},
 	{NULL,}
 };
@@ -252,7 +414,22 @@ PyTypeObject ligolw_RowBuilder_Type = {
 ">>> l[0].snr\n"\
 "6.8\n"\
 ">>> l[1].time\n"\
-"15",
+"15\n"\
+"\n"\
+"The rows completed before a token that cannot be converted are returned\n"\
+"before the error is raised.\n"\
+"\n"\
+">>> t = tokenizer.Tokenizer(u\",\")\n"\
+">>> t.set_types([int, float])\n"\
+">>> rows = tokenizer.RowBuilder(Row, [\"time\", \"snr\"])\n"\
+">>> rows.__init__(Row, [\"time\", \"snr\"])\n"\
+">>> rows = rows.append(t.append(u\"10,6.8,15,29.1,20,x,\"))\n"\
+">>> next(rows).time, next(rows).time\n"\
+"(10, 15)\n"\
+">>> next(rows)\n"\
+"Traceback (most recent call last):\n"\
+"    ...\n"\
+"ValueError: invalid literal for float(): 'x'",
 	.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
 	.tp_init = __init__,
 	.tp_iter = __iter__,
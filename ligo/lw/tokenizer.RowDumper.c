@@ -63,9 +63,32 @@ typedef struct {
 	Py_ssize_t rows_converted;
 	/* tuple of unicode tokens from most recently converted row */
 	PyObject *tokens;
+	/* type of the most recently converted row object, and the slot
+	 * offsets of the attributes in that type */
+	PyTypeObject *rowtype;
+	Py_ssize_t *offsets;
 } ligolw_RowDumper;
 
 
+/*
+ * Release the state.  Used by __del__() and __init__(), which can be
+ * called more than once.
+ */
+
+
+static void clear(ligolw_RowDumper *rowdumper)
+{
+	Py_CLEAR(rowdumper->delimiter);
+	Py_CLEAR(rowdumper->attributes);
+	Py_CLEAR(rowdumper->formats);
+	Py_CLEAR(rowdumper->iter);
+	Py_CLEAR(rowdumper->tokens);
+	Py_CLEAR(rowdumper->rowtype);
+	free(rowdumper->offsets);
+	rowdumper->offsets = NULL;
+}
+
+
 /*
  * __del__() method
  */
@@ -73,13 +96,7 @@ typedef struct {
 
 static void __del__(PyObject *self)
 {
-	ligolw_RowDumper *rowdumper = (ligolw_RowDumper *) self;
-
-	Py_XDECREF(rowdumper->delimiter);
-	Py_XDECREF(rowdumper->attributes);
-	Py_XDECREF(rowdumper->formats);
-	Py_XDECREF(rowdumper->iter);
-	Py_XDECREF(rowdumper->tokens);
+	clear((ligolw_RowDumper *) self);
 
 	self->ob_type->tp_free(self);
 }
@@ -94,34 +111,52 @@ static int __init__(PyObject *self, PyObject *args, PyObject *kwds)
 {
 	ligolw_RowDumper *rowdumper = (ligolw_RowDumper *) self;
 	wchar_t default_delimiter = L',';
+	PyObject *attributes, *formats, *delimiter = NULL;
+	Py_ssize_t *offsets;
 
-	rowdumper->delimiter = NULL;
-	if(!PyArg_ParseTuple(args, "OO|U", &rowdumper->attributes, &rowdumper->formats, &rowdumper->delimiter))
+	if(!PyArg_ParseTuple(args, "OO|U", &attributes, &formats, &delimiter))
 		return -1;
 
-	if(rowdumper->delimiter)
-		Py_INCREF(rowdumper->delimiter);
+	if(delimiter)
+		Py_INCREF(delimiter);
 	else
-		rowdumper->delimiter = PyUnicode_FromWideChar(&default_delimiter, 1);
-	rowdumper->attributes = llwtokenizer_build_attributes(rowdumper->attributes);
-	rowdumper->formats = PySequence_Tuple(rowdumper->formats);
-	if(!rowdumper->delimiter || !rowdumper->attributes || !rowdumper->formats)
-		/* memory clean-up happens in __del__() */
-		return -1;
+		delimiter = PyUnicode_FromWideChar(&default_delimiter, 1);
+	attributes = llwtokenizer_build_attributes(attributes);
+	formats = PySequence_Tuple(formats);
+	if(!delimiter || !attributes || !formats)
+		goto error;
 
-	if(PyTuple_GET_SIZE(rowdumper->attributes) != PyTuple_GET_SIZE(rowdumper->formats)) {
-		/* memory clean-up happens in __del__() */
+	if(PyTuple_GET_SIZE(attributes) != PyTuple_GET_SIZE(formats)) {
 		PyErr_SetString(PyExc_ValueError, "len(attributes) != len(formats)");
-		return -1;
+		goto error;
+	}
+
+	offsets = malloc((PyTuple_GET_SIZE(attributes) + 1) * sizeof(*offsets));
+	if(!offsets) {
+		PyErr_NoMemory();
+		goto error;
 	}
 
+	/* release the state from an earlier call */
+	clear(rowdumper);
+
+	rowdumper->delimiter = delimiter;
+	rowdumper->attributes = attributes;
+	rowdumper->formats = formats;
 	rowdumper->rows_converted = 0;
 	rowdumper->iter = Py_None;
 	Py_INCREF(rowdumper->iter);
 	rowdumper->tokens = Py_None;
 	Py_INCREF(rowdumper->tokens);
+	rowdumper->offsets = offsets;
 
 	return 0;
+
+error:
+	Py_XDECREF(delimiter);
+	Py_XDECREF(attributes);
+	Py_XDECREF(formats);
+	return -1;
 }
 
 
@@ -207,14 +242,45 @@ static PyObject *next(PyObject *self)
 	}
 
 	/*
-	 * retrieve attributes from the row object one-by-one, convert to
+	 * if the row is a tuple its elements are the values, otherwise
+	 * the values are the row's attributes.  for the latter, look up
+	 * the locations of the attributes if the row's type has changed
+	 */
+
+	if(PyTuple_CheckExact(row)) {
+		if(PyTuple_GET_SIZE(row) != n) {
+			PyErr_Format(PyExc_ValueError, "row tuple has wrong length: expected %zd, got %zd", n, PyTuple_GET_SIZE(row));
+			Py_DECREF(tokens);
+			Py_DECREF(row);
+			return NULL;
+		}
+	} else if(Py_TYPE(row) != rowdumper->rowtype) {
+		Py_XDECREF(rowdumper->rowtype);
+		rowdumper->rowtype = NULL;
+		if(llwtokenizer_slot_offsets(Py_TYPE(row), rowdumper->attributes, rowdumper->offsets) < 0) {
+			Py_DECREF(tokens);
+			Py_DECREF(row);
+			return NULL;
+		}
+		rowdumper->rowtype = Py_TYPE(row);
+		Py_INCREF(rowdumper->rowtype);
+	}
+
+	/*
+	 * retrieve values from the row object one-by-one, convert to
 	 * strings, and insert into new token tuple
 	 */
 
 	for(i = 0; i < n; i++) {
-		PyObject *val = PyObject_GetAttr(row, PyTuple_GET_ITEM(rowdumper->attributes, i));
+		PyObject *val;
 		PyObject *token;
 
+		if(PyTuple_CheckExact(row)) {
+			val = PyTuple_GET_ITEM(row, i);
+			Py_INCREF(val);
+		} else
+			val = llwtokenizer_slot_get(row, PyTuple_GET_ITEM(rowdumper->attributes, i), rowdumper->offsets[i]);
+
 		if(!val) {
 			Py_DECREF(tokens);
 			Py_DECREF(row);
@@ -252,6 +318,7 @@ static PyObject *next(PyObject *self)
 	result = PyUnicode_Join(rowdumper->delimiter, rowdumper->tokens);
 
 	rowdumper->rows_converted += result != NULL;
+	LIGOLW_PROBE2(rowdumper_row, rowdumper->rows_converted, result ? PyUnicode_GET_LENGTH(result) : -1);
 
 	return result;
 }
@@ -318,7 +385,17 @@ PyTypeObject ligolw_RowDumper_Type = {
 "representations of the values of the attributes of those objects.  The\n" \
 "attribute values are printed in the order specified when the RowDumper was\n" \
 "created, and using the formats specified.  An attribute whose value is None\n" \
-"is printed as an empty string regardless of the requested format.",
+"is printed as an empty string regardless of the requested format.\n" \
+"\n" \
+"If the iterable yields tuples instead of row objects, the tuples' elements\n" \
+"are used as the values, in order.  This allows data that is not stored in\n" \
+"row objects to be converted without first creating row objects for it.\n" \
+"\n" \
+">>> for line in rowdumper.dump([(1.5, \"ok\"), (2.5, None)]):\n" \
+"...     print(line)\n" \
+"... \n" \
+"1.5,\"ok\"\n" \
+"2.5,",
 	.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
 	.tp_init = __init__,
 	.tp_iter = __iter__,
@@ -64,6 +64,95 @@
 static const wchar_t default_quote_characters[] = {L'\'', L'\"', 0};
 
 
+/*
+ * Token converters.  Each of the types given to set_types() is translated
+ * to one of these when the types are set, so tokens are converted by
+ * calling the converter for their position in the types list instead of
+ * by comparing the type with each of the types that have fast-paths.
+ * Types whose tokens are skipped get a NULL converter.  The token is the
+ * null-terminated string from start to end, and type is the Python type.
+ * Return a new reference, or NULL on failure.
+ */
+
+
+typedef PyObject *(*converter)(PyObject *type, const wchar_t *start, const wchar_t *end);
+
+
+static PyObject *convert_float(PyObject *type, const wchar_t *start, const wchar_t *end)
+{
+	wchar_t *conversion_end;
+	PyObject *token = PyFloat_FromDouble(wcstod(start, &conversion_end));
+
+	if(conversion_end == start || *conversion_end != 0) {
+		/*
+		 * wcstod() couldn't convert the token, emulate float()'s
+		 * error message
+		 */
+
+		Py_XDECREF(token);
+		token = PyUnicode_FromWideChar(start, -1);
+		PyErr_Format(PyExc_ValueError, "invalid literal for float(): '%U'", token);
+		Py_DECREF(token);
+		token = NULL;
+	}
+
+	return token;
+}
+
+
+static PyObject *convert_unicode(PyObject *type, const wchar_t *start, const wchar_t *end)
+{
+	return PyUnicode_FromWideChar(start, end - start);
+}
+
+
+static PyObject *convert_long(PyObject *type, const wchar_t *start, const wchar_t *end)
+{
+	wchar_t *conversion_end;
+	/* FIXME:  although Python supports arbitrary precision integers,
+	 * this can only handle numbers that fit into a C long long.  in
+	 * practice, since we invariably interoperate with C codes, that
+	 * should be sufficient, but it's a limitation of the library and
+	 * should probably be fixed */
+	PyObject *token = PyLong_FromLongLong(wcstoll(start, &conversion_end, 0));
+
+	if(conversion_end == start || *conversion_end != 0) {
+		/*
+		 * wcstoll() couldn't convert the token, emulate long()'s
+		 * error message
+		 */
+
+		Py_XDECREF(token);
+		token = PyUnicode_FromWideChar(start, -1);
+		PyErr_Format(PyExc_ValueError, "invalid literal for long(): '%U'", token);
+		Py_DECREF(token);
+		token = NULL;
+	}
+
+	return token;
+}
+
+
+static PyObject *convert_call(PyObject *type, const wchar_t *start, const wchar_t *end)
+{
+	return PyObject_CallFunction(type, "u#", start, end - start);
+}
+
+
+static converter type_converter(PyObject *type)
+{
+	if(type == Py_None)
+		return NULL;
+	if(type == (PyObject *) &PyFloat_Type)
+		return convert_float;
+	if(type == (PyObject *) &PyUnicode_Type)
+		return convert_unicode;
+	if(type == (PyObject *) &PyLong_Type)
+		return convert_long;
+	return convert_call;
+}
+
+
 /*
  * Structure
  */
@@ -73,6 +162,8 @@ typedef struct {
 	PyObject_HEAD
 	/* list of the types to which parsed tokens will be converted */
 	PyObject **types;
+	/* the converter for each type in the types list */
+	converter *converters;
 	/* end of the types list */
 	PyObject **types_length;
 	/* the type to which the next parsed token will be converted */
@@ -186,7 +277,9 @@ static void unref_types(ligolw_Tokenizer *tokenizer)
 		Py_DECREF(*tokenizer->type);
 
 	free(tokenizer->types);
+	free(tokenizer->converters);
 	tokenizer->types = NULL;
+	tokenizer->converters = NULL;
 	tokenizer->types_length = NULL;
 	tokenizer->type = NULL;
 }
@@ -281,11 +374,12 @@ static int unescape(wchar_t *start, wchar_t **end, const wchar_t *escapable_char
  * an empty token is encountered (only whitespace between two delimiters)
  * then start and end are both set to NULL so that calling code can tell
  * the difference between a zero-length token and an absent token.  If a
- * non-empty token is found, it will be NULL terminated.  The return value
- * is the Python type to which the text should be converted, or NULL on
- * error.  On error, the values of start and end are undefined.  Raises
- * StopIteration if the end of the tokenizer's internal buffer is reached,
- * or ValueError if a parse error occurs.
+ * non-empty token is found, it will be NULL terminated.  tokenizer->pos is
+ * advanced past the token, but tokenizer->type is not changed.  The return
+ * value is 1 if a token was found, 0 if the end of the tokenizer's
+ * internal buffer was reached (no exception is set), or -1 if a parse
+ * error occurs (ValueError is raised).  On error, the values of start and
+ * end are undefined.
  *
  * If an error occurs parsing must stop.  An error can result in the
  * tokenizer context being left unmodified, causing subsequent calls to
@@ -294,11 +388,10 @@ static int unescape(wchar_t *start, wchar_t **end, const wchar_t *escapable_char
  */
 
 
-static PyObject *next_token(ligolw_Tokenizer *tokenizer, wchar_t **start, wchar_t **end)
+static int scan_token(ligolw_Tokenizer *tokenizer, wchar_t **start, wchar_t **end)
 {
 	wchar_t *pos = tokenizer->pos;
 	wchar_t *bailout = tokenizer->length;
-	PyObject *type = *tokenizer->type;
 	wchar_t quote_character;
 
 	/*
@@ -374,7 +467,7 @@ static PyObject *next_token(ligolw_Tokenizer *tokenizer, wchar_t **start, wchar_
 	while(*pos != tokenizer->delimiter) {
 		if(!iswspace(*pos)) {
 			parse_error(PyExc_ValueError, *start, tokenizer->length - *start - 1, pos, "expected whitespace or delimiter");
-			return NULL;
+			return -1;
 		}
 		if(++pos >= bailout)
 			goto stop_iteration;
@@ -387,19 +480,12 @@ static PyObject *next_token(ligolw_Tokenizer *tokenizer, wchar_t **start, wchar_
 
 	tokenizer->pos = ++pos;
 
-	/*
-	 * Select the next type
-	 */
-
-	if(++tokenizer->type >= tokenizer->types_length)
-		tokenizer->type = tokenizer->types;
-
 	/*
 	 * NULL terminate the token, and if it was quoted unescape special
 	 * characters.  The unescape() function modifies the token in
-	 * place, so we call it after advancing tokenizer->pos and
-	 * tokenizer->type so that if a failure occurs we don't leave the
-	 * tokenizer pointed at a garbled string.
+	 * place, so we call it after advancing tokenizer->pos so that if a
+	 * failure occurs we don't leave the tokenizer pointed at a garbled
+	 * string.
 	 */
 
 	if(*end)
@@ -407,28 +493,55 @@ static PyObject *next_token(ligolw_Tokenizer *tokenizer, wchar_t **start, wchar_
 	if(quote_character) {
 		wchar_t escapable_characters[] = {quote_character, ESCAPE_CHARACTER, 0};
 		if(unescape(*start, end, escapable_characters))
-			return NULL;
+			return -1;
 	}
 
 	/*
 	 * Done.  *start points to the first character of the token, *end
 	 * points to the first character following the token (or both are
-	 * NULL if there was nothing but unquoted whitespace),
-	 * tokenizer->pos and tokenizer->type have been advanced in
-	 * readiness for the next token, and the return value is the python
-	 * type to which the current token is to be converted.
+	 * NULL if there was nothing but unquoted whitespace), and
+	 * tokenizer->pos has been advanced in readiness for the next
+	 * token.
 	 */
 
-	return type;
+	return 1;
 
 	/*
-	 * Errors
+	 * End of buffer
 	 */
 
 stop_iteration:
 	advance_to_pos(tokenizer);
-	PyErr_SetNone(PyExc_StopIteration);
-	return NULL;
+	return 0;
+}
+
+
+/*
+ * Wrapper for scan_token() that also advances tokenizer->type.  The
+ * return value is the address of the entry in the types list giving the
+ * Python type to which the token should be converted, or NULL on error.
+ * Raises StopIteration if the end of the tokenizer's internal buffer is
+ * reached, or ValueError if a parse error occurs.
+ */
+
+
+static PyObject **next_token(ligolw_Tokenizer *tokenizer, wchar_t **start, wchar_t **end)
+{
+	PyObject **type = tokenizer->type;
+
+	switch(scan_token(tokenizer, start, end)) {
+	case 0:
+		PyErr_SetNone(PyExc_StopIteration);
+		return NULL;
+
+	case -1:
+		return NULL;
+	}
+
+	if(++tokenizer->type >= tokenizer->types_length)
+		tokenizer->type = tokenizer->types;
+
+	return type;
 }
 
 
@@ -450,6 +563,7 @@ static PyObject *append(PyObject *self, PyObject *data)
 #endif
 	if(add_to_data((ligolw_Tokenizer *) self, data) < 0)
 		return PyErr_NoMemory();
+	LIGOLW_PROBE2(tokenizer_append, PyUnicode_GET_LENGTH(data), ((ligolw_Tokenizer *) self)->length - ((ligolw_Tokenizer *) self)->pos);
 
 	Py_INCREF(self);
 	return self;
@@ -501,8 +615,18 @@ static int __init__(PyObject *self, PyObject *args, PyObject *kwds)
 
 	PyUnicode_AsWideChar(arg, &tokenizer->delimiter, 1);
 	tokenizer->types = malloc(1 * sizeof(*tokenizer->types));
+	tokenizer->converters = malloc(1 * sizeof(*tokenizer->converters));
+	if(!tokenizer->types || !tokenizer->converters) {
+		free(tokenizer->types);
+		free(tokenizer->converters);
+		tokenizer->types = NULL;
+		tokenizer->converters = NULL;
+		PyErr_NoMemory();
+		return -1;
+	}
 	tokenizer->types_length = &tokenizer->types[1];
 	tokenizer->types[0] = (PyObject *) &PyUnicode_Type;
+	tokenizer->converters[0] = convert_unicode;
 	Py_INCREF(tokenizer->types[0]);
 	tokenizer->type = tokenizer->types;
 	tokenizer->allocation = 0;
@@ -534,8 +658,7 @@ static PyObject *__iter__(PyObject *self)
 static PyObject *next(PyObject *self)
 {
 	ligolw_Tokenizer *tokenizer = (ligolw_Tokenizer *) self;
-	PyObject *type;
-	PyObject *token;
+	PyObject **type;
 	wchar_t *start, *end;
 
 	/*
@@ -546,7 +669,7 @@ static PyObject *next(PyObject *self)
 		type = next_token(tokenizer, &start, &end);
 		if(!type)
 			return NULL;
-	} while(type == Py_None);
+	} while(!tokenizer->converters[type - tokenizer->types]);
 
 	/*
 	 * Extract token as desired type.
@@ -558,54 +681,112 @@ static PyObject *next(PyObject *self)
 		 */
 
 		Py_INCREF(Py_None);
-		token = Py_None;
-	} else if(type == (PyObject *) &PyFloat_Type) {
-		wchar_t *conversion_end;
-		token = PyFloat_FromDouble(wcstod(start, &conversion_end));
-		if(conversion_end == start || *conversion_end != 0) {
-			/*
-			 * wcstod() couldn't convert the token, emulate
-			 * float()'s error message
-			 */
+		return Py_None;
+	}
 
-			Py_XDECREF(token);
-			token = PyUnicode_FromWideChar(start, -1);
-			PyErr_Format(PyExc_ValueError, "invalid literal for float(): '%U'", token);
-			Py_DECREF(token);
-			token = NULL;
+	return tokenizer->converters[type - tokenizer->types](*type, start, end);
+}
+
+
+/*
+ * Parse whole rows.  This is the fast path used by RowBuilder when its
+ * tokens come directly from a Tokenizer.  The tokens are scanned and
+ * converted by calling the converter for each column in turn, and stored
+ * in the row objects' slots, with no per-token iterator protocol.  rowtype
+ * is the class of the row objects, attributes the tuple of the names of
+ * the attributes to which the tokens not skipped are assigned, and offsets
+ * the slot offsets of the attributes in rowtype (-1 for the attribute
+ * protocol).  *row and *i are the row in progress (None if none) and the
+ * index of the next attribute to be set in it, and are updated.  Complete
+ * rows are appended to the list rows.  Returns 1 when the end of the
+ * tokenizer's buffer is reached, 0 if the fast path cannot be used
+ * because the types do not line up with the attributes (the caller must
+ * iterate over the tokenizer), or -1 on error.
+ */
+
+
+int llwtokenizer_build_rows(PyObject *self, PyTypeObject *rowtype, PyObject *attributes, const Py_ssize_t *offsets, PyObject **row, int *i, PyObject *rows)
+{
+	ligolw_Tokenizer *tokenizer = (ligolw_Tokenizer *) self;
+	PyObject **types = tokenizer->types;
+	PyObject **types_length = tokenizer->types_length;
+	PyObject **type = tokenizer->type;
+	converter *conv;
+	Py_ssize_t nattrs = PyTuple_GET_SIZE(attributes);
+	Py_ssize_t n = 0, before = 0, j;
+	int result = 1;
+
+	/*
+	 * the tokens that are not skipped must be the attributes in
+	 * order, and the next one must be the attribute at *i
+	 */
+
+	for(j = 0; &types[j] < types_length; j++)
+		if(tokenizer->converters[j]) {
+			if(&types[j] < type)
+				before++;
+			n++;
 		}
-	} else if(type == (PyObject *) &PyUnicode_Type) {
-		token = PyUnicode_FromWideChar(start, end - start);
-	} else if(type == (PyObject *) &PyLong_Type) {
-		wchar_t *conversion_end;
-		/* FIXME:  although Python supports arbitrary precision
-		 * integers, this can only handle numbers that fit into a C
-		 * long long.  in practice, since we invariably
-		 * interoperate with C codes, that should be sufficient,
-		 * but it's a limitation of the library and should probably
-		 * be fixed */
-		token = PyLong_FromLongLong(wcstoll(start, &conversion_end, 0));
-		if(conversion_end == start || *conversion_end != 0) {
-			/*
-			 * wcstoll() couldn't convert the token, emulate
-			 * long()'s error message
-			 */
+	if(n != nattrs || before != *i)
+		return 0;
 
-			Py_XDECREF(token);
-			token = PyUnicode_FromWideChar(start, -1);
-			PyErr_Format(PyExc_ValueError, "invalid literal for long(): '%U'", token);
+	conv = &tokenizer->converters[type - types];
+	while(1) {
+		for(; type < types_length; type++, conv++) {
+			wchar_t *start, *end;
+			PyObject *token;
+			int status = scan_token(tokenizer, &start, &end);
+			if(status <= 0) {
+				result = status < 0 ? -1 : 1;
+				goto done;
+			}
+			if(!*conv)
+				continue;
+			if(*row == Py_None) {
+				PyObject *new = PyType_GenericNew(rowtype, NULL, NULL);
+				if(!new) {
+					type++;
+					result = -1;
+					goto done;
+				}
+				Py_DECREF(*row);
+				*row = new;
+			}
+			if(start)
+				token = (*conv)(*type, start, end);
+			else {
+				/* unquoted zero-length string == None */
+				token = Py_None;
+				Py_INCREF(token);
+			}
+			if(!token || (Py_TYPE(*row) == rowtype ? llwtokenizer_slot_set(*row, PyTuple_GET_ITEM(attributes, *i), offsets[*i], token) : PyObject_SetAttr(*row, PyTuple_GET_ITEM(attributes, *i), token)) < 0) {
+				Py_XDECREF(token);
+				type++;
+				result = -1;
+				goto done;
+			}
 			Py_DECREF(token);
-			token = NULL;
+			if(++*i >= nattrs) {
+				int status = PyList_Append(rows, *row);
+				Py_DECREF(*row);
+				*row = Py_None;
+				Py_INCREF(*row);
+				*i = 0;
+				if(status < 0) {
+					type++;
+					result = -1;
+					goto done;
+				}
+				LIGOLW_PROBE1(rowbuilder_row, nattrs);
+			}
 		}
-	} else {
-		token = PyObject_CallFunction(type, "u#", start, end - start);
+		type = types;
+		conv = tokenizer->converters;
 	}
 
-	/*
-	 * Done.
-	 */
-
-	return token;
+done:
+	tokenizer->type = type < types_length ? type : types;
+	return result;
 }
 
 
@@ -639,7 +820,12 @@ static PyObject *set_types(PyObject *self, PyObject *sequence)
 	 */
 
 	tokenizer->types = malloc(length * sizeof(*tokenizer->types));
-	if(!tokenizer->types) {
+	tokenizer->converters = malloc(length * sizeof(*tokenizer->converters));
+	if(!tokenizer->types || !tokenizer->converters) {
+		free(tokenizer->types);
+		free(tokenizer->converters);
+		tokenizer->types = NULL;
+		tokenizer->converters = NULL;
 		Py_DECREF(sequence);
 		return PyErr_NoMemory();
 	}
@@ -652,6 +838,7 @@ static PyObject *set_types(PyObject *self, PyObject *sequence)
 
 	for(i = 0; i < length; i++) {
 		tokenizer->types[i] = PyTuple_GET_ITEM(sequence, i);
+		tokenizer->converters[i] = type_converter(tokenizer->types[i]);
 		Py_INCREF(tokenizer->types[i]);
 	}
 
@@ -678,6 +865,37 @@ static PyObject *attribute_get_data(PyObject *obj, void *data)
 }
 
 
+static PyObject *attribute_get_type_index(PyObject *obj, void *data)
+{
+	ligolw_Tokenizer *tokenizer = (ligolw_Tokenizer *) obj;
+
+	return PyLong_FromSsize_t(tokenizer->type ? tokenizer->type - tokenizer->types : 0);
+}
+
+
+static int attribute_set_type_index(PyObject *obj, PyObject *val, void *data)
+{
+	ligolw_Tokenizer *tokenizer = (ligolw_Tokenizer *) obj;
+	Py_ssize_t i;
+
+	if(!val) {
+		PyErr_SetString(PyExc_AttributeError, "cannot delete type_index");
+		return -1;
+	}
+	i = PyLong_AsSsize_t(val);
+	if(i == -1 && PyErr_Occurred())
+		return -1;
+	if(i < 0 || i >= tokenizer->types_length - tokenizer->types) {
+		PyErr_SetString(PyExc_IndexError, "type_index out of range");
+		return -1;
+	}
+
+	tokenizer->type = &tokenizer->types[i];
+
+	return 0;
+}
+
+
 /*
  * Type information
  */
@@ -692,6 +910,7 @@ static struct PyMethodDef methods[] = {
 
 static struct PyGetSetDef getset[] = {
 	{"data", attribute_get_data, NULL, "The current contents of the internal buffer.", NULL},
+	{"type_index", attribute_get_type_index, attribute_set_type_index, "The index in the types list of the type to which the next token will be converted.  Together with .data, this is the state needed to resume tokenizing a stream:  a new Tokenizer configured with the same types, given the saved .data with .append() and the saved .type_index, produces the same tokens from the rest of the stream as the original would have.", NULL},
 	{NULL,}
 };
 
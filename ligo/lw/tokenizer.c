@@ -27,6 +27,7 @@
 
 
 #include <Python.h>
+#include <structmember.h>
 #include <tokenizer.h>
 
 
@@ -79,6 +80,105 @@ PyObject *llwtokenizer_build_attributes(PyObject *sequence)
 }
 
 
+/*
+ * Resolve the attributes named in the tuple attributes to the offsets at
+ * which instances of type store them, if they are plain __slots__
+ * attributes.  The offset of an attribute that is not a plain slot (e.g.,
+ * is a property, or is stored in the instance's __dict__) is set to -1,
+ * and calling code must fall back to the generic attribute protocol for
+ * it.  Offsets are only meaningful for objects whose type is exactly
+ * type.  Returns 0 on success, -1 on failure.
+ */
+
+
+int llwtokenizer_slot_offsets(PyTypeObject *type, PyObject *attributes, Py_ssize_t *offsets)
+{
+	Py_ssize_t n = PyTuple_GET_SIZE(attributes);
+	Py_ssize_t i;
+
+	for(i = 0; i < n; i++)
+		offsets[i] = -1;
+
+	/*
+	 * if the type has customized attribute access there's nothing we
+	 * can safely do
+	 */
+
+	if(type->tp_getattro != PyObject_GenericGetAttr || type->tp_setattro != PyObject_GenericSetAttr)
+		return 0;
+
+	for(i = 0; i < n; i++) {
+		PyObject *descr = PyObject_GetAttr((PyObject *) type, PyTuple_GET_ITEM(attributes, i));
+		if(!descr) {
+			/*
+			 * not a class attribute at all.  must be
+			 * something that goes in the instance's __dict__
+			 */
+			if(!PyErr_ExceptionMatches(PyExc_AttributeError))
+				return -1;
+			PyErr_Clear();
+			continue;
+		}
+		if(Py_TYPE(descr) == &PyMemberDescr_Type) {
+			PyMemberDef *member = ((PyMemberDescrObject *) descr)->d_member;
+			if(member->type == T_OBJECT_EX && !(member->flags & READONLY))
+				offsets[i] = member->offset;
+		}
+		Py_DECREF(descr);
+	}
+
+	return 0;
+}
+
+
+/*
+ * Retrieve the value of an attribute from an object using an offset
+ * computed by llwtokenizer_slot_offsets().  Returns a new reference, or
+ * NULL on failure.
+ */
+
+
+PyObject *llwtokenizer_slot_get(PyObject *obj, PyObject *name, Py_ssize_t offset)
+{
+	PyObject *val;
+
+	if(offset < 0)
+		return PyObject_GetAttr(obj, name);
+
+	val = *(PyObject **) ((char *) obj + offset);
+	if(!val) {
+		PyErr_Format(PyExc_AttributeError, "'%.50s' object has no attribute '%U'", Py_TYPE(obj)->tp_name, name);
+		return NULL;
+	}
+	Py_INCREF(val);
+	return val;
+}
+
+
+/*
+ * Set the value of an attribute of an object using an offset computed by
+ * llwtokenizer_slot_offsets().  Does not steal a reference to val.
+ * Returns 0 on success, -1 on failure.
+ */
+
+
+int llwtokenizer_slot_set(PyObject *obj, PyObject *name, Py_ssize_t offset, PyObject *val)
+{
+	PyObject **slot;
+	PyObject *old;
+
+	if(offset < 0)
+		return PyObject_SetAttr(obj, name, val);
+
+	slot = (PyObject **) ((char *) obj + offset);
+	old = *slot;
+	Py_INCREF(val);
+	*slot = val;
+	Py_XDECREF(old);
+	return 0;
+}
+
+
 static int type_ready_and_add(PyObject *module, const char *name, PyTypeObject *type)
 {
 	if(!type || PyType_Ready(type) < 0)
@@ -134,6 +234,29 @@ PyMODINIT_FUNC PyInit_tokenizer(void)
 		goto error;
 	if(type_ready_and_add(module, "RowDumper", &ligolw_RowDumper_Type) < 0)
 		goto error;
+	if(type_ready_and_add(module, "GPSProperty", &ligolw_GPSProperty_Type) < 0)
+		goto error;
+	if(type_ready_and_add(module, "SegmentProperty", &ligolw_SegmentProperty_Type) < 0)
+		goto error;
+	if(type_ready_and_add(module, "InstrumentsProperty", &ligolw_InstrumentsProperty_Type) < 0)
+		goto error;
+
+	/*
+	 * Add the functions
+	 */
+
+	if(PyModule_AddFunctions(module, llwtokenizer_pack_methods) < 0)
+		goto error;
+	if(PyModule_AddFunctions(module, llwtokenizer_sort_methods) < 0)
+		goto error;
+	if(PyModule_AddFunctions(module, llwtokenizer_index_methods) < 0)
+		goto error;
+	if(PyModule_AddFunctions(module, llwtokenizer_hash_methods) < 0)
+		goto error;
+	if(PyModule_AddFunctions(module, llwtokenizer_properties_methods) < 0)
+		goto error;
+	if(PyModule_AddFunctions(module, llwtokenizer_vtab_methods) < 0)
+		goto error;
 
 	/*
 	 * Done.
@@ -32,6 +32,23 @@
 #define MODULE_NAME "ligo.lw.tokenizer"
 
 
+/*
+ * Static (USDT) probes for perf and bpftrace, in the "ligolw" provider.
+ * They compile to nothing if sys/sdt.h is not available, and to a nop
+ * instruction otherwise.
+ */
+
+
+#ifdef HAVE_SYS_SDT_H
+#include <sys/sdt.h>
+#define LIGOLW_PROBE1(name, a) DTRACE_PROBE1(ligolw, name, a)
+#define LIGOLW_PROBE2(name, a, b) DTRACE_PROBE2(ligolw, name, a, b)
+#else
+#define LIGOLW_PROBE1(name, a)
+#define LIGOLW_PROBE2(name, a, b)
+#endif
+
+
 /*
  * Classes
  */
@@ -40,6 +57,22 @@
 extern PyTypeObject ligolw_Tokenizer_Type;
 extern PyTypeObject ligolw_RowBuilder_Type;
 extern PyTypeObject ligolw_RowDumper_Type;
+extern PyTypeObject ligolw_GPSProperty_Type;
+extern PyTypeObject ligolw_SegmentProperty_Type;
+extern PyTypeObject ligolw_InstrumentsProperty_Type;
+
+
+/*
+ * Module functions
+ */
+
+
+extern PyMethodDef llwtokenizer_pack_methods[];
+extern PyMethodDef llwtokenizer_sort_methods[];
+extern PyMethodDef llwtokenizer_index_methods[];
+extern PyMethodDef llwtokenizer_hash_methods[];
+extern PyMethodDef llwtokenizer_properties_methods[];
+extern PyMethodDef llwtokenizer_vtab_methods[];
 
 
 /*
@@ -48,3 +81,7 @@ extern PyTypeObject ligolw_RowDumper_Type;
 
 
 PyObject *llwtokenizer_build_attributes(PyObject *sequence);
+int llwtokenizer_slot_offsets(PyTypeObject *type, PyObject *attributes, Py_ssize_t *offsets);
+PyObject *llwtokenizer_slot_get(PyObject *obj, PyObject *name, Py_ssize_t offset);
+int llwtokenizer_slot_set(PyObject *obj, PyObject *name, Py_ssize_t offset, PyObject *val);
+int llwtokenizer_build_rows(PyObject *tokenizer, PyTypeObject *rowtype, PyObject *attributes, const Py_ssize_t *offsets, PyObject **row, int *i, PyObject *rows);
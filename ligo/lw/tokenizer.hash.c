@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2026  Kipp C. Cannon
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                       tokenizer Row Hashing Functions
+ *
+ * ============================================================================
+ */
+
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tokenizer.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                              Internal Helpers
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * Access to the attributes of a sequence of rows.  Slot offsets are
+ * resolved for the type of the first row, rows of other types use the
+ * generic attribute protocol.
+ */
+
+
+struct row_attributes {
+	PyObject *attributes;
+	PyTypeObject *rowtype;
+	Py_ssize_t *offsets;
+	Py_ssize_t n;
+};
+
+
+static int row_attributes_init(struct row_attributes *ra, PyObject *names, PyObject *first)
+{
+	ra->attributes = llwtokenizer_build_attributes(names);
+	if(!ra->attributes)
+		return -1;
+	ra->n = PyTuple_GET_SIZE(ra->attributes);
+	ra->offsets = malloc((ra->n + 1) * sizeof(*ra->offsets));
+	if(!ra->offsets) {
+		PyErr_NoMemory();
+		return -1;
+	}
+	ra->rowtype = first ? Py_TYPE(first) : NULL;
+	if(ra->rowtype)
+		return llwtokenizer_slot_offsets(ra->rowtype, ra->attributes, ra->offsets);
+	return 0;
+}
+
+
+static void row_attributes_free(struct row_attributes *ra)
+{
+	Py_XDECREF(ra->attributes);
+	free(ra->offsets);
+}
+
+
+static PyObject *row_attributes_get(const struct row_attributes *ra, PyObject *row, Py_ssize_t j)
+{
+	return llwtokenizer_slot_get(row, PyTuple_GET_ITEM(ra->attributes, j), Py_TYPE(row) == ra->rowtype ? ra->offsets[j] : -1);
+}
+
+
+/*
+ * Hash the values of a row's attributes.  The values are combined the way
+ * Python combines the hashes of a tuple's elements, so rows whose values
+ * compare equal have equal hashes.  Returns -1 on failure.
+ */
+
+
+static Py_hash_t row_hash(const struct row_attributes *ra, PyObject *row)
+{
+	uint64_t acc = UINT64_C(2870177450012600261);
+	Py_ssize_t j;
+
+	for(j = 0; j < ra->n; j++) {
+		PyObject *val = row_attributes_get(ra, row, j);
+		Py_hash_t h;
+		if(!val)
+			return -1;
+		h = PyObject_Hash(val);
+		Py_DECREF(val);
+		if(h == -1)
+			return -1;
+		acc += (uint64_t) h * UINT64_C(14029467366897019727);
+		acc = (acc << 31) | (acc >> 33);
+		acc *= UINT64_C(11400714785074694791);
+	}
+	acc += (uint64_t) ra->n ^ (UINT64_C(2870177450012600261) ^ UINT64_C(3527539));
+	/* -1 is reserved for errors */
+	return acc == (uint64_t) -1 ? 1546275796 : (Py_hash_t) acc;
+}
+
+
+/*
+ * Compare two values for equality.  Floats, integers and strings, which
+ * make up most row data, are compared without going through Python's
+ * comparison machinery.  Returns 1 if equal, 0 if not, -1 on failure.
+ */
+
+
+static int values_equal(PyObject *a, PyObject *b)
+{
+	if(a == b)
+		return 1;
+	if(PyFloat_CheckExact(a) && PyFloat_CheckExact(b))
+		return PyFloat_AS_DOUBLE(a) == PyFloat_AS_DOUBLE(b);
+	if(PyLong_CheckExact(a) && PyLong_CheckExact(b)) {
+		int overflow_a, overflow_b;
+		long long x = PyLong_AsLongLongAndOverflow(a, &overflow_a);
+		long long y = PyLong_AsLongLongAndOverflow(b, &overflow_b);
+		if(!overflow_a && !overflow_b)
+			return x == y;
+	} else if(PyUnicode_CheckExact(a) && PyUnicode_CheckExact(b)) {
+		if(PyUnicode_GET_LENGTH(a) != PyUnicode_GET_LENGTH(b))
+			return 0;
+		return PyUnicode_Compare(a, b) == 0;
+	}
+	return PyObject_RichCompareBool(a, b, Py_EQ);
+}
+
+
+/*
+ * Compare the values of two rows' attributes.  Returns 1 if all are
+ * equal, 0 if not, -1 on failure.
+ */
+
+
+static int rows_equal(const struct row_attributes *ra, PyObject *a, PyObject *b)
+{
+	Py_ssize_t j;
+
+	for(j = 0; j < ra->n; j++) {
+		PyObject *x = row_attributes_get(ra, a, j);
+		PyObject *y = x ? row_attributes_get(ra, b, j) : NULL;
+		int result;
+		if(!y) {
+			Py_XDECREF(x);
+			return -1;
+		}
+		result = values_equal(x, y);
+		Py_DECREF(x);
+		Py_DECREF(y);
+		if(result <= 0)
+			return result;
+	}
+	return 1;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Functions
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * hash_rows()
+ */
+
+
+static PyObject *hash_rows(PyObject *self, PyObject *args)
+{
+	PyObject *rows, *names;
+	struct row_attributes ra = {NULL, NULL, NULL, 0};
+	PyObject *result = NULL;
+	Py_ssize_t n, i;
+
+	if(!PyArg_ParseTuple(args, "OO", &rows, &names))
+		return NULL;
+
+	rows = PySequence_Fast(rows, "rows must be a sequence");
+	if(!rows)
+		return NULL;
+	n = PySequence_Fast_GET_SIZE(rows);
+	if(row_attributes_init(&ra, names, n ? PySequence_Fast_GET_ITEM(rows, 0) : NULL) < 0)
+		goto done;
+
+	result = PyBytes_FromStringAndSize(NULL, n * sizeof(int64_t));
+	if(!result)
+		goto done;
+	for(i = 0; i < n; i++) {
+		int64_t h = row_hash(&ra, PySequence_Fast_GET_ITEM(rows, i));
+		if(h == -1) {
+			Py_CLEAR(result);
+			goto done;
+		}
+		memcpy(PyBytes_AS_STRING(result) + i * sizeof(h), &h, sizeof(h));
+	}
+
+done:
+	row_attributes_free(&ra);
+	Py_DECREF(rows);
+	return result;
+}
+
+
+/*
+ * unique_rows()
+ */
+
+
+static PyObject *unique_rows(PyObject *self, PyObject *args)
+{
+	PyObject *rows, *names;
+	PyObject *snapshot = NULL, *kept = NULL;
+	struct row_attributes ra = {NULL, NULL, NULL, 0};
+	Py_ssize_t *table = NULL;
+	Py_hash_t *hashes = NULL;
+	size_t size = 16, mask;
+	Py_ssize_t n, i;
+	PyObject *retval = NULL;
+
+	if(!PyArg_ParseTuple(args, "OO", &rows, &names))
+		return NULL;
+	if(!PyList_Check(rows)) {
+		PyErr_SetString(PyExc_TypeError, "rows must be a list");
+		return NULL;
+	}
+
+	/*
+	 * work from a copy of the list so that comparisons that modify the
+	 * list cannot change the rows out from under us
+	 */
+
+	snapshot = PyList_GetSlice(rows, 0, PY_SSIZE_T_MAX);
+	if(!snapshot)
+		goto done;
+	n = PyList_GET_SIZE(snapshot);
+	if(row_attributes_init(&ra, names, n ? PyList_GET_ITEM(snapshot, 0) : NULL) < 0)
+		goto done;
+
+	/*
+	 * open-addressing hash table of the indexes of the distinct rows
+	 * seen so far.  empty slots hold -1
+	 */
+
+	while(size < 2 * (size_t) n)
+		size *= 2;
+	mask = size - 1;
+	table = malloc(size * sizeof(*table));
+	hashes = malloc((n + 1) * sizeof(*hashes));
+	kept = PyList_New(0);
+	if(!table || !hashes) {
+		PyErr_NoMemory();
+		goto done;
+	}
+	if(!kept)
+		goto done;
+	for(i = 0; i < (Py_ssize_t) size; i++)
+		table[i] = -1;
+
+	for(i = 0; i < n; i++) {
+		PyObject *row = PyList_GET_ITEM(snapshot, i);
+		size_t slot;
+		hashes[i] = row_hash(&ra, row);
+		if(hashes[i] == -1)
+			goto done;
+		for(slot = (size_t) hashes[i] & mask; table[slot] >= 0; slot = (slot + 1) & mask) {
+			int equal;
+			if(hashes[table[slot]] != hashes[i])
+				continue;
+			equal = rows_equal(&ra, PyList_GET_ITEM(snapshot, table[slot]), row);
+			if(equal < 0)
+				goto done;
+			if(equal)
+				break;
+		}
+		if(table[slot] >= 0)
+			/* duplicate */
+			continue;
+		table[slot] = i;
+		if(PyList_Append(kept, row) < 0)
+			goto done;
+	}
+
+	if(PyList_SetSlice(rows, 0, PY_SSIZE_T_MAX, kept) < 0)
+		goto done;
+	retval = PyLong_FromSsize_t(n - PyList_GET_SIZE(kept));
+
+done:
+	free(table);
+	free(hashes);
+	row_attributes_free(&ra);
+	Py_XDECREF(kept);
+	Py_XDECREF(snapshot);
+	return retval;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                            Function Information
+ *
+ * ============================================================================
+ */
+
+
+PyMethodDef llwtokenizer_hash_methods[] = {
+	{"hash_rows", hash_rows, METH_VARARGS,
+"hash_rows(rows, attributes)\n"\
+"\n"\
+"Compute a hash of the values of the named attributes of each row in the\n"\
+"sequence rows.  Rows whose values compare equal have equal hashes.  The\n"\
+"return value is a bytes object holding one 64-bit signed integer in native\n"\
+"byte order for each row.  The hashes are not stable from one Python process\n"\
+"to the next, see PYTHONHASHSEED.\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> import array\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> class Row(object):\n"\
+"...     __slots__ = (\"ifo\", \"snr\")\n"\
+"...     def __init__(self, ifo, snr):\n"\
+"...             self.ifo, self.snr = ifo, snr\n"\
+"...\n"\
+">>> a, b, c = array.array(\"q\", tokenizer.hash_rows([Row(\"H1\", 8.), Row(\"H1\", 8), Row(\"L1\", 8.)], (\"ifo\", \"snr\")))\n"\
+">>> a == b, a == c\n"\
+"(True, False)"
+	},
+	{"unique_rows", unique_rows, METH_VARARGS,
+"unique_rows(rows, attributes)\n"\
+"\n"\
+"Remove duplicate rows from the list rows, in place.  Two rows are\n"\
+"duplicates if the values of all of the named attributes are equal.  The\n"\
+"first of each set of duplicates is retained, and the order of the rows is\n"\
+"otherwise preserved.  The rows are hashed and compared in C, with fast\n"\
+"paths for float, integer and string values;  other values are compared\n"\
+"with Python's == operator.  Returns the number of rows removed.\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> class Row(object):\n"\
+"...     __slots__ = (\"ifo\", \"snr\")\n"\
+"...     def __init__(self, ifo, snr):\n"\
+"...             self.ifo, self.snr = ifo, snr\n"\
+"...\n"\
+">>> rows = [Row(\"H1\", 8.), Row(\"L1\", 8.), Row(\"H1\", 8.), Row(\"H1\", None), Row(\"H1\", 9.)]\n"\
+">>> tokenizer.unique_rows(rows, (\"ifo\", \"snr\"))\n"\
+"1\n"\
+">>> [(row.ifo, row.snr) for row in rows]\n"\
+"[('H1', 8.0), ('L1', 8.0), ('H1', None), ('H1', 9.0)]\n"\
+">>> tokenizer.unique_rows(rows, (\"ifo\",))\n"\
+"2\n"\
+">>> [(row.ifo, row.snr) for row in rows]\n"\
+"[('H1', 8.0), ('L1', 8.0)]"
+	},
+	{NULL,}
+};
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2026  Kipp C. Cannon
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                       tokenizer Row Indexing Functions
+ *
+ * ============================================================================
+ */
+
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tokenizer.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                              Internal Helpers
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * An open-addressing hash table mapping 64-bit integer IDs to row
+ * indexes.  Empty slots hold the index -1.
+ */
+
+
+struct id_index {
+	int64_t *ids;
+	Py_ssize_t *rows;
+	size_t mask;
+};
+
+
+static size_t id_hash(int64_t id)
+{
+	/* Fibonacci hashing.  IDs are often consecutive integers */
+	return (size_t) (((uint64_t) id * UINT64_C(0x9e3779b97f4a7c15)) >> 17);
+}
+
+
+static int id_index_init(struct id_index *index, Py_ssize_t n)
+{
+	size_t size = 16;
+	size_t i;
+
+	while(size < 2 * (size_t) n)
+		size *= 2;
+	index->ids = malloc(size * sizeof(*index->ids));
+	index->rows = malloc(size * sizeof(*index->rows));
+	index->mask = size - 1;
+	if(!index->ids || !index->rows) {
+		PyErr_NoMemory();
+		return -1;
+	}
+	for(i = 0; i < size; i++)
+		index->rows[i] = -1;
+	return 0;
+}
+
+
+static void id_index_free(struct id_index *index)
+{
+	free(index->ids);
+	free(index->rows);
+}
+
+
+/*
+ * Add an ID.  If the ID is already in the index, the earlier row is
+ * retained.
+ */
+
+
+static void id_index_add(struct id_index *index, int64_t id, Py_ssize_t row)
+{
+	size_t i;
+
+	for(i = id_hash(id) & index->mask; index->rows[i] >= 0; i = (i + 1) & index->mask)
+		if(index->ids[i] == id)
+			return;
+	index->ids[i] = id;
+	index->rows[i] = row;
+}
+
+
+static Py_ssize_t id_index_find(const struct id_index *index, int64_t id)
+{
+	size_t i;
+
+	for(i = id_hash(id) & index->mask; index->rows[i] >= 0; i = (i + 1) & index->mask)
+		if(index->ids[i] == id)
+			return index->rows[i];
+	return -1;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Functions
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * find_rows()
+ */
+
+
+static PyObject *find_rows(PyObject *self, PyObject *args)
+{
+	PyObject *rows, *attribute, *ids;
+	PyObject *attributes = NULL;
+	PyObject *result = NULL;
+	Py_buffer view = {NULL,};
+	struct id_index index = {NULL, NULL, 0};
+	PyTypeObject *rowtype = NULL;
+	Py_ssize_t offset = -1;
+	Py_ssize_t n, m, i;
+
+	if(!PyArg_ParseTuple(args, "OOO", &rows, &attribute, &ids))
+		return NULL;
+
+	rows = PySequence_Fast(rows, "rows must be a sequence");
+	if(!rows)
+		return NULL;
+	attributes = Py_BuildValue("(O)", attribute);
+	if(!attributes)
+		goto done;
+	Py_SETREF(attributes, llwtokenizer_build_attributes(attributes));
+	if(!attributes)
+		goto done;
+	if(PyObject_GetBuffer(ids, &view, PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) < 0)
+		goto done;
+	if(view.itemsize != 8 || (view.format && strcmp(view.format, "q") && strcmp(view.format, "l") && strcmp(view.format, "=q") && strcmp(view.format, "@q"))) {
+		PyErr_SetString(PyExc_TypeError, "ids must be a buffer of 64-bit signed integers in native byte order");
+		goto done;
+	}
+	n = PySequence_Fast_GET_SIZE(rows);
+	m = view.len / 8;
+
+	/*
+	 * index the rows.  rows whose ID is None are not indexed
+	 */
+
+	if(n) {
+		rowtype = Py_TYPE(PySequence_Fast_GET_ITEM(rows, 0));
+		if(llwtokenizer_slot_offsets(rowtype, attributes, &offset) < 0)
+			goto done;
+	}
+	if(id_index_init(&index, n) < 0)
+		goto done;
+	for(i = 0; i < n; i++) {
+		PyObject *row = PySequence_Fast_GET_ITEM(rows, i);
+		PyObject *val = llwtokenizer_slot_get(row, PyTuple_GET_ITEM(attributes, 0), Py_TYPE(row) == rowtype ? offset : -1);
+		int64_t id;
+		if(!val)
+			goto done;
+		if(val == Py_None) {
+			Py_DECREF(val);
+			continue;
+		}
+		id = PyLong_AsLongLong(val);
+		Py_DECREF(val);
+		if(id == -1 && PyErr_Occurred())
+			goto done;
+		id_index_add(&index, id, i);
+	}
+
+	/*
+	 * look up the IDs
+	 */
+
+	result = PyBytes_FromStringAndSize(NULL, m * 8);
+	if(!result)
+		goto done;
+	for(i = 0; i < m; i++) {
+		int64_t id, row;
+		memcpy(&id, (const char *) view.buf + i * 8, 8);
+		row = id_index_find(&index, id);
+		memcpy(PyBytes_AS_STRING(result) + i * 8, &row, 8);
+	}
+
+done:
+	id_index_free(&index);
+	if(view.obj)
+		PyBuffer_Release(&view);
+	Py_XDECREF(attributes);
+	Py_DECREF(rows);
+	return result;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                            Function Information
+ *
+ * ============================================================================
+ */
+
+
+PyMethodDef llwtokenizer_index_methods[] = {
+	{"find_rows", find_rows, METH_VARARGS,
+"find_rows(rows, attribute, ids)\n"\
+"\n"\
+"Find the rows whose integer-valued attribute matches each of a collection of\n"\
+"IDs.  rows is a sequence of row objects, attribute is the name of the\n"\
+"attribute holding the rows' IDs, and ids is an object supporting the buffer\n"\
+"protocol holding 64-bit signed integers in native byte order (for example a\n"\
+"numpy int64 array).  The rows are indexed with a hash table, so the cost is\n"\
+"proportional to len(rows) + len(ids).  The return value is a bytes object\n"\
+"holding one 64-bit integer for each ID, the index in rows of the first row\n"\
+"with that ID, or -1 if there is none.  Rows whose attribute is None are\n"\
+"ignored.\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> import array\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> class Row(object):\n"\
+"...     __slots__ = (\"event_id\",)\n"\
+"...     def __init__(self, event_id):\n"\
+"...             self.event_id = event_id\n"\
+"...\n"\
+">>> rows = [Row(10), Row(20), Row(None), Row(30)]\n"\
+">>> list(array.array(\"q\", tokenizer.find_rows(rows, \"event_id\", array.array(\"q\", [30, 10, 15]))))\n"\
+"[3, 0, -1]"
+	},
+	{NULL,}
+};
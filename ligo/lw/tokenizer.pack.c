@@ -0,0 +1,753 @@
+/*
+ * Copyright (C) 2026  Kipp C. Cannon
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                      tokenizer Column Packing Functions
+ *
+ * ============================================================================
+ */
+
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tokenizer.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                              Internal Helpers
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * Values in a column's mask.  A column with no null or unset entries is
+ * packed with a mask of None.
+ */
+
+
+#define MASK_VALUE 0
+#define MASK_NONE 1
+#define MASK_UNSET 2
+
+
+/*
+ * A growable byte buffer.
+ */
+
+
+struct buffer {
+	char *data;
+	size_t length;
+	size_t allocation;
+};
+
+
+static int buffer_append(struct buffer *buffer, const void *data, size_t n)
+{
+	if(buffer->length + n > buffer->allocation) {
+		size_t allocation = buffer->allocation ? buffer->allocation : 1024;
+		char *new;
+		while(buffer->length + n > allocation)
+			allocation *= 2;
+		new = realloc(buffer->data, allocation);
+		if(!new) {
+			PyErr_NoMemory();
+			return -1;
+		}
+		buffer->data = new;
+		buffer->allocation = allocation;
+	}
+	memcpy(buffer->data + buffer->length, data, n);
+	buffer->length += n;
+	return 0;
+}
+
+
+/*
+ * Retrieve the value of an attribute from a row, recording in *mask
+ * whether the value is None or the attribute is not set.  Returns a new
+ * reference to the value, or a new reference to None if the attribute is
+ * not set, or NULL on error.
+ */
+
+
+static PyObject *get_value(PyObject *row, PyObject *name, Py_ssize_t offset, char *mask)
+{
+	PyObject *val = llwtokenizer_slot_get(row, name, offset);
+
+	if(!val) {
+		if(!PyErr_ExceptionMatches(PyExc_AttributeError))
+			return NULL;
+		PyErr_Clear();
+		*mask = MASK_UNSET;
+		Py_INCREF(Py_None);
+		return Py_None;
+	}
+	*mask = val == Py_None ? MASK_NONE : MASK_VALUE;
+	return val;
+}
+
+
+/*
+ * Pack a column of values as a tuple of Python objects.  This is the
+ * fall-back used for columns containing values that cannot be packed
+ * into a typed buffer.
+ */
+
+
+static PyObject *pack_objects(PyObject **rows, Py_ssize_t n, PyObject *name, PyTypeObject *rowtype, Py_ssize_t offset)
+{
+	PyObject *mask = PyBytes_FromStringAndSize(NULL, n);
+	PyObject *values = PyTuple_New(n);
+	int have_unset = 0;
+	Py_ssize_t i;
+
+	if(!mask || !values)
+		goto error;
+
+	for(i = 0; i < n; i++) {
+		char *m = &PyBytes_AS_STRING(mask)[i];
+		PyObject *val = get_value(rows[i], name, Py_TYPE(rows[i]) == rowtype ? offset : -1, m);
+		if(!val)
+			goto error;
+		have_unset |= *m == MASK_UNSET;
+		PyTuple_SET_ITEM(values, i, val);
+	}
+
+	if(!have_unset) {
+		Py_DECREF(mask);
+		mask = Py_None;
+		Py_INCREF(mask);
+	}
+
+	return Py_BuildValue("(sNNO)", "O", mask, values, Py_None);
+
+error:
+	Py_XDECREF(mask);
+	Py_XDECREF(values);
+	return NULL;
+}
+
+
+/*
+ * Pack a column of values into a typed buffer.  Returns a 4-element tuple
+ * (code, mask, data, blob), or Py_NotImplemented (a new reference) if the
+ * column contains a value whose type does not allow it to be packed
+ * according to code, in which case the calling code should pack the
+ * column as objects instead.
+ */
+
+
+static PyObject *pack_typed(PyObject **rows, Py_ssize_t n, PyObject *name, PyTypeObject *rowtype, Py_ssize_t offset, char code)
+{
+	struct buffer data = {NULL, 0, 0};
+	struct buffer blob = {NULL, 0, 0};
+	char *mask = NULL;
+	int have_mask = 0;
+	PyObject *result = NULL;
+	Py_ssize_t i;
+
+	mask = malloc(n ? n : 1);
+	if(!mask) {
+		PyErr_NoMemory();
+		return NULL;
+	}
+
+	if(code == 'u' || code == 'y') {
+		/* string and blob columns begin with the 0 offset */
+		int64_t zero = 0;
+		if(buffer_append(&data, &zero, sizeof(zero)) < 0)
+			goto done;
+	}
+
+	for(i = 0; i < n; i++) {
+		PyObject *val = get_value(rows[i], name, Py_TYPE(rows[i]) == rowtype ? offset : -1, &mask[i]);
+		int failed = 0;
+
+		if(!val)
+			goto done;
+		have_mask |= mask[i] != MASK_VALUE;
+
+		switch(code) {
+		case 'q': {
+			long long x = 0;
+			if(val != Py_None) {
+				if(!PyLong_CheckExact(val)) {
+					failed = 1;
+					break;
+				}
+				x = PyLong_AsLongLong(val);
+				if(x == -1 && PyErr_Occurred()) {
+					failed = 1;
+					break;
+				}
+			}
+			failed = buffer_append(&data, &(int64_t) {x}, sizeof(int64_t)) < 0 ? -1 : 0;
+			break;
+		}
+
+		case 'Q': {
+			unsigned long long x = 0;
+			if(val != Py_None) {
+				if(!PyLong_CheckExact(val)) {
+					failed = 1;
+					break;
+				}
+				x = PyLong_AsUnsignedLongLong(val);
+				if(x == (unsigned long long) -1 && PyErr_Occurred()) {
+					failed = 1;
+					break;
+				}
+			}
+			failed = buffer_append(&data, &(uint64_t) {x}, sizeof(uint64_t)) < 0 ? -1 : 0;
+			break;
+		}
+
+		case 'd': {
+			double x = 0.;
+			if(val != Py_None) {
+				if(!PyFloat_CheckExact(val)) {
+					failed = 1;
+					break;
+				}
+				x = PyFloat_AS_DOUBLE(val);
+			}
+			failed = buffer_append(&data, &x, sizeof(x)) < 0 ? -1 : 0;
+			break;
+		}
+
+		case 'D': {
+			double x[2] = {0., 0.};
+			if(val != Py_None) {
+				if(!PyComplex_CheckExact(val)) {
+					failed = 1;
+					break;
+				}
+				x[0] = PyComplex_RealAsDouble(val);
+				x[1] = PyComplex_ImagAsDouble(val);
+			}
+			failed = buffer_append(&data, x, sizeof(x)) < 0 ? -1 : 0;
+			break;
+		}
+
+		case 'u':
+			if(val != Py_None) {
+				const char *s;
+				Py_ssize_t len;
+				if(!PyUnicode_CheckExact(val)) {
+					failed = 1;
+					break;
+				}
+				s = PyUnicode_AsUTF8AndSize(val, &len);
+				if(!s) {
+					/* e.g., lone surrogates */
+					failed = 1;
+					break;
+				}
+				if(buffer_append(&blob, s, len) < 0) {
+					failed = -1;
+					break;
+				}
+			}
+			failed = buffer_append(&data, &(int64_t) {blob.length}, sizeof(int64_t)) < 0 ? -1 : 0;
+			break;
+
+		case 'y':
+			if(val != Py_None) {
+				Py_buffer view;
+				if(!PyMemoryView_Check(val) || PyObject_GetBuffer(val, &view, PyBUF_C_CONTIGUOUS) < 0) {
+					failed = 1;
+					break;
+				}
+				failed = buffer_append(&blob, view.buf, view.len) < 0 ? -1 : 0;
+				PyBuffer_Release(&view);
+				if(failed)
+					break;
+			}
+			failed = buffer_append(&data, &(int64_t) {blob.length}, sizeof(int64_t)) < 0 ? -1 : 0;
+			break;
+
+		default:
+			PyErr_Format(PyExc_ValueError, "unrecognized column buffer code '%c'", code);
+			failed = -1;
+			break;
+		}
+		Py_DECREF(val);
+
+		if(failed < 0)
+			goto done;
+		if(failed) {
+			/* clear any conversion error, and report that the
+			 * column must be packed as objects */
+			PyErr_Clear();
+			Py_INCREF(Py_NotImplemented);
+			result = Py_NotImplemented;
+			goto done;
+		}
+	}
+
+	if(code == 'u' || code == 'y')
+		result = Py_BuildValue("(CNy#y#)", code, have_mask ? PyBytes_FromStringAndSize(mask, n) : (Py_INCREF(Py_None), Py_None), data.data ? data.data : "", (Py_ssize_t) data.length, blob.data ? blob.data : "", (Py_ssize_t) blob.length);
+	else
+		result = Py_BuildValue("(CNy#O)", code, have_mask ? PyBytes_FromStringAndSize(mask, n) : (Py_INCREF(Py_None), Py_None), data.data ? data.data : "", (Py_ssize_t) data.length, Py_None);
+
+done:
+	free(mask);
+	free(data.data);
+	free(blob.data);
+	return result;
+}
+
+
+/*
+ * Obtain a read-only view of a buffer, checking that it has the expected
+ * length (if expected >= 0).
+ */
+
+
+static int get_view(PyObject *obj, Py_buffer *view, Py_ssize_t expected, const char *what)
+{
+	if(PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS) < 0)
+		return -1;
+	if(expected >= 0 && view->len != expected) {
+		PyErr_Format(PyExc_ValueError, "%s buffer has wrong length: expected %zd, got %zd", what, expected, view->len);
+		PyBuffer_Release(view);
+		return -1;
+	}
+	return 0;
+}
+
+
+/*
+ * Unpack one column into the rows.
+ */
+
+
+static int unpack_column(PyObject **rows, Py_ssize_t n, PyObject *name, Py_ssize_t offset, PyObject *column)
+{
+	const char *code;
+	PyObject *maskobj, *dataobj, *blobobj;
+	Py_buffer mask = {NULL,}, data = {NULL,}, blob = {NULL,};
+	const char *m = NULL;
+	PyObject *prev = NULL;
+	int64_t prev_start = 0, prev_stop = 0;
+	int result = -1;
+	Py_ssize_t i;
+
+	if(!PyArg_ParseTuple(column, "sOOO", &code, &maskobj, &dataobj, &blobobj))
+		return -1;
+	if(strlen(code) != 1) {
+		PyErr_Format(PyExc_ValueError, "invalid column buffer code '%s'", code);
+		return -1;
+	}
+
+	if(maskobj != Py_None) {
+		if(get_view(maskobj, &mask, n, "mask") < 0)
+			return -1;
+		m = mask.buf;
+	}
+
+	if(*code == 'O') {
+		if(!PyTuple_Check(dataobj) || PyTuple_GET_SIZE(dataobj) != n) {
+			PyErr_SetString(PyExc_ValueError, "object column must be a tuple with one entry per row");
+			goto done;
+		}
+		for(i = 0; i < n; i++)
+			if((!m || m[i] != MASK_UNSET) && llwtokenizer_slot_set(rows[i], name, offset, PyTuple_GET_ITEM(dataobj, i)) < 0)
+				goto done;
+		result = 0;
+		goto done;
+	}
+
+	switch(*code) {
+	case 'q':
+	case 'Q':
+	case 'd':
+		if(get_view(dataobj, &data, n * 8, "data") < 0)
+			goto done;
+		break;
+	case 'D':
+		if(get_view(dataobj, &data, n * 16, "data") < 0)
+			goto done;
+		break;
+	case 'u':
+	case 'y':
+		if(get_view(dataobj, &data, (n + 1) * 8, "offset") < 0 || get_view(blobobj, &blob, -1, "blob") < 0)
+			goto done;
+		break;
+	default:
+		PyErr_Format(PyExc_ValueError, "unrecognized column buffer code '%s'", code);
+		goto done;
+	}
+
+	for(i = 0; i < n; i++) {
+		const char *p = (const char *) data.buf;
+		PyObject *val;
+
+		if(m && m[i] == MASK_UNSET)
+			continue;
+		if(m && m[i] == MASK_NONE) {
+			if(llwtokenizer_slot_set(rows[i], name, offset, Py_None) < 0)
+				goto done;
+			continue;
+		}
+
+		switch(*code) {
+		case 'q': {
+			int64_t x;
+			memcpy(&x, p + i * 8, 8);
+			val = PyLong_FromLongLong(x);
+			break;
+		}
+		case 'Q': {
+			uint64_t x;
+			memcpy(&x, p + i * 8, 8);
+			val = PyLong_FromUnsignedLongLong(x);
+			break;
+		}
+		case 'd': {
+			double x;
+			memcpy(&x, p + i * 8, 8);
+			val = PyFloat_FromDouble(x);
+			break;
+		}
+		case 'D': {
+			double x[2];
+			memcpy(x, p + i * 16, 16);
+			val = PyComplex_FromDoubles(x[0], x[1]);
+			break;
+		}
+		default: {
+			/* 'u' and 'y' */
+			int64_t start, stop;
+			const char *s;
+			memcpy(&start, p + i * 8, 8);
+			memcpy(&stop, p + (i + 1) * 8, 8);
+			if(start < 0 || stop < start || stop > blob.len) {
+				PyErr_SetString(PyExc_ValueError, "corrupt offset buffer");
+				goto done;
+			}
+			s = (const char *) blob.buf + start;
+			if(*code == 'y') {
+				PyObject *bytes = PyBytes_FromStringAndSize(s, stop - start);
+				val = bytes ? PyMemoryView_FromObject(bytes) : NULL;
+				Py_XDECREF(bytes);
+			} else if(prev && stop - start == prev_stop - prev_start && !memcmp((const char *) blob.buf + prev_start, s, stop - start)) {
+				/* repeated string, e.g. instrument names.
+				 * share the object */
+				val = prev;
+				Py_INCREF(val);
+			} else {
+				val = PyUnicode_DecodeUTF8(s, stop - start, NULL);
+				if(val) {
+					Py_XDECREF(prev);
+					prev = val;
+					Py_INCREF(prev);
+					prev_start = start;
+					prev_stop = stop;
+				}
+			}
+			break;
+		}
+		}
+		if(!val)
+			goto done;
+		if(llwtokenizer_slot_set(rows[i], name, offset, val) < 0) {
+			Py_DECREF(val);
+			goto done;
+		}
+		Py_DECREF(val);
+	}
+	result = 0;
+
+done:
+	Py_XDECREF(prev);
+	if(mask.obj)
+		PyBuffer_Release(&mask);
+	if(data.obj)
+		PyBuffer_Release(&data);
+	if(blob.obj)
+		PyBuffer_Release(&blob);
+	return result;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Functions
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * pack_columns()
+ */
+
+
+static PyObject *pack_columns(PyObject *self, PyObject *args)
+{
+	PyObject *rows, *attributes, *codes;
+	PyTypeObject *rowtype = NULL;
+	Py_ssize_t *offsets = NULL;
+	PyObject *result = NULL;
+	Py_ssize_t n, ncols, j;
+
+	if(!PyArg_ParseTuple(args, "OOU", &rows, &attributes, &codes))
+		return NULL;
+
+	rows = PySequence_Fast(rows, "rows must be a sequence");
+	attributes = llwtokenizer_build_attributes(attributes);
+	if(!rows || !attributes)
+		goto done;
+	n = PySequence_Fast_GET_SIZE(rows);
+	ncols = PyTuple_GET_SIZE(attributes);
+	if(PyUnicode_GET_LENGTH(codes) != ncols) {
+		PyErr_SetString(PyExc_ValueError, "len(codes) != len(attributes)");
+		goto done;
+	}
+
+	/*
+	 * slot offsets are resolved for the type of the first row.  rows
+	 * of other types use the generic attribute protocol.
+	 */
+
+	offsets = malloc((ncols ? ncols : 1) * sizeof(*offsets));
+	if(!offsets) {
+		PyErr_NoMemory();
+		goto done;
+	}
+	if(n) {
+		rowtype = Py_TYPE(PySequence_Fast_GET_ITEM(rows, 0));
+		if(llwtokenizer_slot_offsets(rowtype, attributes, offsets) < 0)
+			goto done;
+	}
+
+	result = PyTuple_New(ncols);
+	if(!result)
+		goto done;
+	for(j = 0; j < ncols; j++) {
+		PyObject **items = PySequence_Fast_ITEMS(rows);
+		PyObject *name = PyTuple_GET_ITEM(attributes, j);
+		Py_UCS4 code = PyUnicode_READ_CHAR(codes, j);
+		PyObject *column;
+		if(code == 'O')
+			column = pack_objects(items, n, name, rowtype, n ? offsets[j] : -1);
+		else {
+			column = pack_typed(items, n, name, rowtype, n ? offsets[j] : -1, (char) code);
+			if(column == Py_NotImplemented) {
+				/* a value does not match the code */
+				Py_DECREF(column);
+				column = pack_objects(items, n, name, rowtype, n ? offsets[j] : -1);
+			}
+		}
+		if(!column) {
+			Py_CLEAR(result);
+			goto done;
+		}
+		PyTuple_SET_ITEM(result, j, column);
+	}
+
+done:
+	free(offsets);
+	Py_XDECREF(rows);
+	Py_XDECREF(attributes);
+	return result;
+}
+
+
+/*
+ * unpack_columns()
+ */
+
+
+/*
+ * Return the rows created by unpack_columns() to the garbage collector.
+ * The list's unused slots are NULL.
+ */
+
+
+static void track_rows(PyObject *rows)
+{
+	Py_ssize_t i;
+
+	for(i = 0; i < PyList_GET_SIZE(rows); i++) {
+		PyObject *row = PyList_GET_ITEM(rows, i);
+		if(row && PyObject_IS_GC(row))
+			PyObject_GC_Track(row);
+	}
+}
+
+
+static PyObject *unpack_columns(PyObject *self, PyObject *args)
+{
+	PyObject *rowtype, *attributes, *columns;
+	Py_ssize_t n, ncols, i, j;
+	Py_ssize_t *offsets = NULL;
+	PyObject *rows = NULL;
+
+	if(!PyArg_ParseTuple(args, "OOnO", &rowtype, &attributes, &n, &columns))
+		return NULL;
+	if(!PyType_Check(rowtype)) {
+		PyErr_SetObject(PyExc_TypeError, rowtype);
+		return NULL;
+	}
+	if(n < 0) {
+		PyErr_SetString(PyExc_ValueError, "negative row count");
+		return NULL;
+	}
+
+	attributes = llwtokenizer_build_attributes(attributes);
+	columns = PySequence_Fast(columns, "columns must be a sequence");
+	if(!attributes || !columns)
+		goto error;
+	ncols = PyTuple_GET_SIZE(attributes);
+	if(PySequence_Fast_GET_SIZE(columns) != ncols) {
+		PyErr_SetString(PyExc_ValueError, "len(columns) != len(attributes)");
+		goto error;
+	}
+
+	offsets = malloc((ncols ? ncols : 1) * sizeof(*offsets));
+	if(!offsets) {
+		PyErr_NoMemory();
+		goto error;
+	}
+	if(llwtokenizer_slot_offsets((PyTypeObject *) rowtype, attributes, offsets) < 0)
+		goto error;
+
+	/*
+	 * create the rows without calling their __init__() methods, as
+	 * RowBuilder does.  the new rows are hidden from the garbage
+	 * collector until their attributes have been assigned:  nothing
+	 * can refer to them but the list, so they cannot be part of a
+	 * reference cycle, and otherwise each collection triggered by
+	 * their allocation would scan all of them again.  gc.disable()
+	 * would do the same, but for every thread in the process
+	 */
+
+	rows = PyList_New(n);
+	if(!rows)
+		goto error;
+	for(i = 0; i < n; i++) {
+		PyObject *row = PyType_GenericNew((PyTypeObject *) rowtype, NULL, NULL);
+		if(!row)
+			goto error;
+		if(PyObject_IS_GC(row))
+			PyObject_GC_UnTrack(row);
+		PyList_SET_ITEM(rows, i, row);
+	}
+
+	for(j = 0; j < ncols; j++)
+		if(unpack_column(PySequence_Fast_ITEMS(rows), n, PyTuple_GET_ITEM(attributes, j), offsets[j], PySequence_Fast_GET_ITEM(columns, j)) < 0)
+			goto error;
+
+	track_rows(rows);
+	free(offsets);
+	Py_DECREF(attributes);
+	Py_DECREF(columns);
+	return rows;
+
+error:
+	if(rows)
+		track_rows(rows);
+	free(offsets);
+	Py_XDECREF(attributes);
+	Py_XDECREF(columns);
+	Py_XDECREF(rows);
+	return NULL;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                            Function Information
+ *
+ * ============================================================================
+ */
+
+
+PyMethodDef llwtokenizer_pack_methods[] = {
+	{"pack_columns", pack_columns, METH_VARARGS,
+"pack_columns(rows, attributes, codes)\n"\
+"\n"\
+"Pack the values of the attributes of a sequence of row objects into typed\n"\
+"buffers, one column at a time.  attributes is a sequence of attribute names,\n"\
+"and codes is a string containing one character for each attribute giving\n"\
+"the buffer type into which that attribute's values are to be packed:  'q' =\n"\
+"64-bit signed integers, 'Q' = 64-bit unsigned integers, 'd' = doubles, 'D' =\n"\
+"pairs of doubles holding the real and imaginary parts of complex numbers,\n"\
+"'u' = UTF-8 encoded strings, 'y' = blobs, 'O' = Python objects.  See\n"\
+"ligo.lw.types.ToBufferCode for the codes used for each LIGO Light Weight\n"\
+"data type.  Buffers use the native byte order.\n"\
+"\n"\
+"The return value is a tuple containing one 4-element tuple for each column,\n"\
+"(code, mask, data, blob).  mask is None if every row had a value for the\n"\
+"attribute that was not None, otherwise it is a bytes object containing one\n"\
+"byte for each row, 0 if the row's value is in the data buffer, 1 if the\n"\
+"row's value is None, and 2 if the row does not have the attribute set.  For\n"\
+"numeric columns data is a bytes object containing the values and blob is\n"\
+"None.  For string and blob columns, data is a bytes object containing\n"\
+"len(rows) + 1 64-bit integer offsets into blob, which is a bytes object\n"\
+"holding the concatenated values.  Any column containing a value whose type\n"\
+"does not match its code (for example, a bool in an integer column) is\n"\
+"packed with code 'O', and data is then a tuple of the values.  The result\n"\
+"can be converted back into rows with unpack_columns().\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> class Row(object):\n"\
+"...     __slots__ = (\"time\", \"snr\", \"ifo\")\n"\
+"...\n"\
+">>> rows = [Row(), Row()]\n"\
+">>> rows[0].time, rows[0].snr, rows[0].ifo = 10, 6.8, \"H1\"\n"\
+">>> rows[1].time, rows[1].snr, rows[1].ifo = 15, None, \"L1\"\n"\
+">>> columns = tokenizer.pack_columns(rows, (\"time\", \"snr\", \"ifo\"), \"qdu\")\n"\
+">>> columns[1][1]\n"\
+"b'\\x00\\x01'\n"\
+">>> columns[2][3]\n"\
+"b'H1L1'\n"\
+">>> rows = tokenizer.unpack_columns(Row, (\"time\", \"snr\", \"ifo\"), 2, columns)\n"\
+">>> [(row.time, row.snr, row.ifo) for row in rows]\n"\
+"[(10, 6.8, 'H1'), (15, None, 'L1')]"
+	},
+	{"unpack_columns", unpack_columns, METH_VARARGS,
+"unpack_columns(rowtype, attributes, n, columns)\n"\
+"\n"\
+"Construct a list of n new instances of rowtype, and populate their\n"\
+"attributes from the packed columns.  columns is a sequence of column tuples\n"\
+"as returned by pack_columns(), one for each attribute name in attributes.\n"\
+"The data and blob buffers can be any objects supporting the buffer\n"\
+"protocol, for example memoryviews of a memory-mapped file.  As with\n"\
+"RowBuilder, rowtype's __init__() method is not called.  Attributes recorded\n"\
+"as unset are left unset.  See pack_columns() for more information."
+	},
+	{NULL,}
+};
@@ -0,0 +1,810 @@
+/*
+ * Copyright (C) 2026  Kipp C. Cannon
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                      tokenizer Row Property Descriptors
+ *
+ * ============================================================================
+ */
+
+
+#include <Python.h>
+#include <structmember.h>
+#include <tokenizer.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                              Internal Helpers
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * Slot offsets of a descriptor's attributes, computed for the most
+ * recently seen row class.  The rows passed to a descriptor are almost
+ * always all of one class, so the offsets are recomputed only when the
+ * class changes.
+ *
+ * The descriptor is held by the class' dictionary, so a reference to the
+ * class would form a cycle the garbage collector cannot see.  Instead
+ * the cache holds a borrowed pointer together with the class' version
+ * tag.  Version tags are never re-used, so a class allocated at the
+ * address of one that has been deallocated does not match.  Classes
+ * without a valid version tag are not cached.
+ */
+
+
+#define MAX_ATTRIBUTES 2
+
+
+struct slot_cache {
+	PyTypeObject *type;
+	unsigned int version_tag;
+	Py_ssize_t offsets[MAX_ATTRIBUTES];
+};
+
+
+static unsigned int valid_version_tag(PyTypeObject *type)
+{
+#ifdef Py_TPFLAGS_VALID_VERSION_TAG
+	if(!PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG))
+		return 0;
+#endif
+	/* 0 is not a valid version tag */
+	return type->tp_version_tag;
+}
+
+
+static void slot_cache_clear(struct slot_cache *cache)
+{
+	cache->type = NULL;
+	cache->version_tag = 0;
+}
+
+
+static int slot_cache_update(struct slot_cache *cache, PyObject *obj, PyObject *attributes)
+{
+	PyTypeObject *type = Py_TYPE(obj);
+	unsigned int version_tag = valid_version_tag(type);
+
+	if(version_tag && type == cache->type && version_tag == cache->version_tag)
+		return 0;
+
+	slot_cache_clear(cache);
+	if(llwtokenizer_slot_offsets(type, attributes, cache->offsets) < 0)
+		return -1;
+	if(version_tag) {
+		cache->type = type;
+		cache->version_tag = version_tag;
+	}
+
+	return 0;
+}
+
+
+/*
+ * Replace the object held in a structure field, releasing the old one.
+ * Does not steal a reference to val.
+ */
+
+
+static void replace(PyObject **field, PyObject *val)
+{
+	PyObject *old = *field;
+	Py_INCREF(val);
+	*field = val;
+	Py_XDECREF(old);
+}
+
+
+/*
+ * Return 1 if obj == value, 0 if not, -1 on error.
+ */
+
+
+static int int_equals(PyObject *obj, long long value)
+{
+	PyObject *pyvalue;
+	int result;
+
+	if(PyLong_CheckExact(obj)) {
+		int overflow;
+		long long x = PyLong_AsLongLongAndOverflow(obj, &overflow);
+		if(x == -1 && PyErr_Occurred())
+			return -1;
+		return !overflow && x == value;
+	}
+
+	pyvalue = PyLong_FromLongLong(value);
+	if(!pyvalue)
+		return -1;
+	result = PyObject_RichCompareBool(obj, pyvalue, Py_EQ);
+	Py_DECREF(pyvalue);
+
+	return result;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                           GPS Time Property Type
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * The denormalized GPS times reserved for +/- infinity.
+ */
+
+
+#define POSINF_S 0x7FFFFFFFLL
+#define NEGINF_S 0xFFFFFFFFLL
+#define INF_NS 0xFFFFFFFFLL
+
+
+/*
+ * Structure
+ */
+
+
+typedef struct {
+	PyObject_HEAD
+	/* names of the seconds and nanoseconds attributes */
+	PyObject *s_name;
+	PyObject *ns_name;
+	/* (s_name, ns_name) */
+	PyObject *attributes;
+	/* class to instantiate for GPS times */
+	PyObject *gpstype;
+	/* objects reported for +/- infinity */
+	PyObject *posinf;
+	PyObject *neginf;
+	struct slot_cache cache;
+} ligolw_GPSProperty;
+
+
+/*
+ * __del__() method
+ */
+
+
+static void gps__del__(PyObject *self)
+{
+	ligolw_GPSProperty *prop = (ligolw_GPSProperty *) self;
+
+	Py_XDECREF(prop->s_name);
+	Py_XDECREF(prop->ns_name);
+	Py_XDECREF(prop->attributes);
+	Py_XDECREF(prop->gpstype);
+	Py_XDECREF(prop->posinf);
+	Py_XDECREF(prop->neginf);
+
+	self->ob_type->tp_free(self);
+}
+
+
+/*
+ * __init__() method
+ */
+
+
+static int gps__init__(PyObject *self, PyObject *args, PyObject *kwds)
+{
+	ligolw_GPSProperty *prop = (ligolw_GPSProperty *) self;
+	PyObject *s_name, *ns_name, *gpstype, *posinf, *neginf;
+	PyObject *attributes;
+
+	if(!PyArg_ParseTuple(args, "UUOOO", &s_name, &ns_name, &gpstype, &posinf, &neginf))
+		return -1;
+
+	attributes = PyTuple_Pack(2, s_name, ns_name);
+	if(!attributes)
+		return -1;
+
+	replace(&prop->s_name, s_name);
+	replace(&prop->ns_name, ns_name);
+	replace(&prop->attributes, attributes);
+	Py_DECREF(attributes);
+	replace(&prop->gpstype, gpstype);
+	replace(&prop->posinf, posinf);
+	replace(&prop->neginf, neginf);
+	slot_cache_clear(&prop->cache);
+
+	return 0;
+}
+
+
+/*
+ * __get__() method
+ */
+
+
+static PyObject *gps_decode(ligolw_GPSProperty *prop, PyObject *s, PyObject *ns)
+{
+	int result;
+
+	if(s == Py_None && ns == Py_None) {
+		Py_INCREF(Py_None);
+		return Py_None;
+	}
+
+	result = int_equals(ns, INF_NS);
+	if(result < 0)
+		return NULL;
+	if(result) {
+		result = int_equals(s, POSINF_S);
+		if(result < 0)
+			return NULL;
+		if(result) {
+			Py_INCREF(prop->posinf);
+			return prop->posinf;
+		}
+		result = int_equals(s, NEGINF_S);
+		if(result < 0)
+			return NULL;
+		if(result) {
+			Py_INCREF(prop->neginf);
+			return prop->neginf;
+		}
+		PyErr_Format(PyExc_ValueError, "unrecognized denormalized number LIGOTimeGPS(%S,%S)", s, ns);
+		return NULL;
+	}
+
+	return PyObject_CallFunctionObjArgs(prop->gpstype, s, ns, NULL);
+}
+
+
+static PyObject *gps__get__(PyObject *self, PyObject *obj, PyObject *type)
+{
+	ligolw_GPSProperty *prop = (ligolw_GPSProperty *) self;
+	PyObject *s, *ns;
+	PyObject *result;
+
+	if(!obj || obj == Py_None) {
+		Py_INCREF(self);
+		return self;
+	}
+
+	if(!prop->attributes) {
+		PyErr_SetString(PyExc_RuntimeError, "descriptor not initialized");
+		return NULL;
+	}
+	if(slot_cache_update(&prop->cache, obj, prop->attributes) < 0)
+		return NULL;
+
+	s = llwtokenizer_slot_get(obj, prop->s_name, prop->cache.offsets[0]);
+	if(!s)
+		return NULL;
+	ns = llwtokenizer_slot_get(obj, prop->ns_name, prop->cache.offsets[1]);
+	if(!ns) {
+		Py_DECREF(s);
+		return NULL;
+	}
+
+	result = gps_decode(prop, s, ns);
+
+	Py_DECREF(s);
+	Py_DECREF(ns);
+
+	return result;
+}
+
+
+/*
+ * Type information
+ */
+
+
+static struct PyMemberDef gps_members[] = {
+	{"s_name", T_OBJECT, offsetof(ligolw_GPSProperty, s_name), READONLY, "name of the integer seconds attribute"},
+	{"ns_name", T_OBJECT, offsetof(ligolw_GPSProperty, ns_name), READONLY, "name of the integer nanoseconds attribute"},
+	{NULL,}
+};
+
+
+PyTypeObject ligolw_GPSProperty_Type = {
+	PyObject_HEAD_INIT((long int) NULL)
+	.tp_basicsize = sizeof(ligolw_GPSProperty),
+	.tp_dealloc = gps__del__,
+	.tp_descr_get = gps__get__,
+	.tp_doc =
+"Descriptor exposing a pair of integer seconds and nanoseconds attributes of\n"\
+"a row object as a GPS time.  Initialized with the names of the two\n"\
+"attributes, the class to instantiate for GPS times, and the objects to\n"\
+"report for the denormalized encodings of +inf and -inf.  Only reading is\n"\
+"implemented, subclasses must provide __set__().\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> class Row(object):\n"\
+"...     __slots__ = (\"s\", \"ns\")\n"\
+"...     t = tokenizer.GPSProperty(\"s\", \"ns\", divmod, \"+inf\", \"-inf\")\n"\
+"...\n"\
+">>> row = Row()\n"\
+">>> row.s, row.ns = 17, 5\n"\
+">>> row.t\n"\
+"(3, 2)\n"\
+">>> row.s, row.ns = 0x7FFFFFFF, 0xFFFFFFFF\n"\
+">>> row.t\n"\
+"'+inf'\n"\
+">>> row.s, row.ns = None, None\n"\
+">>> print(row.t)\n"\
+"None\n"\
+"\n"\
+"The descriptor does not keep the class alive:\n"\
+"\n"\
+">>> import gc, weakref\n"\
+">>> ref = weakref.ref(Row)\n"\
+">>> del Row, row\n"\
+">>> n = gc.collect()\n"\
+">>> print(ref())\n"\
+"None",
+	.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+	.tp_init = gps__init__,
+	.tp_members = gps_members,
+	.tp_name = MODULE_NAME ".GPSProperty",
+	.tp_new = PyType_GenericNew,
+};
+
+
+/*
+ * ============================================================================
+ *
+ *                           Segment Property Type
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * Structure
+ */
+
+
+typedef struct {
+	PyObject_HEAD
+	/* names of the start and stop attributes */
+	PyObject *start;
+	PyObject *stop;
+	/* class to instantiate for segments */
+	PyObject *segtype;
+} ligolw_SegmentProperty;
+
+
+/*
+ * __del__() method
+ */
+
+
+static void segment__del__(PyObject *self)
+{
+	ligolw_SegmentProperty *prop = (ligolw_SegmentProperty *) self;
+
+	Py_XDECREF(prop->start);
+	Py_XDECREF(prop->stop);
+	Py_XDECREF(prop->segtype);
+
+	self->ob_type->tp_free(self);
+}
+
+
+/*
+ * __init__() method
+ */
+
+
+static int segment__init__(PyObject *self, PyObject *args, PyObject *kwds)
+{
+	ligolw_SegmentProperty *prop = (ligolw_SegmentProperty *) self;
+	PyObject *start, *stop, *segtype;
+
+	if(!PyArg_ParseTuple(args, "UUO", &start, &stop, &segtype))
+		return -1;
+
+	replace(&prop->start, start);
+	replace(&prop->stop, stop);
+	replace(&prop->segtype, segtype);
+
+	return 0;
+}
+
+
+/*
+ * __get__() method
+ */
+
+
+static PyObject *segment__get__(PyObject *self, PyObject *obj, PyObject *type)
+{
+	ligolw_SegmentProperty *prop = (ligolw_SegmentProperty *) self;
+	PyObject *start, *stop;
+	PyObject *result;
+
+	if(!obj || obj == Py_None) {
+		Py_INCREF(self);
+		return self;
+	}
+
+	if(!prop->segtype) {
+		PyErr_SetString(PyExc_RuntimeError, "descriptor not initialized");
+		return NULL;
+	}
+
+	/*
+	 * start and stop are normally GPSProperty descriptors, not slots,
+	 * so generic attribute access is the fast path
+	 */
+
+	start = PyObject_GetAttr(obj, prop->start);
+	if(!start)
+		return NULL;
+	stop = PyObject_GetAttr(obj, prop->stop);
+	if(!stop) {
+		Py_DECREF(start);
+		return NULL;
+	}
+
+	if(start == Py_None && stop == Py_None) {
+		Py_INCREF(Py_None);
+		result = Py_None;
+	} else
+		result = PyObject_CallFunctionObjArgs(prop->segtype, start, stop, NULL);
+
+	Py_DECREF(start);
+	Py_DECREF(stop);
+
+	return result;
+}
+
+
+/*
+ * Type information
+ */
+
+
+static struct PyMemberDef segment_members[] = {
+	{"start", T_OBJECT, offsetof(ligolw_SegmentProperty, start), READONLY, "name of the start attribute"},
+	{"stop", T_OBJECT, offsetof(ligolw_SegmentProperty, stop), READONLY, "name of the stop attribute"},
+	{NULL,}
+};
+
+
+PyTypeObject ligolw_SegmentProperty_Type = {
+	PyObject_HEAD_INIT((long int) NULL)
+	.tp_basicsize = sizeof(ligolw_SegmentProperty),
+	.tp_dealloc = segment__del__,
+	.tp_descr_get = segment__get__,
+	.tp_doc =
+"Descriptor exposing a pair of attributes of a row object as a segment.\n"\
+"Initialized with the names of the start and stop attributes and the class\n"\
+"to instantiate for segments.  If both attributes are None the value is\n"\
+"None.  Only reading is implemented, subclasses must provide __set__().\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> class Row(object):\n"\
+"...     __slots__ = (\"a\", \"b\")\n"\
+"...     seg = tokenizer.SegmentProperty(\"a\", \"b\", lambda a, b: (a, b))\n"\
+"...\n"\
+">>> row = Row()\n"\
+">>> row.a, row.b = 1, 2\n"\
+">>> row.seg\n"\
+"(1, 2)",
+	.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+	.tp_init = segment__init__,
+	.tp_members = segment_members,
+	.tp_name = MODULE_NAME ".SegmentProperty",
+	.tp_new = PyType_GenericNew,
+};
+
+
+/*
+ * ============================================================================
+ *
+ *                         Instruments Property Type
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * Parsed instrument sets, indexed by the strings they were parsed from.
+ * Documents contain only a handful of distinct instrument strings, so
+ * parsing each one once removes nearly all of the cost of decoding them.
+ * The cache is discarded if it grows too large.
+ */
+
+
+#define INSTRUMENTS_CACHE_SIZE 4096
+
+
+static PyObject *instruments_cache = NULL;
+
+
+/*
+ * Parse a ","-delimited instrument string into a frozenset.  Returns a
+ * new reference, or NULL on failure.
+ */
+
+
+static PyObject *parse_frozen(PyObject *instruments)
+{
+	int cacheable = PyUnicode_CheckExact(instruments);
+	PyObject *result;
+	PyObject *names;
+	Py_ssize_t i, n;
+
+	if(cacheable) {
+		if(!instruments_cache) {
+			instruments_cache = PyDict_New();
+			if(!instruments_cache)
+				return NULL;
+		}
+		result = PyDict_GetItemWithError(instruments_cache, instruments);
+		if(result) {
+			Py_INCREF(result);
+			return result;
+		}
+		if(PyErr_Occurred())
+			return NULL;
+	}
+
+	names = PyObject_CallMethod(instruments, "split", "s", ",");
+	if(!names)
+		return NULL;
+	if(!PyList_Check(names)) {
+		Py_SETREF(names, PySequence_List(names));
+		if(!names)
+			return NULL;
+	}
+	result = PyFrozenSet_New(NULL);
+	if(!result) {
+		Py_DECREF(names);
+		return NULL;
+	}
+	n = PyList_GET_SIZE(names);
+	for(i = 0; i < n; i++) {
+		PyObject *name = PyObject_CallMethod(PyList_GET_ITEM(names, i), "strip", NULL);
+		if(!name)
+			goto error;
+		/* discard "" */
+		if(!(PyUnicode_Check(name) && !PyUnicode_GET_LENGTH(name)) && PySet_Add(result, name) < 0) {
+			Py_DECREF(name);
+			goto error;
+		}
+		Py_DECREF(name);
+	}
+	Py_DECREF(names);
+
+	if(cacheable) {
+		if(PyDict_GET_SIZE(instruments_cache) >= INSTRUMENTS_CACHE_SIZE)
+			PyDict_Clear(instruments_cache);
+		if(PyDict_SetItem(instruments_cache, instruments, result) < 0) {
+			Py_DECREF(result);
+			return NULL;
+		}
+	}
+
+	return result;
+
+error:
+	Py_DECREF(names);
+	Py_DECREF(result);
+	return NULL;
+}
+
+
+/*
+ * Parse an instrument string into a new set.  None is returned as None.
+ */
+
+
+static PyObject *parse_instruments(PyObject *instruments)
+{
+	PyObject *frozen;
+	PyObject *result;
+
+	if(instruments == Py_None) {
+		Py_INCREF(Py_None);
+		return Py_None;
+	}
+
+	frozen = parse_frozen(instruments);
+	if(!frozen)
+		return NULL;
+	result = PySet_New(frozen);
+	Py_DECREF(frozen);
+
+	return result;
+}
+
+
+/*
+ * Structure
+ */
+
+
+typedef struct {
+	PyObject_HEAD
+	/* name of the instruments attribute */
+	PyObject *name;
+	/* (name,) */
+	PyObject *attributes;
+	struct slot_cache cache;
+} ligolw_InstrumentsProperty;
+
+
+/*
+ * __del__() method
+ */
+
+
+static void instruments__del__(PyObject *self)
+{
+	ligolw_InstrumentsProperty *prop = (ligolw_InstrumentsProperty *) self;
+
+	Py_XDECREF(prop->name);
+	Py_XDECREF(prop->attributes);
+
+	self->ob_type->tp_free(self);
+}
+
+
+/*
+ * __init__() method
+ */
+
+
+static int instruments__init__(PyObject *self, PyObject *args, PyObject *kwds)
+{
+	ligolw_InstrumentsProperty *prop = (ligolw_InstrumentsProperty *) self;
+	PyObject *name;
+	PyObject *attributes;
+
+	if(!PyArg_ParseTuple(args, "U", &name))
+		return -1;
+
+	attributes = PyTuple_Pack(1, name);
+	if(!attributes)
+		return -1;
+
+	replace(&prop->name, name);
+	replace(&prop->attributes, attributes);
+	Py_DECREF(attributes);
+	slot_cache_clear(&prop->cache);
+
+	return 0;
+}
+
+
+/*
+ * __get__() method
+ */
+
+
+static PyObject *instruments__get__(PyObject *self, PyObject *obj, PyObject *type)
+{
+	ligolw_InstrumentsProperty *prop = (ligolw_InstrumentsProperty *) self;
+	PyObject *instruments;
+	PyObject *result;
+
+	if(!obj || obj == Py_None) {
+		Py_INCREF(self);
+		return self;
+	}
+
+	if(!prop->attributes) {
+		PyErr_SetString(PyExc_RuntimeError, "descriptor not initialized");
+		return NULL;
+	}
+	if(slot_cache_update(&prop->cache, obj, prop->attributes) < 0)
+		return NULL;
+
+	instruments = llwtokenizer_slot_get(obj, prop->name, prop->cache.offsets[0]);
+	if(!instruments)
+		return NULL;
+	result = parse_instruments(instruments);
+	Py_DECREF(instruments);
+
+	return result;
+}
+
+
+/*
+ * Type information
+ */
+
+
+static struct PyMemberDef instruments_members[] = {
+	{"name", T_OBJECT, offsetof(ligolw_InstrumentsProperty, name), READONLY, "name of the instruments attribute"},
+	{NULL,}
+};
+
+
+PyTypeObject ligolw_InstrumentsProperty_Type = {
+	PyObject_HEAD_INIT((long int) NULL)
+	.tp_basicsize = sizeof(ligolw_InstrumentsProperty),
+	.tp_dealloc = instruments__del__,
+	.tp_descr_get = instruments__get__,
+	.tp_doc =
+"Descriptor exposing a \",\"-delimited instrument string attribute of a row\n"\
+"object as a set of instrument names.  Initialized with the name of the\n"\
+"attribute.  See parse_instruments() for the decoding rules.  Only reading\n"\
+"is implemented, subclasses must provide __set__().\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> class Row(object):\n"\
+"...     __slots__ = (\"ifos\",)\n"\
+"...     instruments = tokenizer.InstrumentsProperty(\"ifos\")\n"\
+"...\n"\
+">>> row = Row()\n"\
+">>> row.ifos = \"L1,H1\"\n"\
+">>> sorted(row.instruments)\n"\
+"['H1', 'L1']",
+	.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+	.tp_init = instruments__init__,
+	.tp_members = instruments_members,
+	.tp_name = MODULE_NAME ".InstrumentsProperty",
+	.tp_new = PyType_GenericNew,
+};
+
+
+/*
+ * ============================================================================
+ *
+ *                            Function Registration
+ *
+ * ============================================================================
+ */
+
+
+static PyObject *parse_instruments_function(PyObject *self, PyObject *instruments)
+{
+	return parse_instruments(instruments);
+}
+
+
+PyMethodDef llwtokenizer_properties_methods[] = {
+	{"parse_instruments", parse_instruments_function, METH_O,
+"Parse a \",\"-delimited instrument string into a set of instrument names.\n"\
+"If the input is None the output is None.  Otherwise the input is split on\n"\
+"\",\", the resulting strings stripped of leading and trailing whitespace,\n"\
+"and the non-zero length strings that remain are returned as a new set.\n"\
+"Parsed strings are cached, so decoding the same string repeatedly is\n"\
+"cheap.\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> sorted(tokenizer.parse_instruments(\" L1, H1,,\"))\n"\
+"['H1', 'L1']"
+	},
+	{NULL,}
+};
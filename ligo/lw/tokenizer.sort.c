@@ -0,0 +1,595 @@
+/*
+ * Copyright (C) 2026  Kipp C. Cannon
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                        tokenizer Row Sorting Functions
+ *
+ * ============================================================================
+ */
+
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tokenizer.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                              Internal Helpers
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * Rows are sorted with a least-significant-digit radix sort.  The values
+ * of each key are converted to unsigned 64-bit integers whose order is
+ * the order of the values:  integers that fit in 64 bits and floats are
+ * encoded directly, other objects are replaced by their rank among the
+ * column's distinct values (so only the distinct values are compared in
+ * Python).  GPS times stored as (seconds, nanoseconds) column pairs are
+ * two integer keys, with the encodings of +/- infinity used by
+ * ligo.lw.lsctables.gpsproperty decoded.  None is handled with an
+ * additional one-bit key.  Starting with the least significant key, the
+ * rows are stably re-ordered by each key in turn, 8 bits at a time.
+ */
+
+
+struct sort_key {
+	/* encoded values, in the original row order */
+	uint64_t *value;
+	/* 1 for each row whose value is None, or NULL if there are none */
+	char *null;
+};
+
+
+static void sort_key_free(struct sort_key *key)
+{
+	free(key->value);
+	free(key->null);
+	key->value = NULL;
+	key->null = NULL;
+}
+
+
+/*
+ * Retrieve the values of an attribute from the rows.  On success returns
+ * an array of new references, otherwise NULL.
+ */
+
+
+static PyObject **get_values(PyObject **rows, Py_ssize_t n, PyObject *name, PyTypeObject *rowtype, Py_ssize_t offset)
+{
+	PyObject **values = calloc(n ? n : 1, sizeof(*values));
+	Py_ssize_t i;
+
+	if(!values) {
+		PyErr_NoMemory();
+		return NULL;
+	}
+	for(i = 0; i < n; i++) {
+		values[i] = llwtokenizer_slot_get(rows[i], name, Py_TYPE(rows[i]) == rowtype ? offset : -1);
+		if(!values[i]) {
+			while(i--)
+				Py_DECREF(values[i]);
+			free(values);
+			return NULL;
+		}
+	}
+	return values;
+}
+
+
+static void free_values(PyObject **values, Py_ssize_t n)
+{
+	Py_ssize_t i;
+	for(i = 0; i < n; i++)
+		Py_DECREF(values[i]);
+	free(values);
+}
+
+
+/*
+ * Order-preserving encodings.
+ */
+
+
+static uint64_t encode_int64(int64_t x)
+{
+	return (uint64_t) x ^ ((uint64_t) 1 << 63);
+}
+
+
+static uint64_t encode_double(double x)
+{
+	uint64_t bits;
+	if(x == 0.)
+		/* -0 == +0 */
+		x = 0.;
+	memcpy(&bits, &x, sizeof(bits));
+	return bits & ((uint64_t) 1 << 63) ? ~bits : bits | ((uint64_t) 1 << 63);
+}
+
+
+/*
+ * Allocate the arrays for a key, and record the rows whose values are
+ * None.
+ */
+
+
+static int key_alloc(struct sort_key *key, PyObject **values, Py_ssize_t n)
+{
+	Py_ssize_t i;
+
+	key->value = malloc((n ? n : 1) * sizeof(*key->value));
+	if(!key->value) {
+		PyErr_NoMemory();
+		return -1;
+	}
+	for(i = 0; i < n; i++)
+		if(values[i] == Py_None)
+			break;
+	if(i < n) {
+		key->null = malloc(n);
+		if(!key->null) {
+			PyErr_NoMemory();
+			return -1;
+		}
+		for(i = 0; i < n; i++)
+			key->null[i] = values[i] == Py_None;
+	}
+	return 0;
+}
+
+
+/*
+ * Replace objects by their ranks among the distinct values.
+ */
+
+
+static int rank_key(struct sort_key *key, PyObject **values, Py_ssize_t n)
+{
+	PyObject *ranks = PyDict_New();
+	PyObject *distinct = NULL;
+	Py_ssize_t i;
+	int result = -1;
+
+	if(!ranks)
+		return -1;
+	for(i = 0; i < n; i++)
+		if(values[i] != Py_None && PyDict_SetItem(ranks, values[i], Py_None) < 0)
+			goto done;
+	distinct = PyDict_Keys(ranks);
+	if(!distinct || PyList_Sort(distinct) < 0)
+		goto done;
+	for(i = 0; i < PyList_GET_SIZE(distinct); i++) {
+		PyObject *rank = PyLong_FromSsize_t(i);
+		if(!rank || PyDict_SetItem(ranks, PyList_GET_ITEM(distinct, i), rank) < 0) {
+			Py_XDECREF(rank);
+			goto done;
+		}
+		Py_DECREF(rank);
+	}
+	for(i = 0; i < n; i++) {
+		PyObject *rank;
+		if(values[i] == Py_None) {
+			key->value[i] = 0;
+			continue;
+		}
+		rank = PyDict_GetItemWithError(ranks, values[i]);
+		if(!rank) {
+			if(!PyErr_Occurred())
+				PyErr_SetString(PyExc_ValueError, "values changed during sort");
+			goto done;
+		}
+		key->value[i] = PyLong_AsUnsignedLongLong(rank);
+	}
+	result = 0;
+
+done:
+	Py_DECREF(ranks);
+	Py_XDECREF(distinct);
+	return result;
+}
+
+
+/*
+ * Construct the sort key for a single column.
+ */
+
+
+static int column_key(struct sort_key *key, PyObject **rows, Py_ssize_t n, PyObject *name, PyTypeObject *rowtype, Py_ssize_t offset)
+{
+	PyObject **values = get_values(rows, n, name, rowtype, offset);
+	int all_int = 1, all_float = 1;
+	int result = -1;
+	Py_ssize_t i;
+
+	if(!values)
+		return -1;
+	if(key_alloc(key, values, n) < 0)
+		goto done;
+
+	for(i = 0; i < n && (all_int || all_float); i++) {
+		if(values[i] == Py_None)
+			continue;
+		if(all_int && PyLong_CheckExact(values[i])) {
+			int overflow;
+			key->value[i] = encode_int64(PyLong_AsLongLongAndOverflow(values[i], &overflow));
+			all_int = !overflow;
+		} else
+			all_int = 0;
+		if(all_float && PyFloat_CheckExact(values[i]))
+			key->value[i] = encode_double(PyFloat_AS_DOUBLE(values[i]));
+		else
+			all_float = 0;
+	}
+
+	if(all_int || all_float) {
+		for(i = 0; i < n; i++)
+			if(values[i] == Py_None)
+				key->value[i] = 0;
+		result = 0;
+	} else
+		result = rank_key(key, values, n);
+
+done:
+	free_values(values, n);
+	return result;
+}
+
+
+/*
+ * Construct the sort keys for a GPS time stored in a pair of integer
+ * columns.  The None indicator is recorded in the seconds key.
+ */
+
+
+static int gps_key(struct sort_key *s_key, struct sort_key *ns_key, PyObject **rows, Py_ssize_t n, PyObject *s_name, PyObject *ns_name, PyTypeObject *rowtype, Py_ssize_t s_offset, Py_ssize_t ns_offset)
+{
+	PyObject **s = get_values(rows, n, s_name, rowtype, s_offset);
+	PyObject **ns = s ? get_values(rows, n, ns_name, rowtype, ns_offset) : NULL;
+	int result = -1;
+	Py_ssize_t i;
+
+	if(!ns)
+		goto done;
+	if(key_alloc(s_key, s, n) < 0 || key_alloc(ns_key, s, n) < 0)
+		goto done;
+	/* only one of them needs it */
+	free(ns_key->null);
+	ns_key->null = NULL;
+
+	for(i = 0; i < n; i++) {
+		int64_t seconds, nanoseconds;
+		if(s[i] == Py_None && ns[i] == Py_None) {
+			s_key->value[i] = ns_key->value[i] = 0;
+			continue;
+		}
+		seconds = PyLong_AsLongLong(s[i]);
+		nanoseconds = PyLong_AsLongLong(ns[i]);
+		if(PyErr_Occurred())
+			goto done;
+		/* see lsctables.gpsproperty */
+		if(nanoseconds == 0xFFFFFFFF) {
+			if(seconds == 0x7FFFFFFF)
+				seconds = INT64_MAX;
+			else if(seconds == 0xFFFFFFFF)
+				seconds = INT64_MIN;
+			nanoseconds = 0;
+		}
+		s_key->value[i] = encode_int64(seconds);
+		ns_key->value[i] = encode_int64(nanoseconds);
+	}
+	result = 0;
+
+done:
+	if(s)
+		free_values(s, n);
+	if(ns)
+		free_values(ns, n);
+	return result;
+}
+
+
+/*
+ * Stably re-order the permutation *perm by a key.  *perm and *perm_scratch
+ * are swapped as required so that *perm holds the result.  keys and
+ * keys_scratch are work space.
+ */
+
+
+static void radix_sort(const struct sort_key *key, int reverse, Py_ssize_t n, Py_ssize_t **perm, Py_ssize_t **perm_scratch, uint64_t **keys, uint64_t **keys_scratch)
+{
+	Py_ssize_t count[8][256];
+	Py_ssize_t i;
+	int b, c;
+
+	/*
+	 * gather the keys into the current order, and histogram all 8
+	 * bytes at once.  the histograms do not depend on the order.
+	 */
+
+	memset(count, 0, sizeof(count));
+	for(i = 0; i < n; i++) {
+		uint64_t k = key->value[(*perm)[i]];
+		if(reverse)
+			k = ~k;
+		(*keys)[i] = k;
+		for(b = 0; b < 8; b++)
+			count[b][(k >> (8 * b)) & 0xff]++;
+	}
+
+	for(b = 0; b < 8; b++) {
+		Py_ssize_t offset = 0;
+		void *swap;
+
+		/* skip bytes that are the same in all keys */
+		for(c = 0; c < 256; c++)
+			if(count[b][c] == n)
+				break;
+		if(c < 256)
+			continue;
+
+		for(c = 0; c < 256; c++) {
+			Py_ssize_t m = count[b][c];
+			count[b][c] = offset;
+			offset += m;
+		}
+		for(i = 0; i < n; i++) {
+			uint64_t k = (*keys)[i];
+			Py_ssize_t j = count[b][(k >> (8 * b)) & 0xff]++;
+			(*keys_scratch)[j] = k;
+			(*perm_scratch)[j] = (*perm)[i];
+		}
+		swap = *keys;
+		*keys = *keys_scratch;
+		*keys_scratch = swap;
+		swap = *perm;
+		*perm = *perm_scratch;
+		*perm_scratch = swap;
+	}
+
+	/*
+	 * None sorts first (last if reversed)
+	 */
+
+	if(key->null) {
+		Py_ssize_t j = 0;
+		Py_ssize_t *swap;
+		for(c = 0; c < 2; c++)
+			for(i = 0; i < n; i++)
+				if(key->null[(*perm)[i]] == (reverse ? c : 1 - c))
+					(*perm_scratch)[j++] = (*perm)[i];
+		swap = *perm;
+		*perm = *perm_scratch;
+		*perm_scratch = swap;
+	}
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Functions
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * sort_rows()
+ */
+
+
+static PyObject *sort_rows(PyObject *self, PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = {"rows", "keys", "reverse", NULL};
+	PyObject *rows, *keys;
+	int reverse = 0;
+	PyObject *names = NULL, *attributes = NULL, *snapshot = NULL, *sorted = NULL;
+	Py_ssize_t *offsets = NULL, *first = NULL, *perm = NULL, *perm_scratch = NULL;
+	uint64_t *work = NULL, *work_scratch = NULL;
+	struct sort_key key = {NULL, NULL}, ns_key = {NULL, NULL};
+	PyTypeObject *rowtype = NULL;
+	PyObject **items;
+	Py_ssize_t n, nkeys, i, k;
+	PyObject *retval = NULL;
+
+	if(!PyArg_ParseTupleAndKeywords(args, kwds, "OO|p", kwlist, &rows, &keys, &reverse))
+		return NULL;
+	if(!PyList_Check(rows)) {
+		PyErr_SetString(PyExc_TypeError, "rows must be a list");
+		return NULL;
+	}
+
+	/*
+	 * flatten the keys into a list of attribute names, recording the
+	 * position of each key's first attribute.  a key is an attribute
+	 * name or a (seconds, nanoseconds) pair of attribute names
+	 */
+
+	keys = PySequence_Fast(keys, "keys must be a sequence");
+	names = PyList_New(0);
+	if(!keys || !names)
+		goto done;
+	nkeys = PySequence_Fast_GET_SIZE(keys);
+	first = malloc((nkeys + 1) * sizeof(*first));
+	if(!first) {
+		PyErr_NoMemory();
+		goto done;
+	}
+	for(k = 0; k < nkeys; k++) {
+		PyObject *item = PySequence_Fast_GET_ITEM(keys, k);
+		first[k] = PyList_GET_SIZE(names);
+		if(PyTuple_Check(item)) {
+			if(PyTuple_GET_SIZE(item) != 2) {
+				PyErr_SetString(PyExc_ValueError, "GPS time keys must be (seconds, nanoseconds) pairs of attribute names");
+				goto done;
+			}
+			if(PyList_Append(names, PyTuple_GET_ITEM(item, 0)) < 0 || PyList_Append(names, PyTuple_GET_ITEM(item, 1)) < 0)
+				goto done;
+		} else if(PyList_Append(names, item) < 0)
+			goto done;
+	}
+	attributes = llwtokenizer_build_attributes(names);
+	if(!attributes)
+		goto done;
+
+	/*
+	 * work from a copy of the list so that comparisons that modify the
+	 * list cannot change the rows out from under us
+	 */
+
+	snapshot = PyList_GetSlice(rows, 0, PY_SSIZE_T_MAX);
+	if(!snapshot)
+		goto done;
+	n = PyList_GET_SIZE(snapshot);
+	items = &PyList_GET_ITEM(snapshot, 0);
+
+	/*
+	 * slot offsets are resolved for the type of the first row.  rows
+	 * of other types use the generic attribute protocol.
+	 */
+
+	offsets = malloc((PyTuple_GET_SIZE(attributes) + 1) * sizeof(*offsets));
+	perm = malloc((n + 1) * sizeof(*perm));
+	perm_scratch = malloc((n + 1) * sizeof(*perm_scratch));
+	work = malloc((n + 1) * sizeof(*work));
+	work_scratch = malloc((n + 1) * sizeof(*work_scratch));
+	if(!offsets || !perm || !perm_scratch || !work || !work_scratch) {
+		PyErr_NoMemory();
+		goto done;
+	}
+	if(n) {
+		rowtype = Py_TYPE(items[0]);
+		if(llwtokenizer_slot_offsets(rowtype, attributes, offsets) < 0)
+			goto done;
+	}
+
+	/*
+	 * sort by each key in turn, starting with the least significant.
+	 * the keys are extracted one at a time to limit the memory needed
+	 */
+
+	for(i = 0; i < n; i++)
+		perm[i] = i;
+	for(k = nkeys - 1; k >= 0; k--) {
+		Py_ssize_t j = first[k];
+		if(PyTuple_Check(PySequence_Fast_GET_ITEM(keys, k))) {
+			if(gps_key(&key, &ns_key, items, n, PyTuple_GET_ITEM(attributes, j), PyTuple_GET_ITEM(attributes, j + 1), rowtype, n ? offsets[j] : -1, n ? offsets[j + 1] : -1) < 0)
+				goto done;
+			radix_sort(&ns_key, reverse, n, &perm, &perm_scratch, &work, &work_scratch);
+			sort_key_free(&ns_key);
+		} else if(column_key(&key, items, n, PyTuple_GET_ITEM(attributes, j), rowtype, n ? offsets[j] : -1) < 0)
+			goto done;
+		radix_sort(&key, reverse, n, &perm, &perm_scratch, &work, &work_scratch);
+		sort_key_free(&key);
+	}
+
+	/*
+	 * replace the list's contents with the rows in order
+	 */
+
+	if(PyList_GET_SIZE(rows) != n) {
+		PyErr_SetString(PyExc_ValueError, "list modified during sort");
+		goto done;
+	}
+	sorted = PyList_New(n);
+	if(!sorted)
+		goto done;
+	for(i = 0; i < n; i++) {
+		PyObject *row = items[perm[i]];
+		Py_INCREF(row);
+		PyList_SET_ITEM(sorted, i, row);
+	}
+	if(PyList_SetSlice(rows, 0, PY_SSIZE_T_MAX, sorted) < 0)
+		goto done;
+
+	Py_INCREF(Py_None);
+	retval = Py_None;
+
+done:
+	sort_key_free(&key);
+	sort_key_free(&ns_key);
+	free(first);
+	free(offsets);
+	free(perm);
+	free(perm_scratch);
+	free(work);
+	free(work_scratch);
+	Py_XDECREF(keys);
+	Py_XDECREF(names);
+	Py_XDECREF(attributes);
+	Py_XDECREF(snapshot);
+	Py_XDECREF(sorted);
+	return retval;
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                            Function Information
+ *
+ * ============================================================================
+ */
+
+
+PyMethodDef llwtokenizer_sort_methods[] = {
+	{"sort_rows", (PyCFunction) sort_rows, METH_VARARGS | METH_KEYWORDS,
+"sort_rows(rows, keys, reverse = False)\n"\
+"\n"\
+"Sort the list of row objects rows in place, in order of the values of their\n"\
+"attributes.  keys is a sequence whose elements are attribute names, or\n"\
+"(seconds, nanoseconds) pairs of attribute names holding GPS times.  Rows\n"\
+"are ordered by the first key, rows with equal first keys by the second, and\n"\
+"so on.  The sort is stable, and if reverse is True the order is reversed\n"\
+"(without reversing the order of equal rows, as for list.sort()).  None is\n"\
+"less than all other values.  The rows are sorted with a radix sort.  Keys\n"\
+"whose values are all integers or all floats are sorted by value, otherwise\n"\
+"the distinct values are sorted with Python's < operator and the rows sorted\n"\
+"by rank.  GPS times are sorted as pairs of integers, with the encodings of\n"\
+"+/- infinity used by ligo.lw.lsctables.gpsproperty recognized.\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> class Row(object):\n"\
+"...     __slots__ = (\"ifo\", \"s\", \"ns\")\n"\
+"...     def __init__(self, ifo, s, ns):\n"\
+"...             self.ifo, self.s, self.ns = ifo, s, ns\n"\
+"...\n"\
+">>> rows = [Row(\"L1\", 10, 5), Row(\"H1\", 10, 2), Row(\"H1\", 9, 999999999), Row(None, 12, 0)]\n"\
+">>> tokenizer.sort_rows(rows, [(\"s\", \"ns\")])\n"\
+">>> [(row.s, row.ns) for row in rows]\n"\
+"[(9, 999999999), (10, 2), (10, 5), (12, 0)]\n"\
+">>> tokenizer.sort_rows(rows, [\"ifo\", (\"s\", \"ns\")], reverse = True)\n"\
+">>> [(row.ifo, row.s, row.ns) for row in rows]\n"\
+"[('L1', 10, 5), ('H1', 10, 2), ('H1', 9, 999999999), (None, 12, 0)]"
+	},
+	{NULL,}
+};
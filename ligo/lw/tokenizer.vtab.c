@@ -0,0 +1,1041 @@
+/*
+ * Copyright (C) 2026  Kipp C. Cannon
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+/*
+ * ============================================================================
+ *
+ *                    tokenizer SQLite Virtual Table Module
+ *
+ * ============================================================================
+ */
+
+
+#define PY_SSIZE_T_CLEAN
+
+#include <Python.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tokenizer.h>
+
+
+/*
+ * the module is only available if the extension was built against
+ * SQLite's headers
+ */
+
+
+#ifdef HAVE_SQLITE3_H
+
+
+#include <dlfcn.h>
+#include <sqlite3.h>
+
+
+/*
+ * ============================================================================
+ *
+ *                              Internal Helpers
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * The leading part of the sqlite3 module's Connection object.  This is
+ * not a public interface:  the layout has been checked against
+ * Modules/_sqlite/connection.h of CPython 3.8 through 3.13, in all of
+ * which the database handle is the first member, and the handle is not
+ * retrieved on other versions.  Check the layout again before extending
+ * the range.
+ */
+
+
+#define PYSQLITE_CONNECTION_LAYOUT_KNOWN (PY_VERSION_HEX >= 0x03080000 && PY_VERSION_HEX < 0x030e0000)
+
+
+struct pysqlite_connection_head {
+	PyObject_HEAD
+	sqlite3 *db;
+};
+
+
+/*
+ * Column affinities.  Only INTEGER and REAL columns can be indexed.
+ */
+
+
+enum affinity {
+	AFFINITY_OTHER,
+	AFFINITY_INTEGER,
+	AFFINITY_REAL
+};
+
+
+/*
+ * The module's client data:  the Table and the description of its
+ * columns.  Owned by the SQLite connection, and released by its
+ * destructor when the module is replaced or the connection closed.
+ */
+
+
+struct table_data {
+	PyObject *rows;
+	PyObject *attributes;
+	enum affinity *affinities;
+	int *indexed;
+	Py_ssize_t ncols;
+	char *schema;
+};
+
+
+static void table_data_free(void *ptr)
+{
+	struct table_data *data = ptr;
+	PyGILState_STATE gil = PyGILState_Ensure();
+
+	Py_XDECREF(data->rows);
+	Py_XDECREF(data->attributes);
+	free(data->affinities);
+	free(data->indexed);
+	free(data->schema);
+	free(data);
+
+	PyGILState_Release(gil);
+}
+
+
+/*
+ * An index of the rows sorted by the value of one column.  Rows in which
+ * the column is None, NaN, or not set are omitted.
+ */
+
+
+struct index_entry {
+	union {
+		int64_t i;
+		double d;
+	} key;
+	Py_ssize_t row;
+};
+
+
+struct sorted_index {
+	struct index_entry *entries;
+	Py_ssize_t n;
+	/* 1 if built, -1 if the column's values cannot be indexed */
+	int state;
+};
+
+
+static int compare_int(const void *a, const void *b)
+{
+	int64_t x = ((const struct index_entry *) a)->key.i;
+	int64_t y = ((const struct index_entry *) b)->key.i;
+	if(x != y)
+		return x < y ? -1 : +1;
+	/* keep rows in order for equal keys */
+	return ((const struct index_entry *) a)->row < ((const struct index_entry *) b)->row ? -1 : +1;
+}
+
+
+static int compare_real(const void *a, const void *b)
+{
+	double x = ((const struct index_entry *) a)->key.d;
+	double y = ((const struct index_entry *) b)->key.d;
+	if(x != y)
+		return x < y ? -1 : +1;
+	return ((const struct index_entry *) a)->row < ((const struct index_entry *) b)->row ? -1 : +1;
+}
+
+
+/*
+ * Index of the first entry whose key is >= lo, and of the first entry
+ * whose key is > hi.
+ */
+
+
+static Py_ssize_t lower_bound(const struct sorted_index *index, enum affinity affinity, int64_t ilo, double dlo)
+{
+	Py_ssize_t first = 0, n = index->n;
+	while(n > 0) {
+		Py_ssize_t half = n / 2;
+		const struct index_entry *entry = &index->entries[first + half];
+		if(affinity == AFFINITY_INTEGER ? entry->key.i < ilo : entry->key.d < dlo) {
+			first += half + 1;
+			n -= half + 1;
+		} else
+			n = half;
+	}
+	return first;
+}
+
+
+static Py_ssize_t upper_bound(const struct sorted_index *index, enum affinity affinity, int64_t ihi, double dhi)
+{
+	Py_ssize_t first = 0, n = index->n;
+	while(n > 0) {
+		Py_ssize_t half = n / 2;
+		const struct index_entry *entry = &index->entries[first + half];
+		if(affinity == AFFINITY_INTEGER ? entry->key.i <= ihi : entry->key.d <= dhi) {
+			first += half + 1;
+			n -= half + 1;
+		} else
+			n = half;
+	}
+	return first;
+}
+
+
+/*
+ * The virtual table and cursor objects
+ */
+
+
+typedef struct {
+	sqlite3_vtab base;
+	struct table_data *data;
+} ligolw_vtab;
+
+
+typedef struct {
+	sqlite3_vtab_cursor base;
+	/* slot offsets for rows of type rowtype */
+	PyTypeObject *rowtype;
+	Py_ssize_t *offsets;
+	/* sorted indexes, built when first used, one for each column */
+	struct sorted_index *indexes;
+	/* the index being used, or NULL for a full scan */
+	const struct sorted_index *index;
+	Py_ssize_t pos, end;
+} ligolw_vtab_cursor;
+
+
+/*
+ * Record the Python exception in the virtual table's error message, and
+ * clear it.  Must be called with the GIL held.  Returns SQLITE_ERROR.
+ */
+
+
+static int set_error(sqlite3_vtab *vtab)
+{
+	PyObject *type, *value, *traceback, *str;
+
+	PyErr_Fetch(&type, &value, &traceback);
+	str = value ? PyObject_Str(value) : NULL;
+	sqlite3_free(vtab->zErrMsg);
+	vtab->zErrMsg = sqlite3_mprintf("%s", str && PyUnicode_Check(str) ? PyUnicode_AsUTF8(str) : "error in ligolw virtual table");
+	Py_XDECREF(str);
+	Py_XDECREF(type);
+	Py_XDECREF(value);
+	Py_XDECREF(traceback);
+	PyErr_Clear();
+	return SQLITE_ERROR;
+}
+
+
+/*
+ * Return the value of column j of the row at index i, or NULL if it is
+ * not set.  Must be called with the GIL held.  Returns a new reference.
+ * On failure returns NULL with an exception set.
+ */
+
+
+static PyObject *get_value(const ligolw_vtab_cursor *cursor, const struct table_data *data, Py_ssize_t i, Py_ssize_t j)
+{
+	PyObject *row, *val;
+
+	if(i >= PyList_GET_SIZE(data->rows))
+		/* the Table was shortened */
+		return NULL;
+	row = PyList_GET_ITEM(data->rows, i);
+	val = llwtokenizer_slot_get(row, PyTuple_GET_ITEM(data->attributes, j), Py_TYPE(row) == cursor->rowtype ? cursor->offsets[j] : -1);
+	if(!val && PyErr_ExceptionMatches(PyExc_AttributeError))
+		/* not set:  SQL NULL */
+		PyErr_Clear();
+	return val;
+}
+
+
+/*
+ * Build the sorted index of column j.  Must be called with the GIL held.
+ * Returns 0 on success, -1 on failure.  A column containing values that
+ * cannot be converted to the column's affinity is not an error:  the
+ * index's state is set to -1 and the caller must scan the Table instead.
+ */
+
+
+static int build_index(const ligolw_vtab_cursor *cursor, const struct table_data *data, Py_ssize_t j, struct sorted_index *index)
+{
+	Py_ssize_t n = PyList_GET_SIZE(data->rows);
+	Py_ssize_t i;
+
+	index->entries = malloc((n ? n : 1) * sizeof(*index->entries));
+	if(!index->entries) {
+		PyErr_NoMemory();
+		return -1;
+	}
+	index->n = 0;
+	for(i = 0; i < n; i++) {
+		struct index_entry *entry = &index->entries[index->n];
+		PyObject *val = get_value(cursor, data, i, j);
+		if(!val) {
+			if(PyErr_Occurred())
+				return -1;
+			continue;
+		}
+		if(val == Py_None) {
+			Py_DECREF(val);
+			continue;
+		}
+		if(data->affinities[j] == AFFINITY_INTEGER) {
+			if(!PyLong_Check(val)) {
+				Py_DECREF(val);
+				index->state = -1;
+				return 0;
+			}
+			entry->key.i = PyLong_AsLongLong(val);
+			Py_DECREF(val);
+			if(entry->key.i == -1 && PyErr_Occurred()) {
+				if(!PyErr_ExceptionMatches(PyExc_OverflowError))
+					return -1;
+				PyErr_Clear();
+				index->state = -1;
+				return 0;
+			}
+		} else {
+			if(!PyFloat_Check(val) && !PyLong_Check(val)) {
+				Py_DECREF(val);
+				index->state = -1;
+				return 0;
+			}
+			entry->key.d = PyFloat_AsDouble(val);
+			Py_DECREF(val);
+			if(entry->key.d == -1. && PyErr_Occurred()) {
+				if(!PyErr_ExceptionMatches(PyExc_OverflowError))
+					return -1;
+				PyErr_Clear();
+				index->state = -1;
+				return 0;
+			}
+			if(isnan(entry->key.d))
+				/* SQLite stores NaN as NULL */
+				continue;
+		}
+		entry->row = i;
+		index->n++;
+	}
+	qsort(index->entries, index->n, sizeof(*index->entries), data->affinities[j] == AFFINITY_INTEGER ? compare_int : compare_real);
+	index->state = 1;
+	return 0;
+}
+
+
+/*
+ * Convert a constraint's value to a bound on a column with the given
+ * affinity.  The bounds are widened when they cannot be represented
+ * exactly, so they select a superset of the rows;  SQLite checks the
+ * constraints again.  Returns 1 if the bound is usable, 0 if the value
+ * is NULL (the constraint can never be true), -1 if the Table must be
+ * scanned.
+ */
+
+
+static int get_bound(sqlite3_value *value, enum affinity affinity, int upper, int64_t *i, double *d)
+{
+	switch(sqlite3_value_type(value)) {
+	case SQLITE_NULL:
+		return 0;
+
+	case SQLITE_INTEGER:
+		*i = sqlite3_value_int64(value);
+		*d = (double) *i;
+		if(affinity == AFFINITY_REAL && (*d >= 9223372036854775808. || (int64_t) *d != *i))
+			*d = nextafter(*d, upper ? INFINITY : -INFINITY);
+		return 1;
+
+	case SQLITE_FLOAT:
+		*d = sqlite3_value_double(value);
+		if(isnan(*d))
+			return 0;
+		if(affinity == AFFINITY_INTEGER) {
+			double x = upper ? ceil(*d) : floor(*d);
+			if(x <= -9223372036854775808.)
+				*i = INT64_MIN;
+			else if(x >= 9223372036854775808.)
+				*i = INT64_MAX;
+			else
+				*i = (int64_t) x;
+		}
+		return 1;
+
+	default:
+		/* text and blobs:  leave it to SQLite */
+		return -1;
+	}
+}
+
+
+/*
+ * ============================================================================
+ *
+ *                           Virtual Table Methods
+ *
+ * ============================================================================
+ */
+
+
+static int vtab_connect(sqlite3 *db, void *aux, int argc, const char *const *argv, sqlite3_vtab **vtab, char **err)
+{
+	struct table_data *data = aux;
+	ligolw_vtab *new;
+	int rc;
+
+	rc = sqlite3_declare_vtab(db, data->schema);
+	if(rc != SQLITE_OK)
+		return rc;
+	new = sqlite3_malloc(sizeof(*new));
+	if(!new)
+		return SQLITE_NOMEM;
+	memset(new, 0, sizeof(*new));
+	new->data = data;
+	*vtab = &new->base;
+	return SQLITE_OK;
+}
+
+
+static int vtab_disconnect(sqlite3_vtab *vtab)
+{
+	sqlite3_free(vtab);
+	return SQLITE_OK;
+}
+
+
+/*
+ * idxNum encodes the column whose index is used and the constraints
+ * passed to xFilter(), in order:  (column << 3) | flags, where flags is
+ * 1 for an equality constraint, or 2 for a lower bound and 4 for an
+ * upper bound.  0 means scan the Table.
+ */
+
+
+#define IDX_EQ 1
+#define IDX_LOWER 2
+#define IDX_UPPER 4
+
+
+static int rank(int flags)
+{
+	return flags == IDX_EQ ? 3 : flags == (IDX_LOWER | IDX_UPPER) ? 2 : flags ? 1 : 0;
+}
+
+
+static int vtab_best_index(sqlite3_vtab *vtab, sqlite3_index_info *info)
+{
+	struct table_data *data = ((ligolw_vtab *) vtab)->data;
+	PyGILState_STATE gil;
+	double n;
+	int best_col = -1, best_flags = 0;
+	int eq = -1, lower = -1, upper = -1;
+	int col, i;
+
+	gil = PyGILState_Ensure();
+	n = PyList_GET_SIZE(data->rows);
+	PyGILState_Release(gil);
+
+	/*
+	 * find the indexed column with the most useful constraints:  an
+	 * equality constraint, then both bounds, then one
+	 */
+
+	for(col = 0; col < data->ncols; col++) {
+		int c_eq = -1, c_lower = -1, c_upper = -1, flags;
+		if(!data->indexed[col])
+			continue;
+		for(i = 0; i < info->nConstraint; i++) {
+			const struct sqlite3_index_constraint *constraint = &info->aConstraint[i];
+			if(!constraint->usable || constraint->iColumn != col)
+				continue;
+			switch(constraint->op) {
+			case SQLITE_INDEX_CONSTRAINT_EQ:
+				c_eq = i;
+				break;
+			case SQLITE_INDEX_CONSTRAINT_GT:
+			case SQLITE_INDEX_CONSTRAINT_GE:
+				c_lower = i;
+				break;
+			case SQLITE_INDEX_CONSTRAINT_LT:
+			case SQLITE_INDEX_CONSTRAINT_LE:
+				c_upper = i;
+				break;
+			}
+		}
+		flags = c_eq >= 0 ? IDX_EQ : (c_lower >= 0 ? IDX_LOWER : 0) | (c_upper >= 0 ? IDX_UPPER : 0);
+		if(rank(flags) > rank(best_flags)) {
+			best_col = col;
+			best_flags = flags;
+			eq = c_eq;
+			lower = c_lower;
+			upper = c_upper;
+		}
+	}
+
+	if(best_col < 0) {
+		info->idxNum = 0;
+		info->estimatedCost = n;
+		info->estimatedRows = (sqlite3_int64) n;
+		return SQLITE_OK;
+	}
+
+	/*
+	 * constraints are not omitted, SQLite checks them again, so the
+	 * index need only select a superset of the rows
+	 */
+
+	info->idxNum = (best_col << 3) | best_flags;
+	if(best_flags == IDX_EQ) {
+		info->aConstraintUsage[eq].argvIndex = 1;
+		info->estimatedRows = 1;
+		info->estimatedCost = log2(n + 2.);
+	} else {
+		int argv_index = 1;
+		if(best_flags & IDX_LOWER)
+			info->aConstraintUsage[lower].argvIndex = argv_index++;
+		if(best_flags & IDX_UPPER)
+			info->aConstraintUsage[upper].argvIndex = argv_index++;
+		info->estimatedRows = (sqlite3_int64) (n / (best_flags == (IDX_LOWER | IDX_UPPER) ? 16. : 4.)) + 1;
+		info->estimatedCost = log2(n + 2.) + info->estimatedRows;
+	}
+	return SQLITE_OK;
+}
+
+
+static int vtab_open(sqlite3_vtab *vtab, sqlite3_vtab_cursor **cursor)
+{
+	struct table_data *data = ((ligolw_vtab *) vtab)->data;
+	ligolw_vtab_cursor *new;
+	PyGILState_STATE gil;
+	int rc = SQLITE_OK;
+
+	new = sqlite3_malloc(sizeof(*new));
+	if(!new)
+		return SQLITE_NOMEM;
+	memset(new, 0, sizeof(*new));
+	new->offsets = calloc(data->ncols ? data->ncols : 1, sizeof(*new->offsets));
+	new->indexes = calloc(data->ncols ? data->ncols : 1, sizeof(*new->indexes));
+	if(!new->offsets || !new->indexes) {
+		free(new->offsets);
+		free(new->indexes);
+		sqlite3_free(new);
+		return SQLITE_NOMEM;
+	}
+
+	/*
+	 * slot offsets are resolved for the type of the first row.  rows
+	 * of other types use the generic attribute protocol.
+	 */
+
+	gil = PyGILState_Ensure();
+	if(PyList_GET_SIZE(data->rows)) {
+		new->rowtype = Py_TYPE(PyList_GET_ITEM(data->rows, 0));
+		if(llwtokenizer_slot_offsets(new->rowtype, data->attributes, new->offsets) < 0)
+			rc = set_error(vtab);
+	}
+	PyGILState_Release(gil);
+	if(rc != SQLITE_OK) {
+		free(new->offsets);
+		free(new->indexes);
+		sqlite3_free(new);
+		return rc;
+	}
+
+	*cursor = &new->base;
+	return SQLITE_OK;
+}
+
+
+static int vtab_close(sqlite3_vtab_cursor *cursor)
+{
+	ligolw_vtab_cursor *c = (ligolw_vtab_cursor *) cursor;
+	Py_ssize_t j;
+
+	for(j = 0; j < ((ligolw_vtab *) cursor->pVtab)->data->ncols; j++)
+		free(c->indexes[j].entries);
+	free(c->indexes);
+	free(c->offsets);
+	sqlite3_free(c);
+	return SQLITE_OK;
+}
+
+
+static int vtab_filter(sqlite3_vtab_cursor *cursor, int idxNum, const char *idxStr, int argc, sqlite3_value **argv)
+{
+	ligolw_vtab_cursor *c = (ligolw_vtab_cursor *) cursor;
+	struct table_data *data = ((ligolw_vtab *) cursor->pVtab)->data;
+	int col = idxNum >> 3, flags = idxNum & 7;
+	enum affinity affinity;
+	struct sorted_index *index;
+	int64_t ilo = INT64_MIN, ihi = INT64_MAX;
+	double dlo = -INFINITY, dhi = INFINITY;
+	PyGILState_STATE gil;
+	int arg = 0;
+	int rc = SQLITE_OK;
+
+	c->index = NULL;
+	c->pos = 0;
+
+	gil = PyGILState_Ensure();
+	c->end = PyList_GET_SIZE(data->rows);
+	if(!flags || col >= data->ncols)
+		goto done;
+	affinity = data->affinities[col];
+
+	/*
+	 * convert the constraints to bounds
+	 */
+
+	if(flags & IDX_EQ) {
+		switch(get_bound(argv[arg], affinity, 0, &ilo, &dlo)) {
+		case 0:
+			c->end = 0;
+			goto done;
+		case -1:
+			goto done;
+		}
+		switch(get_bound(argv[arg++], affinity, 1, &ihi, &dhi)) {
+		case 0:
+			c->end = 0;
+			goto done;
+		case -1:
+			goto done;
+		}
+	}
+	if(flags & IDX_LOWER) {
+		switch(get_bound(argv[arg++], affinity, 0, &ilo, &dlo)) {
+		case 0:
+			c->end = 0;
+			goto done;
+		case -1:
+			/* leave the lower bound open */
+			ilo = INT64_MIN;
+			dlo = -INFINITY;
+			break;
+		}
+	}
+	if(flags & IDX_UPPER) {
+		switch(get_bound(argv[arg++], affinity, 1, &ihi, &dhi)) {
+		case 0:
+			c->end = 0;
+			goto done;
+		case -1:
+			ihi = INT64_MAX;
+			dhi = INFINITY;
+			break;
+		}
+	}
+
+	/*
+	 * build the index the first time it's needed, and use it if the
+	 * column's values could be indexed
+	 */
+
+	index = &c->indexes[col];
+	if(!index->state && build_index(c, data, col, index) < 0) {
+		free(index->entries);
+		index->entries = NULL;
+		rc = set_error(cursor->pVtab);
+		goto done;
+	}
+	if(index->state < 0)
+		goto done;
+	c->index = index;
+	c->pos = lower_bound(index, affinity, ilo, dlo);
+	c->end = upper_bound(index, affinity, ihi, dhi);
+	if(c->end < c->pos)
+		c->end = c->pos;
+
+done:
+	PyGILState_Release(gil);
+	return rc;
+}
+
+
+static int vtab_next(sqlite3_vtab_cursor *cursor)
+{
+	((ligolw_vtab_cursor *) cursor)->pos++;
+	return SQLITE_OK;
+}
+
+
+static int vtab_eof(sqlite3_vtab_cursor *cursor)
+{
+	ligolw_vtab_cursor *c = (ligolw_vtab_cursor *) cursor;
+	return c->pos >= c->end;
+}
+
+
+static Py_ssize_t current_row(const ligolw_vtab_cursor *c)
+{
+	return c->index ? c->index->entries[c->pos].row : c->pos;
+}
+
+
+static int vtab_column(sqlite3_vtab_cursor *cursor, sqlite3_context *context, int j)
+{
+	ligolw_vtab_cursor *c = (ligolw_vtab_cursor *) cursor;
+	struct table_data *data = ((ligolw_vtab *) cursor->pVtab)->data;
+	PyGILState_STATE gil = PyGILState_Ensure();
+	PyObject *val = get_value(c, data, current_row(c), j);
+
+	if(!val) {
+		if(PyErr_Occurred())
+			goto error;
+		sqlite3_result_null(context);
+	} else if(val == Py_None)
+		sqlite3_result_null(context);
+	else if(PyFloat_Check(val))
+		sqlite3_result_double(context, PyFloat_AS_DOUBLE(val));
+	else if(PyLong_Check(val)) {
+		long long x = PyLong_AsLongLong(val);
+		if(x == -1 && PyErr_Occurred())
+			goto error;
+		sqlite3_result_int64(context, x);
+	} else if(PyUnicode_Check(val)) {
+		Py_ssize_t size;
+		const char *s = PyUnicode_AsUTF8AndSize(val, &size);
+		if(!s)
+			goto error;
+		sqlite3_result_text64(context, s, size, SQLITE_TRANSIENT, SQLITE_UTF8);
+	} else if(PyObject_CheckBuffer(val)) {
+		Py_buffer view;
+		if(PyObject_GetBuffer(val, &view, PyBUF_SIMPLE) < 0)
+			goto error;
+		sqlite3_result_blob64(context, view.buf, view.len, SQLITE_TRANSIENT);
+		PyBuffer_Release(&view);
+	} else {
+		PyErr_Format(PyExc_TypeError, "column '%U':  cannot convert '%.50s' to an SQLite value", PyTuple_GET_ITEM(data->attributes, j), Py_TYPE(val)->tp_name);
+		goto error;
+	}
+	Py_XDECREF(val);
+	PyGILState_Release(gil);
+	return SQLITE_OK;
+
+error:
+	Py_XDECREF(val);
+	set_error(cursor->pVtab);
+	sqlite3_result_error(context, cursor->pVtab->zErrMsg, -1);
+	PyGILState_Release(gil);
+	return SQLITE_ERROR;
+}
+
+
+static int vtab_rowid(sqlite3_vtab_cursor *cursor, sqlite3_int64 *rowid)
+{
+	*rowid = current_row((ligolw_vtab_cursor *) cursor);
+	return SQLITE_OK;
+}
+
+
+static sqlite3_module ligolw_module = {
+	.iVersion = 1,
+	.xCreate = vtab_connect,
+	.xConnect = vtab_connect,
+	.xBestIndex = vtab_best_index,
+	.xDisconnect = vtab_disconnect,
+	.xDestroy = vtab_disconnect,
+	.xOpen = vtab_open,
+	.xClose = vtab_close,
+	.xFilter = vtab_filter,
+	.xNext = vtab_next,
+	.xEof = vtab_eof,
+	.xColumn = vtab_column,
+	.xRowid = vtab_rowid,
+};
+
+
+/*
+ * ============================================================================
+ *
+ *                                 Functions
+ *
+ * ============================================================================
+ */
+
+
+/*
+ * Confirm that the sqlite3 module's extension, whose path is filename,
+ * uses the same copy of the SQLite library as this module, by looking up
+ * an SQLite function through the extension's own symbol scope.  A
+ * different copy, e.g., one linked statically into the extension, cannot
+ * be given handles created by this one, even if it is the same version.
+ * Returns 0 on success, -1 with an exception set on failure.
+ */
+
+
+static int check_same_library(PyObject *filename)
+{
+	PyObject *bytes = PyUnicode_EncodeFSDefault(filename);
+	void *handle;
+	void *symbol;
+
+	if(!bytes)
+		return -1;
+	/* the extension has been imported, don't load it again */
+	handle = dlopen(PyBytes_AS_STRING(bytes), RTLD_LAZY | RTLD_NOLOAD);
+	Py_DECREF(bytes);
+	if(!handle) {
+		PyErr_Format(PyExc_RuntimeError, "cannot inspect the sqlite3 module's extension '%U'", filename);
+		return -1;
+	}
+	symbol = dlsym(handle, "sqlite3_libversion");
+	dlclose(handle);
+	if(symbol != (void *) sqlite3_libversion) {
+		PyErr_SetString(PyExc_RuntimeError, "the sqlite3 module does not use the same SQLite library as this module");
+		return -1;
+	}
+	return 0;
+}
+
+
+/*
+ * Retrieve the database handle from a sqlite3.Connection object, after
+ * confirming that the Connection object's layout is known for this
+ * version of Python, and that the sqlite3 module is using the SQLite
+ * library against which this module is linked.  Returns NULL with an
+ * exception set on failure.
+ */
+
+
+static sqlite3 *get_db(PyObject *connection)
+{
+	PyObject *sqlite3_module, *extension = NULL;
+	PyObject *connection_type = NULL, *version = NULL, *filename = NULL;
+	sqlite3 *db = NULL;
+	int isinstance;
+
+	if(!PYSQLITE_CONNECTION_LAYOUT_KNOWN) {
+		PyErr_Format(PyExc_RuntimeError, "retrieving the database handle from a sqlite3.Connection is not supported on Python %s", Py_GetVersion());
+		return NULL;
+	}
+	sqlite3_module = PyImport_ImportModule("sqlite3");
+	if(!sqlite3_module)
+		return NULL;
+	extension = PyImport_ImportModule("_sqlite3");
+	connection_type = PyObject_GetAttrString(sqlite3_module, "Connection");
+	version = PyObject_GetAttrString(sqlite3_module, "sqlite_version");
+	if(!extension || !connection_type || !version)
+		goto done;
+	filename = PyObject_GetAttrString(extension, "__file__");
+	if(!filename)
+		goto done;
+	isinstance = PyObject_IsInstance(connection, connection_type);
+	if(isinstance < 0)
+		goto done;
+	if(!isinstance) {
+		PyErr_SetString(PyExc_TypeError, "connection must be a sqlite3.Connection");
+		goto done;
+	}
+	if(!PyUnicode_Check(version) || strcmp(PyUnicode_AsUTF8(version), sqlite3_libversion())) {
+		PyErr_Format(PyExc_RuntimeError, "the sqlite3 module uses SQLite %S, but this module was built with SQLite %s", version, sqlite3_libversion());
+		goto done;
+	}
+	if(!PyUnicode_Check(filename)) {
+		PyErr_SetString(PyExc_RuntimeError, "cannot locate the sqlite3 module's extension");
+		goto done;
+	}
+	if(check_same_library(filename) < 0)
+		goto done;
+	db = ((struct pysqlite_connection_head *) connection)->db;
+	if(!db)
+		PyErr_SetString(PyExc_ValueError, "cannot operate on a closed database");
+
+done:
+	Py_XDECREF(filename);
+	Py_XDECREF(connection_type);
+	Py_XDECREF(version);
+	Py_XDECREF(extension);
+	Py_DECREF(sqlite3_module);
+	return db;
+}
+
+
+/*
+ * sqlite_create_module()
+ */
+
+
+static PyObject *sqlite_create_module(PyObject *self, PyObject *args)
+{
+	PyObject *connection, *rows, *attributes, *types, *indexed;
+	PyObject *coldefs = NULL, *separator = NULL, *schema = NULL;
+	const char *name;
+	struct table_data *data;
+	sqlite3 *db;
+	Py_ssize_t j;
+	int rc;
+
+	if(!PyArg_ParseTuple(args, "OsOOOO", &connection, &name, &rows, &attributes, &types, &indexed))
+		return NULL;
+	if(!PyList_Check(rows)) {
+		PyErr_SetString(PyExc_TypeError, "rows must be a list");
+		return NULL;
+	}
+	db = get_db(connection);
+	if(!db)
+		return NULL;
+
+	data = calloc(1, sizeof(*data));
+	if(!data)
+		return PyErr_NoMemory();
+	data->attributes = llwtokenizer_build_attributes(attributes);
+	types = PySequence_Tuple(types);
+	indexed = PySequence_Tuple(indexed);
+	if(!data->attributes || !types || !indexed)
+		goto error;
+	data->ncols = PyTuple_GET_SIZE(data->attributes);
+	if(PyTuple_GET_SIZE(types) != data->ncols || PyTuple_GET_SIZE(indexed) != data->ncols) {
+		PyErr_SetString(PyExc_ValueError, "len(types) and len(indexed) must equal len(attributes)");
+		goto error;
+	}
+	data->affinities = malloc((data->ncols ? data->ncols : 1) * sizeof(*data->affinities));
+	data->indexed = malloc((data->ncols ? data->ncols : 1) * sizeof(*data->indexed));
+	coldefs = PyList_New(data->ncols);
+	if(!data->affinities || !data->indexed || !coldefs) {
+		PyErr_NoMemory();
+		goto error;
+	}
+	for(j = 0; j < data->ncols; j++) {
+		PyObject *type = PyTuple_GET_ITEM(types, j);
+		PyObject *coldef;
+		int is_indexed;
+		if(!PyUnicode_Check(type)) {
+			PyErr_SetString(PyExc_TypeError, "types must be strings");
+			goto error;
+		}
+		data->affinities[j] = !PyUnicode_CompareWithASCIIString(type, "INTEGER") ? AFFINITY_INTEGER : !PyUnicode_CompareWithASCIIString(type, "REAL") ? AFFINITY_REAL : AFFINITY_OTHER;
+		is_indexed = PyObject_IsTrue(PyTuple_GET_ITEM(indexed, j));
+		if(is_indexed < 0)
+			goto error;
+		data->indexed[j] = is_indexed && data->affinities[j] != AFFINITY_OTHER;
+		coldef = PyUnicode_FromFormat("\"%U\" %U", PyTuple_GET_ITEM(data->attributes, j), type);
+		if(!coldef)
+			goto error;
+		PyList_SET_ITEM(coldefs, j, coldef);
+	}
+	separator = PyUnicode_FromString(", ");
+	if(!separator)
+		goto error;
+	schema = PyUnicode_Join(separator, coldefs);
+	if(!schema)
+		goto error;
+	Py_SETREF(schema, PyUnicode_FromFormat("CREATE TABLE x(%U)", schema));
+	if(!schema)
+		goto error;
+	data->schema = strdup(PyUnicode_AsUTF8(schema));
+	if(!data->schema) {
+		PyErr_NoMemory();
+		goto error;
+	}
+	Py_INCREF(rows);
+	data->rows = rows;
+
+	/*
+	 * on failure SQLite calls the destructor
+	 */
+
+	rc = sqlite3_create_module_v2(db, name, &ligolw_module, data, table_data_free);
+	data = NULL;
+	if(rc != SQLITE_OK) {
+		PyErr_Format(PyExc_RuntimeError, "cannot create SQLite module '%s': %s", name, sqlite3_errmsg(db));
+		goto error;
+	}
+
+	Py_DECREF(types);
+	Py_DECREF(indexed);
+	Py_DECREF(coldefs);
+	Py_DECREF(separator);
+	Py_DECREF(schema);
+	Py_RETURN_NONE;
+
+error:
+	if(data)
+		table_data_free(data);
+	Py_XDECREF(types);
+	Py_XDECREF(indexed);
+	Py_XDECREF(coldefs);
+	Py_XDECREF(separator);
+	Py_XDECREF(schema);
+	return NULL;
+}
+
+
+#endif /* HAVE_SQLITE3_H */
+
+
+/*
+ * ============================================================================
+ *
+ *                            Function Information
+ *
+ * ============================================================================
+ */
+
+
+PyMethodDef llwtokenizer_vtab_methods[] = {
+#ifdef HAVE_SQLITE3_H
+	{"sqlite_create_module", sqlite_create_module, METH_VARARGS,
+"sqlite_create_module(connection, name, rows, attributes, types, indexed)\n"\
+"\n"\
+"Register an SQLite virtual table module named name with the\n"\
+"sqlite3.Connection object connection, that exposes the row objects in the\n"\
+"list rows as a table without copying them.  attributes is a sequence of the\n"\
+"names of the rows' attributes to expose as the table's columns, types a\n"\
+"sequence of their SQLite types, and indexed a sequence of booleans\n"\
+"indicating the INTEGER and REAL columns for which equality and range\n"\
+"constraints are to be satisfied with a sorted index of the rows (built when\n"\
+"first needed by each query).  Attributes that are not set are NULL.  Create\n"\
+"the table with \"CREATE VIRTUAL TABLE temp.x USING name\".  The module holds\n"\
+"a reference to rows until it is replaced or the connection closed, and\n"\
+"queries see the rows as they are when the query is run.  The sqlite3 module\n"\
+"must be using the SQLite library against which this module was built,\n"\
+"RuntimeError is raised if not.\n"\
+"\n"\
+"Example:\n"\
+"\n"\
+">>> import sqlite3\n"\
+">>> from ligo.lw import tokenizer\n"\
+">>> class Row(object):\n"\
+"...     __slots__ = (\"event_id\", \"snr\")\n"\
+"...     def __init__(self, event_id, snr):\n"\
+"...             self.event_id, self.snr = event_id, snr\n"\
+"...\n"\
+">>> rows = [Row(0, 5.5), Row(1, 8.), Row(2, None)]\n"\
+">>> connection = sqlite3.connect(\":memory:\")\n"\
+">>> tokenizer.sqlite_create_module(connection, \"example\", rows, (\"event_id\", \"snr\"), (\"INTEGER\", \"REAL\"), (True, False))\n"\
+">>> cursor = connection.execute(\"CREATE VIRTUAL TABLE temp.x USING example\")\n"\
+">>> connection.execute(\"SELECT snr FROM x WHERE event_id == 1\").fetchall()\n"\
+"[(8.0,)]\n"\
+">>> rows.append(Row(3, 7.))\n"\
+">>> connection.execute(\"SELECT event_id FROM x WHERE snr > 6 ORDER BY event_id\").fetchall()\n"\
+"[(1,), (3,)]"
+	},
+#endif /* HAVE_SQLITE3_H */
+	{NULL,}
+};
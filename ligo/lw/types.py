@@ -297,6 +297,46 @@ data type strings.  Uesd by ligo.lw array writing codes.
 """
 
 
+#
+# =============================================================================
+#
+#                   Conversion To and From Packed Column Buffers
+#
+# =============================================================================
+#
+
+
+ToBufferCode = {
+	"char_s": "u",
+	"char_v": "u",
+	"ilwd:char": "u",
+	"ilwd:char_u": "y",
+	"blob": "y",
+	"lstring": "u",
+	"string": "u",
+	"int_2s": "q",
+	"int_2u": "q",
+	"int_4s": "q",
+	"int_4u": "q",
+	"int_8s": "q",
+	"int_8u": "Q",
+	"int": "q",
+	"real_4": "d",
+	"real_8": "d",
+	"float": "d",
+	"double": "d",
+	"complex_8": "D",
+	"complex_16": "D"
+}
+"""
+Look-up table mapping LIGO Light-Weight XML data type strings to the buffer
+type codes used by the tokenizer module's pack_columns() function.  Note
+that single-precision values are packed as doubles because the Python
+objects holding them are double-precision.  Used by the Table pickling
+code.
+"""
+
+
 #
 # =============================================================================
 #
@@ -31,30 +31,49 @@ Library of utility code for LIGO Light Weight XML applications.
 
 import bz2
 import codecs
+import collections
 import contextlib
+import functools
 import gzip
+import hashlib
+import io
+import json
 import lzma
+import mmap
 import os
+import shutil
 import signal
 import stat
+import struct
 import sys
+import tempfile
 import urllib.parse
 import urllib.request
+import xml.parsers.expat
+import zlib
+from xml.sax.saxutils import escape as xmlescape
 
 
 from .. import __author__, __date__, __version__
 from .. import ligolw
+from .. import tokenizer
+from .. import types as ligolwtypes
 
 
 __all__ = [
 	"sort_files_by_size",
 	"local_path_from_url",
+	"DocumentCache",
 	"load_fileobj",
 	"load_filename",
 	"load_url",
 	"write_fileobj",
 	"write_filename",
-	"write_url"
+	"write_url",
+	"add_crc32_params",
+	"verify_crc32_params",
+	"DocumentWriter",
+	"append_rows"
 ]
 
 
@@ -420,44 +439,280 @@ class tildefile(object):
 #
 # =============================================================================
 #
-#                                 Input/Output
+#                            Parsed Document Cache
 #
 # =============================================================================
 #
 
 
-def load_fileobj(fileobj, compress = None, xmldoc = None, contenthandler = ligolw.LIGOLWContentHandler):
+class HashingInputFile(object):
 	"""
-	Parse the contents of the file object fileobj, and return the
-	contents as a LIGO Light Weight document tree.  The file object
-	does not need to be seekable.  The file object must be in binary
-	mode.
+	Read-only file-like wrapper that computes a hash of the data read
+	through it.  Used by DocumentCache to compute the content hash of
+	a file while it is being parsed.
+	"""
+	def __init__(self, fileobj):
+		self.fileobj = fileobj
+		self.hash = DocumentCache.hashfunc()
 
-	The compress parameter selects the decompression algorithm to use.
-	Valid values are:  "auto" to automatically deduce the decompression
-	scheme from the file format;  one of "bz2", "gz", or "xz" to force
-	bzip2, gzip, or lzma/xz decompression, respectively;  False to
-	disable decompression;  or None to select the default behaviour
-	(which is "auto").
+	def read(self, size = -1):
+		buf = self.fileobj.read(size)
+		self.hash.update(buf)
+		return buf
 
-	If the optional xmldoc argument is provided and not None, the
-	parsed XML tree will be appended to that document, otherwise a new
-	document will be created.  The return value is the xmldoc argument
-	or the root of the newly created XML tree.
+	def drain(self, size = 1 << 20):
+		# read and hash the remainder of the file
+		while self.read(size):
+			pass
+		return self.hash.hexdigest()
+
+	def close(self):
+		# the parser closes its input when it is done, but the
+		# remainder of the file is still to be hashed.  the file is
+		# closed by its owner
+		pass
+
+
+class DocumentCache(object):
+	"""
+	Cache of parsed documents, used by load_filename().  The cache is a
+	directory of snapshot files, one for each combination of file name
+	and content handler.  A snapshot holds the document written as XML
+	without the rows of its Tables, and the rows of each Table packed
+	into typed column buffers (see ligo.lw.tokenizer.pack_columns()),
+	aligned so that they are read directly from the memory-mapped
+	snapshot when the document is re-loaded.  The snapshot's header is
+	JSON.  Nothing in a snapshot is unpickled or otherwise executed, so
+	a cache directory shared with other users cannot be used to run
+	code in the jobs that load from it.  Re-loading parses the XML with
+	the content handler used to load the file, then unpacks the rows.
+	Tables with a column whose values cannot be packed into a typed
+	buffer keep their rows in the XML.
+
+	A snapshot records the size, modification time, and a hash of the
+	contents of the file from which it was made, as well as the
+	version of this library and of Python, and the .loadcolumns
+	settings in effect.  It is used only if all of these match, which
+	requires reading the file to compute its hash (this is much faster
+	than parsing it).  Otherwise the file is parsed and the snapshot
+	replaced.  Snapshots are written to a temporary file and renamed
+	into place, so concurrent jobs sharing a cache directory never
+	read incomplete snapshots.  Failures to read or write the cache
+	are not errors:  the document is simply parsed.
+
+	Content handlers are identified by their module and name, or by a
+	.cache_key attribute if they have one.  Content handlers that
+	cannot be identified this way, for example functools.partial()
+	wrappers of PartialLIGOLWContentHandler, are not cached unless the
+	application gives them a .cache_key attribute that describes the
+	filter they apply.  Documents loaded into databases cannot be
+	cached.
 
 	Example:
 
-	>>> from io import BytesIO
-	>>> f = BytesIO(b'<?xml version="1.0" encoding="utf-8" ?><!DOCTYPE LIGO_LW SYSTEM "http://ldas-sw.ligo.caltech.edu/doc/ligolwAPI/html/ligolw_dtd.txt"><LIGO_LW><Table Name="demo:table"><Column Name="name" Type="lstring"/><Column Name="value" Type="real_8"/><Stream Name="demo:table" Type="Local" Delimiter=",">"mass",0.5,"velocity",34</Stream></Table></LIGO_LW>')
-	>>> xmldoc = load_fileobj(f)
+	>>> import shutil, tempfile
+	>>> from ligo.lw import lsctables
+	>>> cachedir = tempfile.mkdtemp()
+	>>> xmldoc = load_filename("inspiral_event_id_test_in1.xml.gz", cache = cachedir)
+	>>> len(os.listdir(cachedir))
+	1
+	>>> xmldoc = load_filename("inspiral_event_id_test_in1.xml.gz", cache = cachedir)
+	>>> len(lsctables.SnglInspiralTable.get_table(xmldoc))
+	4
+	>>> shutil.rmtree(cachedir)
+	"""
+	magic = b"LIGOLWC\x02"
+	alignment = 64
+	hashfunc = hashlib.blake2b
+
+	def __init__(self, directory, verbose = False):
+		self.directory = directory
+		self.verbose = verbose
+
+	@classmethod
+	def align(cls, n):
+		return (n + cls.alignment - 1) // cls.alignment * cls.alignment
+
+	@staticmethod
+	def contenthandler_key(contenthandler):
+		"""
+		Return a string identifying the content handler, or None
+		if it cannot be identified.
+		"""
+		try:
+			return contenthandler.cache_key
+		except AttributeError:
+			pass
+		if isinstance(contenthandler, type) and "<locals>" not in contenthandler.__qualname__:
+			return "%s.%s" % (contenthandler.__module__, contenthandler.__qualname__)
+		return None
 
-	The contenthandler argument specifies the SAX content handler to
-	use when parsing the document.  See the ligo.lw package
-	documentation for an explanation of a typical document parsing
-	scenario and the content handler it uses.  See
-	ligo.lw.ligolw.PartialLIGOLWContentHandler and
-	ligo.lw.ligolw.FilteringLIGOLWContentHandler for examples of custom
-	content handlers used to load subsets of documents into memory.
+	def key(self, filename, contenthandler, compress):
+		"""
+		Return the tuple of metadata that a snapshot of filename
+		must match, less the content hash, and the path of the
+		snapshot.  Returns (None, None) if the content handler
+		cannot be identified.
+		"""
+		handler_key = self.contenthandler_key(contenthandler)
+		if handler_key is None:
+			return None, None
+		filename = os.path.realpath(filename)
+		st = os.stat(filename)
+		loadcolumns = sorted((cls.__module__, cls.__qualname__, tuple(sorted(cls.loadcolumns))) for cls in set(ligolw.Table.TableByName.values()) | set([ligolw.Table]) if cls.loadcolumns is not None)
+		ident = (filename, handler_key, compress, __version__, tuple(sys.version_info[:2]), sys.byteorder, tuple(loadcolumns))
+		path = os.path.join(self.directory, "%s.snapshot" % hashlib.sha256(repr(ident).encode("utf_8")).hexdigest())
+		return ident + (st.st_size, st.st_mtime_ns), path
+
+	@staticmethod
+	def _json(obj):
+		"""
+		obj as it is after being encoded as JSON and decoded again,
+		for comparison with values read from a snapshot's header.
+		"""
+		return json.loads(json.dumps(obj))
+
+	def load(self, path, key, filename, parse):
+		"""
+		Return the document stored in the snapshot at path if it
+		exists and matches key and the content hash of filename,
+		otherwise return None.  parse is a function that parses the
+		document's XML from a binary file object, with the content
+		handler with which the file was loaded.
+		"""
+		try:
+			with open(path, "rb") as f:
+				mm = mmap.mmap(f.fileno(), 0, access = mmap.ACCESS_READ)
+		except (IOError, ValueError):
+			return None
+		buf = memoryview(mm)
+		try:
+			if buf[:len(self.magic)] != self.magic:
+				return None
+			header_length, = struct.unpack_from("<Q", buf, len(self.magic))
+			start = len(self.magic) + 8
+			header = json.loads(bytes(buf[start : start + header_length]).decode("utf-8"))
+			if header["key"] != self._json(key):
+				return None
+			start = self.align(start + header_length)
+			with open(filename, "rb") as f:
+				contenthash = HashingInputFile(f).drain()
+			if header["hash"] != contenthash:
+				return None
+			if self.verbose:
+				sys.stderr.write("using cached snapshot '%s' ...\n" % path)
+			def extent(offset_length):
+				if offset_length is None:
+					return None
+				offset, length = offset_length
+				return buf[start + offset : start + offset + length]
+			xmldoc = parse(io.BytesIO(extent(header["xml"])))
+			tables = xmldoc.getElementsByTagName(ligolw.Table.tagName)
+			for packed in header["tables"]:
+				tbl = tables[packed["index"]]
+				if tbl.columnnames != packed["names"] or len(tbl):
+					raise ValueError("snapshot does not match document")
+				columns = [(code, None if mask is None else bytes(extent(mask)), extent(data), extent(blob)) for code, mask, data, blob in packed["columns"]]
+				tbl.extend(tokenizer.unpack_columns(tbl.RowType, tbl.columnnames, packed["rows"], columns))
+				del columns
+			return xmldoc
+		except Exception as e:
+			if self.verbose:
+				sys.stderr.write("cannot use cached snapshot '%s': %s\n" % (path, e))
+			return None
+		finally:
+			del buf
+			try:
+				mm.close()
+			except BufferError:
+				# something's still using it.  the garbage
+				# collector will take care of it
+				pass
+
+	def store(self, path, key, contenthash, xmldoc):
+		"""
+		Write a snapshot of xmldoc to path.
+		"""
+		try:
+			# pack the rows of the Tables whose columns can all
+			# be packed into typed buffers, and remove them
+			# from the Tables while the XML is written.  the
+			# XML is the first buffer
+			buffers = [None]
+			tables = []
+			removed = []
+			try:
+				for index, tbl in enumerate(xmldoc.getElementsByTagName(ligolw.Table.tagName)):
+					if not len(tbl):
+						continue
+					columns = tokenizer.pack_columns(tbl, tbl.columnnames, "".join(ligolwtypes.ToBufferCode[coltype] for coltype in tbl.columntypes))
+					if any(code == "O" for code, mask, data, blob in columns):
+						continue
+					extents = []
+					for column in columns:
+						extents.append([column[0]])
+						for b in column[1:]:
+							extents[-1].append(None if b is None else len(buffers))
+							if b is not None:
+								buffers.append(b)
+					tables.append({"index": index, "names": tbl.columnnames, "rows": len(tbl), "columns": extents})
+					removed.append((tbl, tbl[:]))
+					del tbl[:]
+				text = io.StringIO()
+				xmldoc.write(text)
+			finally:
+				for tbl, rows in removed:
+					tbl.extend(rows)
+			buffers[0] = text.getvalue().encode("utf-8")
+
+			# locations are relative to the first aligned
+			# offset following the header
+			locations = []
+			offset = 0
+			for b in buffers:
+				offset = self.align(offset)
+				locations.append((offset, len(b)))
+				offset += len(b)
+			for packed in tables:
+				packed["columns"] = [[code] + [None if i is None else locations[i] for i in indexes] for code, *indexes in packed["columns"]]
+			header = json.dumps({"key": key, "hash": contenthash, "xml": locations[0], "tables": tables}).encode("utf-8")
+			start = self.align(len(self.magic) + 8 + len(header))
+
+			os.makedirs(self.directory, exist_ok = True)
+			fd, tmppath = tempfile.mkstemp(dir = self.directory, suffix = ".tmp")
+			try:
+				with os.fdopen(fd, "wb") as f:
+					f.write(self.magic)
+					f.write(struct.pack("<Q", len(header)))
+					f.write(header)
+					for (offset, length), b in zip(locations, buffers):
+						f.seek(start + offset)
+						f.write(b)
+				os.replace(tmppath, path)
+			except:
+				os.unlink(tmppath)
+				raise
+			if self.verbose:
+				sys.stderr.write("wrote cached snapshot '%s'\n" % path)
+		except Exception as e:
+			if self.verbose:
+				sys.stderr.write("cannot write cached snapshot '%s': %s\n" % (path, e))
+
+
+#
+# =============================================================================
+#
+#                                 Input/Output
+#
+# =============================================================================
+#
+
+
+def _decompressor(fileobj, compress):
+	"""
+	Wrap the binary file object fileobj in the decoder for the
+	compression format selected by the compress argument of
+	load_fileobj(), see that function for a description.
 	"""
 	if compress is None:
 		# select default behaviour
@@ -490,19 +745,98 @@ def load_fileobj(fileobj, compress = None, xmldoc = None, contenthandler = ligol
 
 	if compress == False:
 		# pass-through
-		pass
+		return fileobj
 	elif compress == "bz2":
 		# bzip2 decompression
-		fileobj = bz2.BZ2File(fileobj, mode = "rb")
+		return bz2.BZ2File(fileobj, mode = "rb")
 	elif compress == "gz":
 		# gzip decompression
-		fileobj = gzip.GzipFile(mode = "rb", fileobj = fileobj if type(fileobj) == RewindableInputFile else RewindableInputFile(fileobj))
+		return gzip.GzipFile(mode = "rb", fileobj = fileobj if type(fileobj) == RewindableInputFile else RewindableInputFile(fileobj))
 	elif compress == "xz":
 		# xz/lzma decompression
-		fileobj = lzma.LZMAFile(fileobj, mode = "rb")
-	else:
-		# oops
-		raise ValueError("unrecognized compress \"%s\"" % compress)
+		return lzma.LZMAFile(fileobj, mode = "rb")
+	# oops
+	raise ValueError("unrecognized compress \"%s\"" % compress)
+
+
+def _select_tables(tables, contenthandler):
+	"""
+	Return a content handler factory that loads the Tables and columns
+	described by tables, see load_fileobj().
+	"""
+	if contenthandler is not ligolw.LIGOLWContentHandler:
+		raise ValueError("tables cannot be used with a custom content handler")
+	factory = functools.partial(ligolw.TableSelectingLIGOLWContentHandler, tables = tables)
+	# identifies the selection to DocumentCache
+	factory.cache_key = "%s.%s(%s)" % (ligolw.TableSelectingLIGOLWContentHandler.__module__, ligolw.TableSelectingLIGOLWContentHandler.__qualname__, sorted((ligolw.Table.TableName(name), None if columns is None else sorted(map(ligolw.Column.ColumnName, columns))) for name, columns in tables.items()))
+	return factory
+
+
+def load_fileobj(fileobj, compress = None, xmldoc = None, contenthandler = ligolw.LIGOLWContentHandler, tables = None, scratch_dir = None, crc32 = False):
+	"""
+	Parse the contents of the file object fileobj, and return the
+	contents as a LIGO Light Weight document tree.  The file object
+	does not need to be seekable.  The file object must be in binary
+	mode.
+
+	The compress parameter selects the decompression algorithm to use.
+	Valid values are:  "auto" to automatically deduce the decompression
+	scheme from the file format;  one of "bz2", "gz", or "xz" to force
+	bzip2, gzip, or lzma/xz decompression, respectively;  False to
+	disable decompression;  or None to select the default behaviour
+	(which is "auto").
+
+	If the optional xmldoc argument is provided and not None, the
+	parsed XML tree will be appended to that document, otherwise a new
+	document will be created.  The return value is the xmldoc argument
+	or the root of the newly created XML tree.
+
+	Example:
+
+	>>> from io import BytesIO
+	>>> document = b'<?xml version="1.0" encoding="utf-8" ?><!DOCTYPE LIGO_LW SYSTEM "http://ldas-sw.ligo.caltech.edu/doc/ligolwAPI/html/ligolw_dtd.txt"><LIGO_LW><Table Name="demo:table"><Column Name="name" Type="lstring"/><Column Name="value" Type="real_8"/><Stream Name="demo:table" Type="Local" Delimiter=",">"mass",0.5,"velocity",34</Stream></Table></LIGO_LW>'
+	>>> xmldoc = load_fileobj(BytesIO(document))
+
+	The contenthandler argument specifies the SAX content handler to
+	use when parsing the document.  See the ligo.lw package
+	documentation for an explanation of a typical document parsing
+	scenario and the content handler it uses.  See
+	ligo.lw.ligolw.PartialLIGOLWContentHandler and
+	ligo.lw.ligolw.FilteringLIGOLWContentHandler for examples of custom
+	content handlers used to load subsets of documents into memory.
+
+	If tables is not None, it is a dictionary mapping the names of the
+	Tables to be loaded to sequences of the names of the columns to
+	load from each, or to None to load all of a Table's columns.  Other
+	Tables, and all other elements that are not inside the selected
+	Tables, are skipped.  This cannot be combined with the
+	contenthandler argument.  See
+	ligo.lw.ligolw.TableSelectingLIGOLWContentHandler for more
+	information.
+
+	Example:
+
+	>>> xmldoc = load_fileobj(BytesIO(document), tables = {"demo": ["value"]})
+	>>> [row.value for row in ligolw.Table.get_table(xmldoc, "demo")]
+	[0.5, 34.0]
+
+	If scratch_dir is not None, it is the path to a directory in which
+	to create temporary files to hold the contents of the document's
+	Arrays, which are then memory-mapped instead of being loaded into
+	memory.  This allows Arrays larger than the available memory to be
+	loaded.  The files are deleted when they have been mapped, so
+	nothing is left behind in the directory.  The content handler
+	records the directory in each Array element it creates, see
+	ligo.lw.ligolw.Array._scratch_array() for more information.
+
+	If crc32 is True, the CRC-32 checksums of the Streams of the
+	document's Tables and Arrays are computed as they are parsed, so
+	they can be checked with verify_crc32_params().  See
+	ligo.lw.ligolw.Stream for more information.
+	"""
+	if tables is not None:
+		contenthandler = _select_tables(tables, contenthandler)
+	fileobj = _decompressor(fileobj, compress)
 
 	#
 	# parse stream into XML tree and return it
@@ -511,11 +845,16 @@ def load_fileobj(fileobj, compress = None, xmldoc = None, contenthandler = ligol
 	if xmldoc is None:
 		xmldoc = ligolw.Document()
 
-	ligolw.make_parser(contenthandler(xmldoc)).parse(fileobj)
+	handler = contenthandler(xmldoc)
+	if scratch_dir is not None:
+		handler.scratch_dir = scratch_dir
+	if crc32:
+		handler.crc32 = True
+	ligolw.make_parser(handler).parse(fileobj)
 	return xmldoc
 
 
-def load_filename(filename, verbose = False, **kwargs):
+def load_filename(filename, verbose = False, cache = None, **kwargs):
 	"""
 	Parse the contents of the file identified by filename, and return
 	the contents as a LIGO Light Weight document tree.  stdin is parsed
@@ -523,16 +862,55 @@ def load_filename(filename, verbose = False, **kwargs):
 	stderr if verbose is True.  All other keyword arguments are passed
 	to load_fileobj(), see that function for more information.
 
+	If cache is not None it is the path to a directory in which to keep
+	snapshots of parsed documents.  When a file is loaded a snapshot of
+	the document is written to the directory, and subsequent loads of
+	the same, unmodified, file with the same content handler read the
+	snapshot instead of parsing the file.  The directory is created if
+	needed.  See DocumentCache for more information.  Documents loaded
+	with the tables argument of load_fileobj() are cached separately
+	for each selection of tables and columns.
+
 	Example:
 
 	>>> xmldoc = load_filename("demo.xml", verbose = True)
+	>>> xmldoc = load_filename("inspiral_event_id_test_in1.xml.gz", tables = {"sngl_inspiral": ["end_time", "end_time_ns", "snr"]})
 	"""
 	if verbose:
 		sys.stderr.write("reading %s ...\n" % (("'%s'" % filename) if filename is not None else "stdin"))
+	if kwargs.get("tables") is not None:
+		kwargs["contenthandler"] = _select_tables(kwargs.pop("tables"), kwargs.get("contenthandler", ligolw.LIGOLWContentHandler))
 	if filename is None:
 		return load_fileobj(sys.stdin.buffer, **kwargs)
-	with open(filename, "rb") as fileobj:
-		return load_fileobj(fileobj, **kwargs)
+	if cache is not None and kwargs.get("crc32"):
+		# snapshots do not contain the Streams' text
+		if verbose:
+			sys.stderr.write("computing checksums, not using cache\n")
+		cache = None
+	if cache is None:
+		with open(filename, "rb") as fileobj:
+			return load_fileobj(fileobj, **kwargs)
+
+	cache = DocumentCache(cache, verbose = verbose)
+	key, path = cache.key(filename, kwargs.get("contenthandler", ligolw.LIGOLWContentHandler), kwargs.get("compress"))
+	if key is None:
+		if verbose:
+			sys.stderr.write("content handler cannot be identified, not using cache\n")
+		with open(filename, "rb") as fileobj:
+			return load_fileobj(fileobj, **kwargs)
+	xmldoc = cache.load(path, key, filename, lambda fileobj: load_fileobj(fileobj, **dict(kwargs, xmldoc = None, compress = False)))
+	if xmldoc is None:
+		with open(filename, "rb") as fileobj:
+			fileobj = HashingInputFile(fileobj)
+			xmldoc = load_fileobj(fileobj, **dict(kwargs, xmldoc = None))
+			cache.store(path, key, fileobj.drain(), xmldoc)
+	if kwargs.get("xmldoc") is not None:
+		# move the loaded tree into the document that was
+		# provided
+		for child in list(xmldoc.childNodes):
+			kwargs["xmldoc"].appendChild(xmldoc.removeChild(child))
+		xmldoc = kwargs["xmldoc"]
+	return xmldoc
 
 
 def load_url(url, verbose = False, **kwargs):
@@ -567,6 +945,60 @@ def load_url(url, verbose = False, **kwargs):
 	return load_filename(filename, verbose = verbose, **kwargs)
 
 
+def _compress_from_filename(filename, compress):
+	"""
+	Resolve the compression format selected by the compress argument
+	of write_filename(), see that function for a description.
+	"""
+	if compress is None:
+		# select default behaviour
+		compress = "auto"
+	if compress == "auto":
+		if filename is None:
+			# writing to stdout:  no filename = cannot deduce
+			# compression format = turn compression off
+			compress = False
+		elif filename.endswith(".bz2"):
+			compress = "bz2"
+		elif filename.endswith(".gz"):
+			compress = "gz"
+		elif filename.endswith(".xz"):
+			compress = "xz"
+		elif filename.endswith(".zst"):
+			# NOTE:  this format is not supported.  this will
+			# trigger the unrecognized keyword arg exception in
+			# _compressor()
+			compress = "zst"
+		else:
+			# filename scheme not recognized, disable
+			# compression
+			compress = False
+	return compress
+
+
+def _compressor(fileobj, compress, compresslevel):
+	"""
+	Wrap the binary file object fileobj in the encoder for the
+	compression format selected by the compress argument of
+	write_fileobj(), see that function for a description.
+	"""
+	if compress is None:
+		# select default behaviour
+		compress = False
+
+	if compress == False:
+		# no compression
+		return fileobj
+	elif compress == "bz2":
+		return bz2.BZ2File(fileobj, mode = "wb", compresslevel = compresslevel)
+	elif compress == "gz":
+		return gzip.GzipFile(mode = "wb", fileobj = fileobj, compresslevel = compresslevel)
+	elif compress == "xz":
+		return lzma.LZMAFile(fileobj, mode = "wb", format = lzma.FORMAT_XZ)
+	# oops
+	raise ValueError("unrecognized compress \"%s\"" % compress)
+
+
 def write_fileobj(xmldoc, fileobj, compress = None, compresslevel = 3, **kwargs):
 	"""
 	Writes the LIGO Light Weight document tree rooted at xmldoc to the
@@ -588,27 +1020,12 @@ def write_fileobj(xmldoc, fileobj, compress = None, compresslevel = 3, **kwargs)
 	>>> xmldoc = load_filename("demo.xml")
 	>>> write_fileobj(xmldoc, open("/dev/null","wb"))
 	"""
-	if compress is None:
-		# select default behaviour
-		compress = False
-
 	with NoCloseFlushWrapper(fileobj) as fileobj:
 		#
 		# select stream encoder
 		#
 
-		if compress == False:
-			# no compression
-			pass
-		elif compress == "bz2":
-			fileobj = bz2.BZ2File(fileobj, mode = "wb", compresslevel = compresslevel)
-		elif compress == "gz":
-			fileobj = gzip.GzipFile(mode = "wb", fileobj = fileobj, compresslevel = compresslevel)
-		elif compress == "xz":
-			fileobj = lzma.LZMAFile(fileobj, mode = "wb", format = lzma.FORMAT_XZ)
-		else:
-			# oops
-			raise ValueError("unrecognized compress \"%s\"" % compress)
+		fileobj = _compressor(fileobj, compress, compresslevel)
 
 		#
 		# write file
@@ -668,29 +1085,7 @@ def write_filename(xmldoc, filename, verbose = False, compress = None, with_mv =
 	# select format
 	#
 
-	if compress is None:
-		# select default behaviour
-		compress = "auto"
-	if compress == "auto":
-		if filename is None:
-			# writing to stdout:  no filename = cannot deduce
-			# compression format = turn compression off
-			compress = False
-		elif filename.endswith(".bz2"):
-			compress = "bz2"
-		elif filename.endswith(".gz"):
-			compress = "gz"
-		elif filename.endswith(".xz"):
-			compress = "xz"
-		elif filename.endswith(".zst"):
-			# NOTE:  this format is not supported.  this will
-			# trigger the unrecognized keyword arg exception in
-			# write_fileobj()
-			compress = "zst"
-		else:
-			# filename scheme not recognized, disable
-			# compression
-			compress = False
+	compress = _compress_from_filename(filename, compress)
 
 	if verbose:
 		sys.stderr.write("writing %s ...\n" % (("'%s'" % filename) if filename is not None else "stdout"))
@@ -720,3 +1115,777 @@ def write_url(xmldoc, url, **kwargs):
 	>>> write_url(xmldoc, "file:///data.xml.gz", compress = 'gz')	# doctest: +SKIP
 	"""
 	return write_filename(xmldoc, local_path_from_url(url), **kwargs)
+
+
+#
+# =============================================================================
+#
+#                                  Checksums
+#
+# =============================================================================
+#
+
+
+def _next_sibling(elem):
+	"""
+	Return the element following elem in its parent, or None.
+	"""
+	siblings = elem.parentNode.childNodes
+	# compare by identity, Tables compare equal if their rows do
+	i = next(i for i, sibling in enumerate(siblings) if sibling is elem) + 1
+	return siblings[i] if i < len(siblings) else None
+
+
+def _crc32_elements(xmldoc):
+	"""
+	Generator yielding (elem, stream, param) for each Table and Array
+	in xmldoc that has a Stream.  param is the Param following elem in
+	which the Stream's checksum is recorded, or None.
+	"""
+	for elem in xmldoc.getElementsByTagName(ligolw.Table.tagName) + xmldoc.getElementsByTagName(ligolw.Array.tagName):
+		streams = [child for child in elem.childNodes if child.tagName == ligolw.Stream.tagName]
+		if not streams:
+			continue
+		param = _next_sibling(elem)
+		if param is None or param.tagName != ligolw.Param.tagName or param.Name != "%s:crc32" % elem.Name:
+			param = None
+		yield elem, streams[0], param
+
+
+def add_crc32_params(xmldoc):
+	"""
+	Arrange for the CRC-32 checksum of the Stream of each Table and
+	Array in xmldoc to be recorded in the document when it is written.
+	A Param named "<name>:crc32", where <name> is the name of the Table
+	or Array, is placed immediately after it, and is set to the
+	checksum as the Stream is written, before the Param is written.
+	Existing Params are reused.  See ligolw.Stream for the definition
+	of the checksum.  Returns xmldoc.
+
+	Example:
+
+	>>> from io import BytesIO
+	>>> from ligo.lw import lsctables
+	>>> xmldoc = ligolw.Document()
+	>>> tbl = xmldoc.appendChild(ligolw.LIGO_LW()).appendChild(lsctables.SnglBurstTable.new(["event_id", "snr"]))
+	>>> tbl.append(tbl.RowType(event_id = 0, snr = 5.5))
+	>>> xmldoc = add_crc32_params(xmldoc)
+	>>> fileobj = BytesIO()
+	>>> write_fileobj(xmldoc, fileobj)
+	>>> print(ligolw.Param.get_param(xmldoc, "sngl_burst:crc32").value)
+	2146632796
+
+	The checksums are verified with verify_crc32_params(), which needs
+	them to have been computed as the document was parsed.
+
+	>>> verify_crc32_params(load_fileobj(BytesIO(fileobj.getvalue()), crc32 = True))
+	1
+	>>> verify_crc32_params(load_fileobj(BytesIO(fileobj.getvalue().replace(b"5.5", b"5.6")), crc32 = True))
+	Traceback (most recent call last):
+	    ...
+	ValueError: CRC-32 of Stream of 'sngl_burst' is 0x6d46abb2, expected 0x7ff3045c
+	>>> verify_crc32_params(load_fileobj(BytesIO(fileobj.getvalue())))
+	Traceback (most recent call last):
+	    ...
+	ValueError: CRC-32 of Stream of 'sngl_burst' was not computed
+	"""
+	for elem, stream, param in _crc32_elements(xmldoc):
+		if param is None:
+			param = ligolw.Param.build("%s:crc32" % elem.Name, "int_4u", None)
+			sibling = _next_sibling(elem)
+			if sibling is not None:
+				elem.parentNode.insertBefore(param, sibling)
+			else:
+				elem.parentNode.appendChild(param)
+		stream.crc32_param = param
+	return xmldoc
+
+
+def verify_crc32_params(xmldoc):
+	"""
+	Compare the CRC-32 checksums of the Streams of the Tables and
+	Arrays in xmldoc, computed when the document was parsed, with those
+	recorded in it by add_crc32_params().  The document must have been
+	loaded with the crc32 argument of load_fileobj() set to True.
+	Raises ValueError if a checksum does not match or was not
+	computed.  Returns the number of checksums verified.
+	"""
+	n = 0
+	for elem, stream, param in _crc32_elements(xmldoc):
+		if param is None or param.value is None:
+			continue
+		if stream.crc32 is None:
+			raise ValueError("CRC-32 of Stream of '%s' was not computed" % elem.Name)
+		if stream.crc32 != param.value:
+			raise ValueError("CRC-32 of Stream of '%s' is 0x%08x, expected 0x%08x" % (elem.Name, stream.crc32, param.value))
+		n += 1
+	return n
+
+
+#
+# =============================================================================
+#
+#                               Streaming Output
+#
+# =============================================================================
+#
+
+
+def _row_sequence(rows, columnnames):
+	"""
+	If rows is a mapping of column name to a sequence of values for
+	that column, return an iterable of tuples of the values in the
+	order of columnnames, otherwise return rows.
+	"""
+	if hasattr(rows, "keys"):
+		# mapping of column name to column values.  .tolist()
+		# converts numpy arrays to lists of native Python objects
+		columns = [rows[name] for name in columnnames]
+		rows = zip(*(column.tolist() if hasattr(column, "tolist") else column for column in columns))
+	return rows
+
+
+class DocumentWriter(object):
+	"""
+	Write a document to a file while the rows of some of its Tables
+	are supplied incrementally, so that the rows need never all be held
+	in memory.  xmldoc is the document tree to write, and tables is a
+	sequence of Table elements in that tree whose rows will be supplied
+	through the .write_rows() method.  The rest of the document is
+	written as-is.  filename, verbose, compress and with_mv have the
+	same meanings as for write_filename(), and compresslevel and
+	xsl_file are passed along as for write_fileobj().  Signals are not
+	trapped by default (a streaming write can take an arbitrarily long
+	time, and the signals would be deferred for all of it), but see
+	write_filename() for a description of trap_signals.
+
+	The document is written in order.  The writer must be used as a
+	context manager:  on entry the document is written up to and
+	including the start of the first streamed Table's Stream, and on
+	successful exit the remainder of the document is written and the
+	file closed (and, if with_mv is True, moved into place).  If the
+	context is left due to an exception, the document is not completed,
+	and with with_mv the target file is not modified.
+
+	Rows are supplied with .write_rows(tbl, rows).  rows is an
+	iterable of row objects, an iterable of tuples of column values in
+	the order of the Table's columns, or a mapping of column name to a
+	sequence (e.g., a numpy array) of values for that column.  The rows
+	are formatted and passed to the compressor immediately.  Each call
+	can supply rows for the current Table or for one that follows it in
+	the document, in which case the current Table's Stream is
+	completed and the document is written up to the start of the new
+	Table's Stream.  It is not possible to go back to an earlier Table.
+	Rows already in a streamed Table are written before any supplied
+	with .write_rows(), and a streamed Table is not modified.
+
+	Example:
+
+	>>> import os, tempfile
+	>>> from ligo.lw import lsctables
+	>>> xmldoc = ligolw.Document()
+	>>> tbl = xmldoc.appendChild(ligolw.LIGO_LW()).appendChild(lsctables.SnglBurstTable.new(["event_id", "ifo", "snr"]))
+	>>> with tempfile.TemporaryDirectory() as tmpdir:
+	...	filename = os.path.join(tmpdir, "demo.xml.gz")
+	...	with DocumentWriter(xmldoc, filename, [tbl]) as writer:
+	...		writer.write_rows(tbl, [(0, "H1", 5.5), (1, None, 6.5)])
+	...		writer.write_rows(tbl, {"event_id": [2], "ifo": ["V1"], "snr": [7.5]})
+	...	copy = lsctables.SnglBurstTable.get_table(load_filename(filename))
+	...
+	>>> [(row.event_id, row.ifo, row.snr) for row in copy]
+	[(0, 'H1', 5.5), (1, None, 6.5), (2, 'V1', 7.5)]
+	>>> len(tbl)
+	0
+	"""
+	def __init__(self, xmldoc, filename, tables, verbose = False, compress = None, compresslevel = 3, with_mv = True, trap_signals = None, xsl_file = None):
+		self.xmldoc = xmldoc
+		self.filename = filename
+		self.tables = list(tables)
+		self.verbose = verbose
+		self.compress = _compress_from_filename(filename, compress)
+		self.compresslevel = compresslevel
+		self.with_mv = with_mv
+		self.trap_signals = trap_signals
+		self.xsl_file = xsl_file
+
+		#
+		# the elements that contain streamed Tables.  these are
+		# the only ones whose writing must be done here, the rest
+		# are written by their own .write() methods
+		#
+
+		self._ancestors = set()
+		for tbl in self.tables:
+			elem = tbl.parentNode
+			while elem is not None and elem is not xmldoc:
+				self._ancestors.add(id(elem))
+				elem = elem.parentNode
+			if elem is None:
+				raise ValueError("%s is not in the document" % tbl.Name)
+		self._streamed = set(id(tbl) for tbl in self.tables)
+
+		self.fileobj = None
+		self.current = None
+
+	def __enter__(self):
+		if self.verbose:
+			sys.stderr.write("writing %s ...\n" % (("'%s'" % self.filename) if self.filename is not None else "stdout"))
+		self._stack = contextlib.ExitStack()
+		try:
+			self._stack.enter_context(SignalsTrap(self.trap_signals))
+			if self.filename is None:
+				fileobj = sys.stdout.buffer
+			elif self.with_mv:
+				fileobj = self._stack.enter_context(tildefile(self.filename))
+			else:
+				fileobj = self._stack.enter_context(open(self.filename, "wb"))
+			fileobj = self._stack.enter_context(NoCloseFlushWrapper(fileobj))
+			fileobj = self._stack.enter_context(_compressor(fileobj, self.compress, self.compresslevel))
+			self.fileobj = self._stack.enter_context(codecs.getwriter("utf_8")(fileobj))
+
+			#
+			# write up to the first streamed Table
+			#
+
+			self._writer = self._write_document()
+			self._advance()
+		except:
+			self._stack.__exit__(*sys.exc_info())
+			raise
+		return self
+
+	def __exit__(self, exc_type, exc_val, exc_tb):
+		try:
+			if exc_type is None:
+				# write the rest of the document
+				for _ in self._writer:
+					pass
+			else:
+				self._writer.close()
+		except:
+			if not self._stack.__exit__(*sys.exc_info()):
+				raise
+		else:
+			self._stack.__exit__(exc_type, exc_val, exc_tb)
+		finally:
+			del self._writer
+			self.fileobj = None
+			self.current = None
+		return False
+
+	def _advance(self):
+		"""
+		Write the document up to the start of the next streamed
+		Table's Stream, and make that Table the current Table.
+		"""
+		try:
+			self.current = next(self._writer)
+		except StopIteration:
+			self.current = None
+
+	def write_rows(self, tbl, rows):
+		"""
+		Write rows to the Stream of tbl, which must be the current
+		Table or one that follows it in the document.  See the
+		class documentation for the forms rows can take.
+		"""
+		if self.fileobj is None:
+			raise ValueError("DocumentWriter is not open")
+		if id(tbl) not in self._streamed:
+			raise ValueError("%s is not a streamed Table" % tbl.Name)
+		while self.current is not tbl:
+			if self.current is None:
+				raise ValueError("%s has already been completed" % tbl.Name)
+			self._advance()
+		self._write_rows(_row_sequence(rows, tbl.columnnames))
+
+	def write_text(self, tbl, fileobj, null_last = False):
+		"""
+		Copy rows that have already been formatted from the
+		text-mode file object fileobj to the Stream of tbl, which
+		must be the current Table or one that follows it in the
+		document.  The text must be the rows as formatted by a
+		tokenizer.RowDumper for the Table's columns and its
+		Stream's delimiter, XML-escaped, with each row but the
+		first preceded by the delimiter, a line break and the
+		indentation of the Stream's rows (see .row_newline()), and
+		null_last must be True if the last token of the last row
+		is null.  The text is copied as-is.
+		"""
+		if self.fileobj is None:
+			raise ValueError("DocumentWriter is not open")
+		if id(tbl) not in self._streamed:
+			raise ValueError("%s is not a streamed Table" % tbl.Name)
+		while self.current is not tbl:
+			if self.current is None:
+				raise ValueError("%s has already been completed" % tbl.Name)
+			self._advance()
+		data = fileobj.read(1 << 20)
+		if not data:
+			return
+		w = self._stream_write
+		w(self._rowdumper.delimiter + self._newline if self._started else self._newline)
+		while data:
+			w(data)
+			data = fileobj.read(1 << 20)
+		self._started = True
+		self._null_last = null_last
+
+	@staticmethod
+	def row_newline(tbl):
+		"""
+		Return the line break and indentation that precede each of
+		the rows of tbl when it is written.
+		"""
+		depth = 0
+		elem = tbl.parentNode
+		while elem.parentNode is not None:
+			depth += 1
+			elem = elem.parentNode
+		return "\n" + ligolw.Indent * (depth + 2)
+
+	def _write_rows(self, rows):
+		w = self._stream_write
+		rowdumper = self._rowdumper
+		rowdumper.dump(rows)
+		rows_converted = rowdumper.rows_converted
+		if not self._started:
+			try:
+				line = next(rowdumper)
+			except StopIteration:
+				return
+			w(self._newline)
+			w(xmlescape(line))
+			self._started = True
+		newline = rowdumper.delimiter + self._newline
+		for line in rowdumper:
+			w(newline)
+			w(xmlescape(line))
+		if rowdumper.rows_converted != rows_converted:
+			self._null_last = rowdumper.tokens[-1] == ""
+
+	def _write_document(self):
+		w = self.fileobj.write
+		w(ligolw.Header)
+		w("\n")
+		if self.xsl_file is not None:
+			w('<?xml-stylesheet type="text/xsl" href="%s" ?>\n' % self.xsl_file)
+		for c in self.xmldoc.childNodes:
+			if c.tagName not in self.xmldoc.validchildren:
+				raise ligolw.ElementError("invalid child %s for %s" % (c.tagName, self.xmldoc.tagName))
+			yield from self._write_element(c, "")
+
+	def _write_element(self, elem, indent):
+		"""
+		Generator that writes elem like its .write() method, and
+		yields each streamed Table when its Stream is ready to
+		receive rows.  See ligolw.Element.write().
+		"""
+		if id(elem) not in self._ancestors and id(elem) not in self._streamed:
+			elem.write(self.fileobj, indent)
+			return
+		w = self.fileobj.write
+		w(elem.start_tag(indent))
+		w("\n")
+		for c in elem.childNodes:
+			if c.tagName not in elem.validchildren:
+				raise ligolw.ElementError("invalid child %s for %s" % (c.tagName, elem.tagName))
+			if id(elem) in self._streamed and c.tagName == ligolw.Stream.tagName:
+				yield from self._write_stream(c, indent + ligolw.Indent)
+			else:
+				yield from self._write_element(c, indent + ligolw.Indent)
+		if elem.pcdata is not None:
+			w(xmlescape(elem.pcdata))
+			w("\n")
+		w(elem.end_tag(indent))
+		w("\n")
+
+	def _write_stream(self, stream, indent):
+		"""
+		Generator that writes a streamed Table's Stream, yielding
+		the Table while rows are being supplied.  See
+		ligolw.Table.Stream.write().
+		"""
+		tbl = stream.parentNode
+		w = self.fileobj.write
+		w(stream.start_tag(indent))
+		self._stream_write = stream.crc32_write(w)
+		self._rowdumper = tokenizer.RowDumper(tbl.columnnames, [ligolwtypes.FormatFunc[coltype] for coltype in tbl.columntypes], stream.Delimiter)
+		self._newline = "\n" + indent + ligolw.Indent
+		self._started = False
+		self._null_last = False
+		self._write_rows(tbl)
+		yield tbl
+		if self._started and self._null_last:
+			# the last token of the last row was null:  add a
+			# final delimiter to indicate that a token is
+			# present
+			self._stream_write(self._rowdumper.delimiter)
+		self._stream_write("\n" + indent)
+		stream.crc32_done()
+		w(stream.end_tag("") + "\n")
+		del self._rowdumper
+		del self._stream_write
+
+
+#
+# =============================================================================
+#
+#                                  Appending
+#
+# =============================================================================
+#
+
+
+#
+# the end of the rows of a Table.  offset is the position in the file
+# at which the rows end, tail is the document text that follows them,
+# and separator is what must precede the next row:  the delimiter, or
+# nothing if the Table is empty or its Stream ends with a delimiter.
+#
+
+
+#
+# .head is text to write at .offset before the rows, used to open a Stream
+# element that was written as an empty-element tag
+#
+
+
+_AppendPoint = collections.namedtuple("_AppendPoint", ("offset", "tail", "columnnames", "columntypes", "delimiter", "indent", "separator", "head"), defaults = ("",))
+
+
+class _StreamFound(Exception):
+	pass
+
+
+def _find_append_point(mm, table_name):
+	"""
+	Locate the end of the rows of the Table named table_name in the
+	uncompressed document in the buffer mm.  The document is parsed
+	up to the start of the Table's Stream, the Stream's end tag is
+	found by searching forward from there.  If the Stream is an
+	empty-element tag, "<Stream .../>", the returned point replaces it
+	with a start tag and an end tag.
+	"""
+	current = []
+
+	def start_element(name, attrs):
+		if name == ligolw.Table.tagName:
+			current[:] = [attrs.get("Name"), []]
+		elif name == ligolw.Column.tagName and current:
+			current[1].append((attrs["Name"], attrs["Type"]))
+		elif name == ligolw.Stream.tagName and current and current[0] is not None and ligolw.Table.TableName(current[0]) == table_name:
+			raise _StreamFound(parser.CurrentByteIndex, current[1], attrs.get("Delimiter", ligolw.Table.Stream.Delimiter.default))
+
+	def end_element(name):
+		if name == ligolw.Table.tagName:
+			del current[:]
+
+	parser = xml.parsers.expat.ParserCreate()
+	parser.StartElementHandler = start_element
+	parser.EndElementHandler = end_element
+	try:
+		for i in range(0, len(mm), 1 << 20):
+			parser.Parse(mm[i : i + (1 << 20)], False)
+	except _StreamFound as found:
+		start, columns, delimiter = found.args
+	else:
+		raise ValueError("document does not contain a Table named '%s'" % table_name)
+
+	tag_start = start
+	start = mm.find(b">", start) + 1
+	if mm[start - 2 : start - 1] == b"/":
+		# empty Stream element.  rewrite it from the "/>"
+		indent = mm[mm.rfind(b"\n", 0, tag_start) + 1 : tag_start].decode("utf-8")
+		if not indent.isspace():
+			indent = ""
+		return _AppendPoint(
+			offset = start - 2,
+			tail = ("\n" + indent + "</" + ligolw.Stream.tagName + ">").encode("utf-8") + bytes(mm[start:]),
+			columnnames = [ligolw.Column.ColumnName(name) for name, coltype in columns],
+			columntypes = [coltype for name, coltype in columns],
+			delimiter = delimiter,
+			indent = indent + ligolw.Indent,
+			separator = "",
+			head = ">"
+		)
+	end = mm.find(b"</" + ligolw.Stream.tagName.encode() + b">", start)
+	if end < 0:
+		raise ValueError("Stream of Table '%s' is not complete" % table_name)
+	offset = end
+	while offset > start and mm[offset - 1 : offset].isspace():
+		offset -= 1
+	indent = mm[mm.rfind(b"\n", start, end) + 1 : end].decode("utf-8")
+	if not indent.isspace():
+		indent = ""
+	return _AppendPoint(
+		offset = offset,
+		tail = bytes(mm[offset:]),
+		columnnames = [ligolw.Column.ColumnName(name) for name, coltype in columns],
+		columntypes = [coltype for name, coltype in columns],
+		delimiter = delimiter,
+		indent = indent + ligolw.Indent,
+		separator = "" if offset == start or mm[offset - 1 : offset] == delimiter.encode("utf-8") else delimiter
+	)
+
+
+def _format_rows(rows, point):
+	"""
+	Format rows for insertion at point.  Returns the text and the
+	separator that must precede the row after them.
+	"""
+	rowdumper = tokenizer.RowDumper(point.columnnames, [ligolwtypes.FormatFunc[coltype] for coltype in point.columntypes], point.delimiter)
+	rowdumper.dump(_row_sequence(rows, point.columnnames))
+	newline = "\n" + point.indent
+	separator = point.separator
+	text = []
+	for line in rowdumper:
+		text += [separator, newline, xmlescape(line)]
+		separator = point.delimiter
+	if text and rowdumper.tokens and rowdumper.tokens[-1] == "":
+		# the last token of the last row was null:  add a final
+		# delimiter to indicate that a token is present.  it also
+		# separates the row from the next one
+		text.append(point.delimiter)
+		separator = ""
+	return "".join(text), separator
+
+
+#
+# gzip-compressed documents are appended to by cutting the file at the
+# start of the gzip member containing the tail, and adding a member for
+# the new rows and a new member for the tail.  the tail member's FEXTRA
+# header field records the _AppendPoint, without .offset and .tail.
+# documents not ending in such a member are converted on the first
+# append.
+#
+
+
+_GZIP_SUBFIELD_ID = b"LW"
+
+
+def _gzip_member(data, compresslevel, index = None):
+	"""
+	Return data compressed as a gzip member.  If index is not None it
+	is recorded in the member's FEXTRA header field.
+	"""
+	if index is None:
+		compressor = zlib.compressobj(compresslevel, zlib.DEFLATED, 16 + zlib.MAX_WBITS)
+		return compressor.compress(data) + compressor.flush()
+	index = json.dumps(index).encode("utf-8")
+	extra = _GZIP_SUBFIELD_ID + struct.pack("<H", len(index)) + index
+	if len(extra) > 0xffff:
+		raise ValueError("Table description is too large for the gzip header")
+	compressor = zlib.compressobj(compresslevel, zlib.DEFLATED, -zlib.MAX_WBITS)
+	# magic, CM = deflate, FLG = FEXTRA, MTIME = 0, XFL = 0, OS =
+	# unknown
+	return b"".join((b"\x1f\x8b\x08\x04\x00\x00\x00\x00\x00\xff", struct.pack("<H", len(extra)), extra, compressor.compress(data), compressor.flush(), struct.pack("<II", zlib.crc32(data), len(data) & 0xffffffff)))
+
+
+def _gzip_index(point, table_name, separator):
+	"""
+	The index recorded in the final gzip member for appending rows
+	at point.
+	"""
+	return dict(name = table_name, columnnames = point.columnnames, columntypes = point.columntypes, delimiter = point.delimiter, indent = point.indent, separator = separator)
+
+
+def _find_gzip_append_point(mm, table_name):
+	"""
+	Locate the end of the rows of the Table named table_name in the
+	gzip-compressed document in the buffer mm from the index in its
+	last member.  Returns None if the document does not end in a
+	member with an index for that Table.
+	"""
+	pos = len(mm)
+	while True:
+		pos = mm.rfind(b"\x1f\x8b\x08\x04", 0, pos)
+		if pos < 0:
+			return None
+		xlen, = struct.unpack("<H", mm[pos + 10 : pos + 12])
+		extra = mm[pos + 12 : pos + 12 + xlen]
+		if extra[:2] != _GZIP_SUBFIELD_ID:
+			continue
+		decompressor = zlib.decompressobj(16 + zlib.MAX_WBITS)
+		try:
+			tail = decompressor.decompress(mm[pos:])
+		except zlib.error:
+			continue
+		if decompressor.eof and not decompressor.unused_data:
+			break
+	size, = struct.unpack("<H", extra[2:4])
+	index = json.loads(extra[4 : 4 + size].decode("utf-8"))
+	if index["name"] != table_name:
+		return None
+	del index["name"]
+	return _AppendPoint(offset = pos, tail = tail, **index)
+
+
+def _rewrite_tail(filename, offset, old, new):
+	"""
+	Replace the bytes old at offset to the end of the file with new.
+	The old bytes are first recorded in a journal, from which
+	_recover_append() can restore the file if the process is
+	interrupted.
+	"""
+	journal = filename + "-journal"
+	with tildefile(journal) as fileobj:
+		fileobj.write(struct.pack("<QQ", offset, len(old)))
+		fileobj.write(old)
+		fileobj.flush()
+		os.fsync(fileobj.fileno())
+	with open(filename, "r+b") as fileobj:
+		fileobj.seek(offset)
+		fileobj.write(new)
+		fileobj.truncate()
+		fileobj.flush()
+		os.fsync(fileobj.fileno())
+	os.remove(journal)
+
+
+def _recover_append(filename, verbose = False):
+	"""
+	If an append to filename was interrupted, restore the file from
+	the journal.  An incomplete journal was not finished before the
+	file was modified, and is discarded.
+	"""
+	journal = filename + "-journal"
+	if not os.path.exists(journal):
+		return
+	with open(journal, "rb") as fileobj:
+		header = fileobj.read(16)
+		old = fileobj.read()
+	if len(header) == 16 and struct.unpack("<QQ", header)[1] == len(old):
+		if verbose:
+			sys.stderr.write("restoring '%s' from interrupted append ...\n" % filename)
+		with open(filename, "r+b") as fileobj:
+			fileobj.seek(struct.unpack("<QQ", header)[0])
+			fileobj.write(old)
+			fileobj.truncate()
+			fileobj.flush()
+			os.fsync(fileobj.fileno())
+	os.remove(journal)
+
+
+def append_rows(filename, table_name, rows, verbose = False, compresslevel = 3, trap_signals = SignalsTrap.default_signals):
+	"""
+	Add rows to the end of the Table named table_name in the document
+	in the file filename, without rewriting the rest of the file.  rows
+	is an iterable of row objects, an iterable of tuples of column
+	values in the order of the Table's columns in the file, or a
+	mapping of column name to a sequence of values for that column.
+	The document must be uncompressed or gzip-compressed, and the Table
+	must have a Stream (if it is the first Table of that name that
+	does).
+
+	For an uncompressed document the file is parsed up to the start of
+	the Table's Stream, the end of the Stream is found with a byte
+	search, and the file is rewritten from the end of the Table's rows.
+	The cost is proportional to the number of new rows and to the size
+	of the document after the Table, and does not depend on the number
+	of rows already in the Table.  It is fastest when the Table is the
+	last in the document.
+
+	A gzip-compressed document is modified by replacing its final gzip
+	member, which holds the text following the Table's rows and records
+	where the rows end, with a member containing the new rows and a new
+	final member.  The file remains a valid gzip file, and the cost is
+	again independent of the size of the document.  The first append to
+	a file not written this way, or to a different Table than the
+	previous append, decompresses the document and rewrites the file.
+	compresslevel is the gzip compression level of the new members.
+
+	The part of the file being replaced is first saved in a journal, in
+	the file filename + "-journal".  If an append is interrupted, the
+	next append restores the file from the journal first.  Until then,
+	the document must not be read.  Signals are trapped while the file
+	is modified, see write_filename() for a description of
+	trap_signals.  Checksums recorded with add_crc32_params() are not
+	updated.
+
+	Example:
+
+	>>> import os, tempfile
+	>>> from ligo.lw import lsctables
+	>>> xmldoc = ligolw.Document()
+	>>> tbl = xmldoc.appendChild(ligolw.LIGO_LW()).appendChild(lsctables.SnglBurstTable.new(["event_id", "snr", "ifo"]))
+	>>> tbl.append(tbl.RowType(event_id = 0, snr = 5.5, ifo = "H1"))
+	>>> with tempfile.TemporaryDirectory() as tmpdir:
+	...	for name in ("demo.xml", "demo.xml.gz"):
+	...		filename = os.path.join(tmpdir, name)
+	...		write_filename(xmldoc, filename)
+	...		append_rows(filename, "sngl_burst", [(1, 6.5, None)])
+	...		append_rows(filename, "sngl_burst", {"event_id": [2, 3], "snr": [7.5, 8.5], "ifo": ["L1", "V1"]})
+	...		copy = lsctables.SnglBurstTable.get_table(load_filename(filename))
+	...		print([(row.event_id, row.snr, row.ifo) for row in copy])
+	...
+	[(0, 5.5, 'H1'), (1, 6.5, None), (2, 7.5, 'L1'), (3, 8.5, 'V1')]
+	[(0, 5.5, 'H1'), (1, 6.5, None), (2, 7.5, 'L1'), (3, 8.5, 'V1')]
+
+	A Stream written as an empty-element tag is replaced with a start
+	tag and an end tag:
+
+	>>> with tempfile.TemporaryDirectory() as tmpdir:
+	...	filename = os.path.join(tmpdir, "demo.xml")
+	...	with open(filename, "w") as fileobj:
+	...		n = fileobj.write('<?xml version="1.0"?><LIGO_LW><Table Name="process:table"><Column Name="program" Type="lstring"/><Stream Name="process:table" Type="Local" Delimiter=","/></Table><Table Name="sngl_burst:table"><Column Name="snr" Type="real_4"/><Stream Name="sngl_burst:table" Type="Local" Delimiter=",">5.5</Stream></Table></LIGO_LW>')
+	...	append_rows(filename, "process", [("x",)])
+	...	copy = load_filename(filename)
+	...	print([row.program for row in lsctables.ProcessTable.get_table(copy)], [row.snr for row in lsctables.SnglBurstTable.get_table(copy)])
+	...
+	['x'] [5.5]
+	"""
+	table_name = ligolw.Table.TableName(table_name)
+	_recover_append(filename, verbose = verbose)
+	if verbose:
+		sys.stderr.write("appending to '%s' in '%s' ...\n" % (table_name, filename))
+
+	with open(filename, "rb") as fileobj:
+		with mmap.mmap(fileobj.fileno(), 0, access = mmap.ACCESS_READ) as mm:
+			magic = mm[:6]
+			if magic[:2] == b"\x1F\x8B":
+				point = _find_gzip_append_point(mm, table_name)
+				compressed = True
+			elif magic[:3] == b"\x42\x5A\x68" or magic[:6] == b"\xFD\x37\x7A\x58\x5A\x00" or magic[:4] == b"\x28\xB5\x2F\xFD":
+				raise ValueError("cannot append to '%s':  only uncompressed and gzip-compressed documents are supported" % filename)
+			else:
+				point = _find_append_point(mm, table_name)
+				compressed = False
+			old = bytes(mm[point.offset:]) if point is not None else None
+
+	if compressed and point is None:
+		#
+		# convert:  decompress the document, and write it as one
+		# member holding the text up to the end of the Table's rows
+		# and one holding the rest.  the appended rows are then
+		# treated as for any other compressed document
+		#
+
+		if verbose:
+			sys.stderr.write("rewriting '%s' for appending ...\n" % filename)
+		with tempfile.TemporaryFile() as scratch:
+			with gzip.open(filename, "rb") as fileobj:
+				shutil.copyfileobj(fileobj, scratch)
+			scratch.flush()
+			with mmap.mmap(scratch.fileno(), 0, access = mmap.ACCESS_READ) as mm:
+				point = _find_append_point(mm, table_name)
+				with SignalsTrap(trap_signals), tildefile(filename) as fileobj:
+					compressor = zlib.compressobj(compresslevel, zlib.DEFLATED, 16 + zlib.MAX_WBITS)
+					for i in range(0, point.offset, 1 << 20):
+						fileobj.write(compressor.compress(mm[i : min(i + (1 << 20), point.offset)]))
+					fileobj.write(compressor.compress(point.head.encode("utf-8")))
+					fileobj.write(compressor.flush())
+					offset = fileobj.tell()
+					old = _gzip_member(point.tail, compresslevel, _gzip_index(point, table_name, point.separator))
+					fileobj.write(old)
+		point = point._replace(offset = offset, head = "")
+
+	text, separator = _format_rows(rows, point)
+	text = (point.head + text).encode("utf-8")
+	if compressed:
+		new = (_gzip_member(text, compresslevel) if text else b"") + _gzip_member(point.tail, compresslevel, _gzip_index(point, table_name, separator))
+	else:
+		new = text + point.tail
+
+	with SignalsTrap(trap_signals):
+		_rewrite_tail(filename, point.offset, old, new)
@@ -0,0 +1,776 @@
+# Copyright (C) 2026  Kipp Cannon
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#
+# =============================================================================
+#
+#                                   Preamble
+#
+# =============================================================================
+#
+
+
+"""
+Convert Tables to and from the Apache Arrow IPC file format (also known
+as Feather version 2), for exchanging tabular data with pandas, polars,
+pyarrow and other Arrow-based tools.
+
+The conversion does not require pyarrow.  The column values are packed
+into typed buffers by the tokenizer module's pack_columns() function and
+written directly, and when reading, the buffers are unpacked into row
+objects by unpack_columns(), so no Python code is run per-row.
+
+LIGO Light Weight integer and floating-point types are converted to Arrow
+integer and floating-point types of the same width, complex types to
+fixed-size lists of two floating-point numbers (real and imaginary parts),
+string types to Arrow large UTF-8 strings and blob types to Arrow large
+binary values.  None is converted to null and vice versa.  The table name
+and the LIGO Light Weight type of each column are recorded in the Arrow
+schema's metadata so a Table read back from the file is the same as the
+original, except that real_4 and complex_8 values are the single
+precision values that were written.  Files written by other tools can be
+read provided they contain only types that have LIGO Light Weight
+equivalents and are not compressed;  in that case the column types are
+chosen from the Arrow types, and the table name must be provided if it is
+not in the file's metadata.  Dictionary-encoded columns, which pandas
+and pyarrow write for categorical data, are decoded.
+
+Example:
+
+>>> import io
+>>> from ligo.lw import lsctables
+>>> from ligo.lw.utils import arrow
+>>> tbl = lsctables.SnglBurstTable.new(["event_id", "ifo", "snr"])
+>>> for i, ifo in enumerate(("H1", "L1", None)):
+...	tbl.append(tbl.RowType(event_id = i, ifo = ifo, snr = 5. + i))
+...
+>>> fileobj = io.BytesIO()
+>>> arrow.write_table(tbl, fileobj)
+>>> fileobj.seek(0)
+0
+>>> copy = arrow.read_table(fileobj)
+>>> copy.Name
+'sngl_burst'
+>>> [(row.event_id, row.ifo, row.snr) for row in copy]
+[(0, 'H1', 5.0), (1, 'L1', 6.0), (2, None, 7.0)]
+"""
+
+
+import numpy
+import struct
+import sys
+from xml.sax.xmlreader import AttributesImpl
+
+
+from .. import __author__, __date__, __version__
+from .. import ligolw
+from .. import tokenizer
+from .. import types as ligolwtypes
+
+
+__all__ = ["write_table", "read_table"]
+
+
+#
+# =============================================================================
+#
+#                                 FlatBuffers
+#
+# =============================================================================
+#
+
+
+#
+# Arrow's metadata is encoded with Google's FlatBuffers serialization
+# library.  The subset needed here is implemented below.  All offsets and
+# scalars are little-endian.  An object that refers to other objects is
+# written before them, because references (32-bit unsigned offsets) must
+# point towards the end of the buffer.
+#
+
+
+class _Builder(object):
+	"""
+	Construct a FlatBuffers buffer.  A table is described by a
+	sequence, indexed by field number, of None for absent fields,
+	(format, value) pairs for scalars where format is a struct module
+	format character, or ("ref", writer) pairs for strings, tables and
+	vectors where writer is a function that takes the _Builder as its
+	argument, writes the object and returns its position.
+	"""
+	def __init__(self):
+		# space for the offset to the root table
+		self.buf = bytearray(4)
+
+	def pad(self, alignment, extra = 0):
+		"""
+		Pad the buffer so that len(buf) + extra is a multiple of
+		alignment.
+		"""
+		self.buf.extend(bytes(-(len(self.buf) + extra) % alignment))
+
+	def finish(self, fields):
+		struct.pack_into("<I", self.buf, 0, self.table(fields))
+		self.pad(8)
+		return bytes(self.buf)
+
+	def table(self, fields):
+		# assign positions within the table, after the offset to
+		# the vtable, placing larger scalars first so they are
+		# aligned
+		def width(i):
+			fmt = fields[i][0]
+			return struct.calcsize("<" + ("I" if fmt == "ref" else fmt))
+		layout = {}
+		size = 4
+		for i in sorted((i for i, field in enumerate(fields) if field is not None), key = lambda i: -width(i)):
+			size += -size % width(i)
+			layout[i] = size
+			size += width(i)
+		# vtable, then the table aligned to 8 bytes
+		self.pad(2)
+		vtable = len(self.buf)
+		self.buf.extend(struct.pack("<HH%dH" % len(fields), 4 + 2 * len(fields), size, *(layout.get(i, 0) for i in range(len(fields)))))
+		self.pad(8)
+		pos = len(self.buf)
+		self.buf.extend(bytes(size))
+		struct.pack_into("<i", self.buf, pos, pos - vtable)
+		refs = []
+		for i, offset in layout.items():
+			fmt, value = fields[i]
+			if fmt == "ref":
+				refs.append((pos + offset, value))
+			else:
+				struct.pack_into("<" + fmt, self.buf, pos + offset, value)
+		for at, writer in refs:
+			self.patch(at, writer(self))
+		return pos
+
+	def patch(self, at, target):
+		struct.pack_into("<I", self.buf, at, target - at)
+
+
+def _ref(writer):
+	return ("ref", writer)
+
+
+def _string(s):
+	def writer(builder):
+		b = s.encode("utf-8")
+		builder.pad(4)
+		pos = len(builder.buf)
+		builder.buf.extend(struct.pack("<I", len(b)) + b + b"\0")
+		return pos
+	return _ref(writer)
+
+
+def _table(fields):
+	return _ref(lambda builder: builder.table(fields))
+
+
+def _tables(tables):
+	def writer(builder):
+		builder.pad(4)
+		pos = len(builder.buf)
+		builder.buf.extend(struct.pack("<I", len(tables)) + bytes(4 * len(tables)))
+		for i, fields in enumerate(tables):
+			builder.patch(pos + 4 + 4 * i, builder.table(fields))
+		return pos
+	return _ref(writer)
+
+
+def _structs(fmt, values):
+	def writer(builder):
+		# the elements are aligned to 8 bytes
+		builder.pad(8, 4)
+		pos = len(builder.buf)
+		builder.buf.extend(struct.pack("<I", len(values)))
+		for value in values:
+			builder.buf.extend(struct.pack("<" + fmt, *value))
+		return pos
+	return _ref(writer)
+
+
+class _Table(object):
+	"""
+	Read access to a table in a FlatBuffers buffer.
+	"""
+	def __init__(self, buf, pos):
+		self.buf = buf
+		self.pos = pos
+		vtable = pos - struct.unpack_from("<i", buf, pos)[0]
+		vtable_size, = struct.unpack_from("<H", buf, vtable)
+		self.offsets = struct.unpack_from("<%dH" % ((vtable_size - 4) // 2), buf, vtable + 4)
+
+	@classmethod
+	def root(cls, buf, pos = 0):
+		return cls(buf, pos + struct.unpack_from("<I", buf, pos)[0])
+
+	def _field(self, i):
+		return self.offsets[i] if i < len(self.offsets) else 0
+
+	def _deref(self, i):
+		offset = self._field(i)
+		if not offset:
+			return None
+		at = self.pos + offset
+		return at + struct.unpack_from("<I", self.buf, at)[0]
+
+	def scalar(self, i, fmt, default = 0):
+		offset = self._field(i)
+		return struct.unpack_from("<" + fmt, self.buf, self.pos + offset)[0] if offset else default
+
+	def table(self, i):
+		pos = self._deref(i)
+		return _Table(self.buf, pos) if pos is not None else None
+
+	def string(self, i):
+		pos = self._deref(i)
+		if pos is None:
+			return None
+		n, = struct.unpack_from("<I", self.buf, pos)
+		return bytes(self.buf[pos + 4 : pos + 4 + n]).decode("utf-8")
+
+	def tables(self, i):
+		pos = self._deref(i)
+		if pos is None:
+			return []
+		n, = struct.unpack_from("<I", self.buf, pos)
+		return [_Table.root(self.buf, pos + 4 + 4 * j) for j in range(n)]
+
+	def structs(self, i, fmt):
+		pos = self._deref(i)
+		if pos is None:
+			return []
+		n, = struct.unpack_from("<I", self.buf, pos)
+		return list(struct.iter_unpack("<" + fmt, self.buf[pos + 4 : pos + 4 + n * struct.calcsize("<" + fmt)]))
+
+
+#
+# =============================================================================
+#
+#                                Arrow Metadata
+#
+# =============================================================================
+#
+
+
+#
+# Arrow format constants (see Schema.fbs, Message.fbs and File.fbs in the
+# Arrow source)
+#
+
+
+MAGIC = b"ARROW1"
+CONTINUATION = 0xffffffff
+METADATA_V5 = 4
+
+ENDIANNESS = {"little": 0, "big": 1}
+
+TYPE_INT = 2
+TYPE_FLOATINGPOINT = 3
+TYPE_BINARY = 4
+TYPE_UTF8 = 5
+TYPE_FIXEDSIZELIST = 16
+TYPE_LARGEBINARY = 19
+TYPE_LARGEUTF8 = 20
+
+PRECISION = {numpy.dtype("float16"): 0, numpy.dtype("float32"): 1, numpy.dtype("float64"): 2}
+
+HEADER_SCHEMA = 1
+HEADER_DICTIONARYBATCH = 2
+HEADER_RECORDBATCH = 3
+
+# struct formats of Block, FieldNode and Buffer
+BLOCK = "qi4xq"
+FIELDNODE = "qq"
+BUFFER = "qq"
+
+#
+# keys used in the custom metadata
+#
+
+TABLE_KEY = "ligolw:table"
+TYPE_KEY = "ligolw:type"
+
+
+def _metadata(d):
+	return _tables([[_string(key), _string(value)] for key, value in sorted(d.items())])
+
+
+def _read_metadata(table, i):
+	return dict((kv.string(0), kv.string(1)) for kv in table.tables(i))
+
+
+#
+# Arrow type and LIGO Light Weight type equivalents
+#
+
+
+def _arrow_type(coltype):
+	"""
+	Return the Arrow type number and the FlatBuffers table describing
+	the Arrow type equivalent to a LIGO Light Weight type, and the
+	children of the Arrow field.
+	"""
+	code = ligolwtypes.ToBufferCode[coltype]
+	if code == "u":
+		return TYPE_LARGEUTF8, [], []
+	if code == "y":
+		return TYPE_LARGEBINARY, [], []
+	dtype = numpy.dtype(ligolwtypes.ToNumPyType[coltype])
+	if code == "D":
+		item = [_string("item"), ("?", False), ("B", TYPE_FLOATINGPOINT), _table([("h", PRECISION[numpy.dtype("float%d" % (dtype.itemsize * 4))])]), None, _tables([])]
+		return TYPE_FIXEDSIZELIST, [("i", 2)], [item]
+	if code == "d":
+		return TYPE_FLOATINGPOINT, [("h", PRECISION[dtype])], []
+	return TYPE_INT, [("i", dtype.itemsize * 8), ("?", dtype.kind == "i")], []
+
+
+def _ligolw_type(arrow_type, type_table, children):
+	"""
+	Choose the LIGO Light Weight type for an Arrow field written by
+	another tool.
+	"""
+	if arrow_type == TYPE_INT:
+		bits, signed = type_table.scalar(0, "i"), type_table.scalar(1, "?")
+		return "int_%d%s" % (max(bits // 8, 2), "s" if signed else "u")
+	if arrow_type == TYPE_FLOATINGPOINT:
+		return "real_8" if type_table.scalar(0, "h") == PRECISION[numpy.dtype("float64")] else "real_4"
+	if arrow_type in (TYPE_UTF8, TYPE_LARGEUTF8):
+		return "lstring"
+	if arrow_type in (TYPE_BINARY, TYPE_LARGEBINARY):
+		return "blob"
+	if arrow_type == TYPE_FIXEDSIZELIST and type_table.scalar(0, "i") == 2 and len(children) == 1 and children[0].scalar(2, "B") == TYPE_FLOATINGPOINT:
+		return "complex_16" if children[0].table(3).scalar(0, "h") == PRECISION[numpy.dtype("float64")] else "complex_8"
+	raise ValueError("unsupported Arrow type %d" % arrow_type)
+
+
+#
+# =============================================================================
+#
+#                                    Output
+#
+# =============================================================================
+#
+
+
+def _validity(mask, n):
+	"""
+	Convert a pack_columns() mask to an Arrow validity bitmap, and
+	return the bitmap and the null count.
+	"""
+	if mask is None:
+		return b"", 0
+	null = numpy.frombuffer(mask, dtype = "uint8") != 0
+	return numpy.packbits(~null, bitorder = "little").tobytes(), int(null.sum())
+
+
+def _column(colname, coltype, column, n):
+	"""
+	Convert a packed column to a list of (length, null count) field
+	nodes and a list of buffers in Arrow's layout.
+	"""
+	code, mask, data, blob = column
+	if code == "O":
+		raise ValueError("column '%s' contains values that cannot be converted" % colname)
+	validity, null_count = _validity(mask, n)
+	if code in "uy":
+		return [(n, null_count)], [validity, data, blob]
+	array = numpy.frombuffer(data, dtype = {"q": "int64", "Q": "uint64", "d": "float64", "D": "complex128"}[code])
+	dtype = numpy.dtype(ligolwtypes.ToNumPyType[coltype])
+	converted = array.astype(dtype)
+	if code in "qQ" and (converted != array).any():
+		# null values are packed as 0 so they compare equal
+		raise ValueError("column '%s' contains values that are out of range for type %s" % (colname, coltype))
+	if code == "D":
+		return [(n, null_count), (2 * n, 0)], [validity, b"", converted.view(converted.real.dtype).tobytes()]
+	return [(n, null_count)], [validity, converted.tobytes()]
+
+
+def _write_message(fileobj, header_type, header, body_length):
+	"""
+	Write an encapsulated message's metadata, and return the length of
+	the metadata including its prefix.
+	"""
+	metadata = _Builder().finish([("h", METADATA_V5), ("B", header_type), _table(header), ("q", body_length)])
+	fileobj.write(struct.pack("<Ii", CONTINUATION, len(metadata)))
+	fileobj.write(metadata)
+	return 8 + len(metadata)
+
+
+def write_table(tbl, fileobj):
+	"""
+	Write the contents of the Table tbl to the binary file object
+	fileobj (or to the file named fileobj if it is a string) in the
+	Arrow IPC file format.  The file object need not be seekable.
+	ValueError is raised if a column contains a value that cannot be
+	represented by the column's type.
+
+	Numeric values are written with the width of their column's type,
+	so real_4 values are rounded to single precision as they are when
+	a document is written.
+	"""
+	if isinstance(fileobj, str):
+		with open(fileobj, "wb") as f:
+			return write_table(tbl, f)
+
+	names = tbl.columnnames
+	n = len(tbl)
+	columns = tokenizer.pack_columns(tbl, names, "".join(ligolwtypes.ToBufferCode[coltype] for coltype in tbl.columntypes))
+
+	#
+	# schema
+	#
+
+	fields = []
+	nodes = []
+	buffers = []
+	for colname, coltype, column in zip(names, tbl.columntypes, columns):
+		arrow_type, type_fields, children = _arrow_type(coltype)
+		fields.append([_string(colname), ("?", True), ("B", arrow_type), _table(type_fields), None, _tables(children), _metadata({TYPE_KEY: coltype})])
+		column_nodes, column_buffers = _column(colname, coltype, column, n)
+		nodes.extend(column_nodes)
+		buffers.extend(column_buffers)
+	schema = [("h", ENDIANNESS[sys.byteorder]), _tables(fields), _metadata({TABLE_KEY: tbl.Name})]
+
+	#
+	# body layout.  buffers are aligned to 8 bytes
+	#
+
+	extents = []
+	body_length = 0
+	for buf in buffers:
+		extents.append((body_length, len(buf)))
+		body_length += len(buf) + -len(buf) % 8
+
+	#
+	# write the file:  magic, schema message, record batch message
+	# and body, end-of-stream marker, footer, magic
+	#
+
+	fileobj.write(MAGIC + b"\0\0")
+	offset = 8
+	offset += _write_message(fileobj, HEADER_SCHEMA, schema, 0)
+	block = (offset, _write_message(fileobj, HEADER_RECORDBATCH, [("q", n), _structs(FIELDNODE, nodes), _structs(BUFFER, extents)], body_length), body_length)
+	for buf in buffers:
+		fileobj.write(buf)
+		fileobj.write(bytes(-len(buf) % 8))
+	fileobj.write(struct.pack("<Ii", CONTINUATION, 0))
+	footer = _Builder().finish([("h", METADATA_V5), _table(schema), _structs(BLOCK, []), _structs(BLOCK, [block])])
+	fileobj.write(footer)
+	fileobj.write(struct.pack("<i", len(footer)))
+	fileobj.write(MAGIC)
+
+
+#
+# =============================================================================
+#
+#                                    Input
+#
+# =============================================================================
+#
+
+
+def _to_float64(array):
+	"""
+	Convert an array of floating-point values to double precision.
+	Lower precision values keep their exact binary value (e.g.,
+	0.10000000149011612 for 0.1 in single precision), which is written
+	to a document as the same decimal number as the original.
+	"""
+	return array.astype("float64")
+
+
+#
+# dictionary-encoded columns
+#
+
+
+NUMPY_CODE = {"q": "int64", "Q": "uint64", "d": "float64", "D": "complex128"}
+
+
+def _column_length(column):
+	"""
+	Return the number of values in a packed column.
+	"""
+	code, mask, data, blob = column
+	if code in "uy":
+		return len(data) // 8 - 1
+	return len(data) // numpy.dtype(NUMPY_CODE[code]).itemsize
+
+
+def _column_null(column):
+	"""
+	Return a boolean array that is True where a packed column's values
+	are null.
+	"""
+	code, mask, data, blob = column
+	if mask is None:
+		return numpy.zeros(_column_length(column), dtype = "bool")
+	return numpy.frombuffer(mask, dtype = "uint8") != 0
+
+
+def _concatenate(a, b):
+	"""
+	Append the values of packed column b to those of packed column a,
+	as a dictionary delta batch does, and return the packed column.
+	"""
+	code, mask, data, blob = a
+	if b[0] != code:
+		raise ValueError("dictionary delta batch changes the value type")
+	if mask is not None or b[1] is not None:
+		mask = numpy.concatenate((_column_null(a), _column_null(b))).astype("uint8").tobytes()
+	if code in "uy":
+		offsets = numpy.frombuffer(b[2], dtype = "int64")
+		return code, mask, data + (offsets[1:] - offsets[0] + numpy.frombuffer(data, dtype = "int64")[-1]).tobytes(), bytes(blob) + bytes(b[3][offsets[0]:offsets[-1]])
+	return code, mask, bytes(data) + bytes(b[2]), None
+
+
+def _take(dictionary, indices, null):
+	"""
+	Return the packed column of the values of the packed column
+	dictionary at indices.  null is a boolean array that is True where
+	the index is null, and those indices are ignored.
+	"""
+	code, mask, data, blob = dictionary
+	size = _column_length(dictionary)
+	indices = numpy.where(null, 0, indices).astype("int64")
+	if (~null & ((indices < 0) | (indices >= size))).any():
+		raise ValueError("dictionary index out of range")
+	if size:
+		null = null | _column_null(dictionary)[indices]
+	mask = null.astype("uint8").tobytes() if null.any() else None
+	if code in "uy":
+		if not size:
+			return code, mask, bytes(8 * (len(indices) + 1)), b""
+		offsets = numpy.frombuffer(data, dtype = "int64")
+		starts = offsets[:-1][indices]
+		lengths = numpy.where(null, 0, offsets[1:][indices] - starts)
+		new_offsets = numpy.zeros(len(indices) + 1, dtype = "int64")
+		numpy.cumsum(lengths, out = new_offsets[1:])
+		# position in the dictionary's blob of each byte of the
+		# result
+		gather = numpy.repeat(starts - new_offsets[:-1], lengths) + numpy.arange(new_offsets[-1])
+		return code, mask, new_offsets.tobytes(), numpy.frombuffer(blob, dtype = "uint8")[gather].tobytes()
+	if not size:
+		return code, mask, numpy.zeros(len(indices), dtype = NUMPY_CODE[code]).tobytes(), None
+	return code, mask, numpy.frombuffer(data, dtype = NUMPY_CODE[code])[indices].tobytes(), None
+
+
+#
+# record batches
+#
+
+
+def _validity_mask(validity, n, null_count):
+	"""
+	Convert an Arrow validity bitmap to a pack_columns() mask.
+	"""
+	if null_count and len(validity):
+		return (numpy.unpackbits(numpy.frombuffer(validity, dtype = "uint8"), count = n, bitorder = "little") == 0).astype("uint8").tobytes()
+	return None
+
+
+def _read_column(field, nodes, buffers, body, byteorder, dictionaries):
+	"""
+	Convert the next Arrow field of a record batch to a packed column.
+	nodes and buffers are iterators over the record batch's field
+	nodes and buffers.  dictionaries maps dictionary IDs to the packed
+	columns of the values of dictionary-encoded fields, or is None to
+	read the values of a dictionary, which have the field's type but
+	are not themselves dictionary-encoded.
+	"""
+	def buf(offset, length):
+		return body[offset : offset + length]
+
+	n, null_count = next(nodes)
+	validity = buf(*next(buffers))
+	mask = _validity_mask(validity, n, null_count)
+
+	encoding = field.table(4) if dictionaries is not None else None
+	if encoding is not None:
+		# the field's values are indices into a dictionary whose
+		# values have the field's type.  the index type defaults
+		# to 32-bit signed integers
+		index_type = encoding.table(1)
+		bits, signed = (index_type.scalar(0, "i"), index_type.scalar(1, "?")) if index_type is not None else (32, True)
+		indices = numpy.frombuffer(buf(*next(buffers)), dtype = numpy.dtype("%s%d" % ("i" if signed else "u", bits // 8)).newbyteorder(byteorder), count = n)
+		try:
+			dictionary = dictionaries[encoding.scalar(0, "q")]
+		except KeyError:
+			raise ValueError("column '%s' refers to a missing dictionary" % field.string(0))
+		null = numpy.frombuffer(mask, dtype = "uint8") != 0 if mask is not None else numpy.zeros(n, dtype = "bool")
+		return _take(dictionary, indices, null)
+
+	arrow_type = field.scalar(2, "B")
+	type_table = field.table(3)
+	if arrow_type == TYPE_INT:
+		bits, signed = type_table.scalar(0, "i"), type_table.scalar(1, "?")
+		array = numpy.frombuffer(buf(*next(buffers)), dtype = numpy.dtype("%s%d" % ("i" if signed else "u", bits // 8)).newbyteorder(byteorder), count = n)
+		if signed or bits < 64:
+			return ("q", mask, array.astype("int64").tobytes(), None)
+		return ("Q", mask, array.astype("uint64").tobytes(), None)
+	if arrow_type == TYPE_FLOATINGPOINT:
+		dtype = dict((precision, dtype) for dtype, precision in PRECISION.items())[type_table.scalar(0, "h")]
+		array = numpy.frombuffer(buf(*next(buffers)), dtype = dtype.newbyteorder(byteorder), count = n)
+		return ("d", mask, _to_float64(array).tobytes(), None)
+	if arrow_type in (TYPE_UTF8, TYPE_LARGEUTF8, TYPE_BINARY, TYPE_LARGEBINARY):
+		offsets = numpy.frombuffer(buf(*next(buffers)), dtype = numpy.dtype("i8" if arrow_type in (TYPE_LARGEUTF8, TYPE_LARGEBINARY) else "i4").newbyteorder(byteorder), count = n + 1)
+		return ("u" if arrow_type in (TYPE_UTF8, TYPE_LARGEUTF8) else "y", mask, offsets.astype("int64").tobytes(), buf(*next(buffers)))
+	if arrow_type == TYPE_FIXEDSIZELIST:
+		child, = field.tables(5)
+		if child.table(4) is not None:
+			raise ValueError("column '%s' has dictionary-encoded list items, which are not supported" % field.string(0))
+		dtype = dict((precision, dtype) for dtype, precision in PRECISION.items())[child.table(3).scalar(0, "h")]
+		next(nodes)
+		next(buffers)
+		array = numpy.frombuffer(buf(*next(buffers)), dtype = dtype.newbyteorder(byteorder), count = 2 * n)
+		return ("D", mask, _to_float64(array).tobytes(), None)
+	raise ValueError("unsupported Arrow type %d" % arrow_type)
+
+
+def _read_message(buf, block, header_type):
+	"""
+	Return the header of the encapsulated message of the given type
+	described by a footer Block, and the message's body.
+	"""
+	offset, metadata_length, body_length = block
+	if struct.unpack_from("<I", buf, offset)[0] == CONTINUATION:
+		message = _Table.root(buf, offset + 8)
+	else:
+		# pre-1.0 format without the continuation marker
+		message = _Table.root(buf, offset + 4)
+	if message.scalar(1, "B") != header_type:
+		raise ValueError("unsupported Arrow message type %d" % message.scalar(1, "B"))
+	return message.table(2), buf[offset + metadata_length : offset + metadata_length + body_length]
+
+
+def _read_batch(batch, body, fields, byteorder, dictionaries):
+	"""
+	Convert a record batch to a list of packed columns, and return the
+	number of rows and the list.
+	"""
+	if batch.table(3) is not None:
+		raise ValueError("compressed Arrow files are not supported")
+	nodes = iter(batch.structs(1, FIELDNODE))
+	buffers = iter(batch.structs(2, BUFFER))
+	return batch.scalar(0, "q"), [_read_column(field, nodes, buffers, body, byteorder, dictionaries) for field in fields]
+
+
+def read_table(fileobj, name = None):
+	"""
+	Read a Table from the binary file object fileobj (or from the file
+	named fileobj if it is a string) containing data in the Arrow IPC
+	file format, and return it.  The file object must contain only
+	the Arrow file, and need not be seekable.  If the file does not
+	record the table's name, name must be provided.  If the name is
+	that of a Table subclass known to ligo.lw.Table.TableByName (e.g.,
+	one of the tables in ligo.lw.lsctables), the return value is an
+	instance of that class.  The Table has not been appended to a
+	document.
+
+	Files written by write_table() reproduce the original Table.  For
+	other files, the column types are chosen based on the Arrow types.
+	ValueError is raised if a column's Arrow type has no LIGO Light
+	Weight equivalent or the file uses compression.
+
+	Example:
+
+	pyarrow_test_input.arrow was written by pyarrow.  It contains two
+	record batches, and its ifo column is dictionary-encoded with
+	8-bit indices.
+
+	>>> tbl = read_table("pyarrow_test_input.arrow", name = "sngl_burst")
+	>>> list(zip(tbl.columnnames, tbl.columntypes))
+	[('event_id', 'int_8s'), ('ifo', 'lstring'), ('channel', 'lstring'), ('snr', 'real_4'), ('peak_time', 'int_4s')]
+	>>> for row in tbl:
+	...	print(row.event_id, row.ifo, row.channel, row.snr, row.peak_time)
+	...
+	0 H1 LSC-STRAIN_0 5.5 1000000000
+	1 L1 LSC-STRAIN_1 6.25 1000000001
+	2 None None 7.0 1000000002
+	3 V1 LSC-STRAIN_2 8.125 1000000003
+	4 H1 LSC-STRAIN_0 9.0 1000000004
+	"""
+	if isinstance(fileobj, str):
+		with open(fileobj, "rb") as f:
+			return read_table(f, name = name)
+
+	buf = memoryview(fileobj.read())
+	if bytes(buf[:len(MAGIC)]) != MAGIC or bytes(buf[-len(MAGIC):]) != MAGIC:
+		raise ValueError("not an Arrow IPC file")
+	footer_length, = struct.unpack_from("<i", buf, len(buf) - len(MAGIC) - 4)
+	footer = _Table.root(buf, len(buf) - len(MAGIC) - 4 - footer_length)
+
+	#
+	# schema
+	#
+
+	schema = footer.table(1)
+	byteorder = "<" if schema.scalar(0, "h") == ENDIANNESS["little"] else ">"
+	fields = schema.tables(1)
+	name = _read_metadata(schema, 2).get(TABLE_KEY, name)
+	if name is None:
+		raise ValueError("table name not recorded in file, and not provided")
+	names = tuple(field.string(0) for field in fields)
+	types = [_read_metadata(field, 6).get(TYPE_KEY) or _ligolw_type(field.scalar(2, "B"), field.table(3), field.tables(5)) for field in fields]
+
+	#
+	# build the Table.  copied from dbtables.get_xml()
+	#
+
+	tbl = ligolw.Table(AttributesImpl({"Name": ligolw.Table.TableName.enc(name)}))
+	destrip = {}
+	if tbl.validcolumns is not None:
+		for colname in tbl.validcolumns:
+			destrip[ligolw.Column.ColumnName(colname)] = colname
+	for colname, coltype in zip(names, types):
+		colname = destrip.get(colname, colname)
+		tbl.appendChild(ligolw.Column(AttributesImpl({"Name": colname, "Type": coltype})))
+	tbl._end_of_columns()
+	tbl.appendChild(tbl.Stream(AttributesImpl({"Name": tbl.getAttribute("Name"), "Delimiter": tbl.Stream.Delimiter.default, "Type": tbl.Stream.Type.default})))
+	attributes = tuple(tbl.columnnames)
+
+	#
+	# dictionaries.  a delta batch appends to the dictionary with
+	# its ID
+	#
+
+	dictionary_fields = dict((field.table(4).scalar(0, "q"), field) for field in fields if field.table(4) is not None)
+	dictionaries = {}
+	for block in footer.structs(2, BLOCK):
+		dictionary_batch, body = _read_message(buf, block, HEADER_DICTIONARYBATCH)
+		id = dictionary_batch.scalar(0, "q")
+		try:
+			field = dictionary_fields[id]
+		except KeyError:
+			raise ValueError("dictionary %d is not used by any field" % id)
+		n, (column,) = _read_batch(dictionary_batch.table(1), body, [field], byteorder, None)
+		if dictionary_batch.scalar(2, "?") and id in dictionaries:
+			column = _concatenate(dictionaries[id], column)
+		dictionaries[id] = column
+
+	#
+	# record batches
+	#
+
+	for block in footer.structs(3, BLOCK):
+		n, columns = _read_batch(*_read_message(buf, block, HEADER_RECORDBATCH), fields, byteorder, dictionaries)
+		tbl.extend(tokenizer.unpack_columns(tbl.RowType, attributes, n, columns))
+
+	return tbl
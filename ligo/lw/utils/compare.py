@@ -0,0 +1,456 @@
+# Copyright (C) 2026  Kipp Cannon
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#
+# =============================================================================
+#
+#                                   Preamble
+#
+# =============================================================================
+#
+
+
+"""
+Compare the contents of two LIGO Light Weight XML documents, for example
+to validate a program's output against a reference.
+
+The two documents are parsed in step, and the rows of each pair of Tables
+are compared as they are parsed and then discarded, so the memory required
+is independent of the size of the documents.  The rows are compared a
+block at a time, column-by-column, with the values packed into arrays by
+the tokenizer module's pack_columns() function, so no Python code is run
+per-row unless there are differences to report.  Floating-point values
+can be allowed to differ by a number of units in the last place (ULPs),
+set separately for each column type.  Single-precision values are
+compared in single precision.
+
+Tables are paired by their position in the documents, and rows by their
+position in the Tables.  Columns are paired by name.  Params and Arrays
+are also compared.
+
+Example:
+
+>>> import io
+>>> import sys
+>>> from ligo.lw import ligolw
+>>> from ligo.lw import lsctables
+>>> from ligo.lw import utils as ligolw_utils
+>>> from ligo.lw.utils import compare
+>>> def make_document(snrs):
+...	xmldoc = ligolw.Document()
+...	tbl = xmldoc.appendChild(ligolw.LIGO_LW()).appendChild(lsctables.SnglBurstTable.new(["event_id", "ifo", "snr"]))
+...	for i, snr in enumerate(snrs):
+...		tbl.append(tbl.RowType(event_id = i, ifo = "H1", snr = snr))
+...	fileobj = io.BytesIO()
+...	ligolw_utils.write_fileobj(xmldoc, fileobj)
+...	fileobj.seek(0)
+...	return fileobj
+...
+>>> result = compare.compare_fileobjs(make_document([5., 6., 7.]), make_document([5., 6.000001, 7.]))
+>>> result.identical
+False
+>>> result.report(sys.stdout)	# doctest: +NORMALIZE_WHITESPACE
+table 'sngl_burst':  3 rows, 3 rows:  1 differences
+	row 1, column 'snr':  6.0 != 6.000001
+>>> result = compare.compare_fileobjs(make_document([5., 6., 7.]), make_document([5., 6.000001, 7.]), ulps = {"real_4": 16})
+>>> result.identical
+True
+
+Integer values are compared exactly.
+
+>>> def make_param_document(value):
+...	xmldoc = ligolw.Document()
+...	xmldoc.appendChild(ligolw.LIGO_LW()).appendChild(ligolw.Param.build("count", "int_8u", value))
+...	fileobj = io.BytesIO()
+...	ligolw_utils.write_fileobj(xmldoc, fileobj)
+...	fileobj.seek(0)
+...	return fileobj
+...
+>>> compare.compare_fileobjs(make_param_document(2**64 - 1), make_param_document(2**64 - 2)).report(sys.stdout)
+Param 'count' values differ:  18446744073709551615 != 18446744073709551614
+"""
+
+
+import collections
+import numpy
+import sys
+
+
+from .. import __author__, __date__, __version__
+from .. import ligolw
+from .. import tokenizer
+from .. import types as ligolwtypes
+from . import _decompressor
+
+
+__all__ = ["Difference", "TableComparison", "Comparison", "compare_fileobjs", "compare_filenames"]
+
+
+#
+# =============================================================================
+#
+#                              Value Comparison
+#
+# =============================================================================
+#
+
+
+def _ordered(values):
+	"""
+	Map an array of IEEE floating-point numbers to unsigned integers
+	with the same ordering.  The difference between two of the
+	integers is the number of representable floating-point numbers
+	between the two values.
+	"""
+	bits = values.view("uint%d" % (8 * values.itemsize))
+	sign = bits.dtype.type(1 << (8 * values.itemsize - 1))
+	return numpy.where(bits & sign, ~bits, bits | sign)
+
+
+def _close(a, b, ulps):
+	"""
+	Return a boolean array that is True where the floating-point
+	arrays a and b are equal to within ulps units in the last place.
+	NaNs are equal to each other.
+	"""
+	equal = (a == b) | (numpy.isnan(a) & numpy.isnan(b))
+	if ulps:
+		a, b = _ordered(a), _ordered(b)
+		equal |= numpy.where(a > b, a - b, b - a) <= ulps
+	return equal
+
+
+def _differ(coltype, a, b, ulps):
+	"""
+	Return a boolean array that is True where the arrays of values a
+	and b, which are of LIGO Light Weight type coltype, differ.  Values
+	of floating-point types are converted to the precision of the type
+	and compared to within the number of ULPs given for the type in the
+	dictionary ulps.
+	"""
+	if coltype in ligolwtypes.FloatTypes | ligolwtypes.ComplexTypes:
+		dtype = numpy.dtype(ligolwtypes.ToNumPyType[coltype])
+		if dtype.kind == "c":
+			dtype = numpy.dtype("float%d" % (4 * dtype.itemsize))
+			a, b = a.view("float64").reshape(-1, 2), b.view("float64").reshape(-1, 2)
+		close = _close(a.astype(dtype), b.astype(dtype), ulps.get(coltype, 0))
+		return ~close.reshape(len(close), -1).all(axis = 1)
+	return a != b
+
+
+#
+# =============================================================================
+#
+#                                   Results
+#
+# =============================================================================
+#
+
+
+Difference = collections.namedtuple("Difference", ("row", "column", "a", "b"))
+Difference.__doc__ = """
+A difference between the values in a column of a row of two Tables.  row
+is the index of the row, column is the name of the column, and a and b
+are the two values.
+"""
+
+
+class TableComparison(object):
+	"""
+	The result of comparing a pair of Tables.  .name is the name of
+	the Table, .rows is a tuple of the numbers of rows in the two
+	Tables, .count is the number of differing values, and .differences
+	is a list of Difference objects for the first of them (see
+	compare_fileobjs()).  .messages is a list of strings describing
+	structural differences, like missing columns.  If one of the
+	documents does not have the Table, the number of its rows is None.
+	"""
+	def __init__(self, a, b, ulps, max_differences):
+		self.name = (a if a is not None else b).Name
+		self.rows = [0 if a is not None else None, 0 if b is not None else None]
+		self.count = 0
+		self.differences = []
+		self.messages = []
+		self.ulps = ulps
+		self.max_differences = max_differences
+		self.columns = None
+
+	@property
+	def identical(self):
+		return not self.count and not self.messages and self.rows[0] == self.rows[1]
+
+	def _setup(self, a, b):
+		"""
+		Pair the columns of the Tables a and b.  Called once their
+		Column elements have been parsed.
+		"""
+		if a.Name != b.Name:
+			self.messages.append("table names differ:  '%s' != '%s'" % (a.Name, b.Name))
+		for name in a.columnnames:
+			if name not in b.columnnames:
+				self.messages.append("column '%s' only in first document" % name)
+		for name in b.columnnames:
+			if name not in a.columnnames:
+				self.messages.append("column '%s' only in second document" % name)
+		self.columns = []
+		for name, coltype in zip(a.columnnames, a.columntypes):
+			if name not in b.columnnames:
+				continue
+			other = b.getColumnByName(name).Type
+			if other != coltype:
+				self.messages.append("column '%s' types differ:  '%s' != '%s'" % (name, coltype, other))
+				continue
+			self.columns.append((name, coltype))
+
+	def compare(self, a, b, n):
+		"""
+		Compare the first n rows of the lists of rows a and b.
+		"""
+		if self.columns is None:
+			self._setup(a, b)
+		a, b = a[:n], b[:n]
+		names = [name for name, coltype in self.columns]
+		codes = "".join(ligolwtypes.ToBufferCode[coltype] for name, coltype in self.columns)
+		remaining = self.max_differences - len(self.differences)
+		found = []
+		for k, ((name, coltype), (code, mask_a, data_a, blob_a), (code_b, mask_b, data_b, blob_b)) in enumerate(zip(self.columns, tokenizer.pack_columns(a, names, codes), tokenizer.pack_columns(b, names, codes))):
+			if code in "uy" and code_b == code and mask_a == mask_b and data_a == data_b and blob_a == blob_b:
+				continue
+			if code in "uyO" or code_b != code:
+				# strings, blobs, and values that cannot
+				# be packed are compared in Python
+				indexes = [i for i, (x, y) in enumerate(zip(a, b)) if getattr(x, name, None) != getattr(y, name, None)]
+			else:
+				mask_a = numpy.frombuffer(mask_a, dtype = "uint8") if mask_a is not None else numpy.zeros(n, dtype = "uint8")
+				mask_b = numpy.frombuffer(mask_b, dtype = "uint8") if mask_b is not None else numpy.zeros(n, dtype = "uint8")
+				dtype = {"q": "int64", "Q": "uint64", "d": "float64", "D": "complex128"}[code]
+				differ = _differ(coltype, numpy.frombuffer(data_a, dtype = dtype), numpy.frombuffer(data_b, dtype = dtype), self.ulps)
+				indexes = numpy.flatnonzero((mask_a != mask_b) | (differ & (mask_a == 0))).tolist()
+			self.count += len(indexes)
+			found.extend((i, k, name) for i in indexes[:remaining])
+		# record the first differences in row order
+		for i, k, name in sorted(found)[:remaining]:
+			self.differences.append(Difference(self.rows[0] + i, name, getattr(a[i], name, None), getattr(b[i], name, None)))
+		self.rows[0] += n
+		self.rows[1] += n
+
+	def report(self, fileobj = sys.stdout):
+		"""
+		Write a description of the differences to fileobj.
+		"""
+		print("table '%s':  %s rows, %s rows:  %d differences" % (self.name, self.rows[0], self.rows[1], self.count), file = fileobj)
+		for message in self.messages:
+			print("\t%s" % message, file = fileobj)
+		for difference in self.differences:
+			print("\trow %d, column '%s':  %r != %r" % difference, file = fileobj)
+
+
+class Comparison(object):
+	"""
+	The result of comparing two documents.  .tables is a list of
+	TableComparison objects, one for each pair of Tables, and .messages
+	is a list of strings describing other differences.
+	"""
+	def __init__(self):
+		self.tables = []
+		self.messages = []
+
+	@property
+	def identical(self):
+		return not self.messages and all(table.identical for table in self.tables)
+
+	def report(self, fileobj = sys.stdout):
+		"""
+		Write a description of the differences to fileobj.  Tables
+		that are identical are not reported.
+		"""
+		for message in self.messages:
+			print(message, file = fileobj)
+		for table in self.tables:
+			if not table.identical:
+				table.report(fileobj)
+
+
+#
+# =============================================================================
+#
+#                                  Comparison
+#
+# =============================================================================
+#
+
+
+class _Reader(object):
+	"""
+	Parse a document incrementally.  Each call to .feed() parses the
+	next block of the file.
+	"""
+	chunk_size = 1 << 20
+
+	def __init__(self, fileobj, compress, contenthandler):
+		self.fileobj = _decompressor(fileobj, compress)
+		self.xmldoc = ligolw.Document()
+		self.parser = ligolw.make_parser(contenthandler(self.xmldoc))
+		self.tables = []
+		self.eof = False
+
+	def feed(self):
+		data = self.fileobj.read(self.chunk_size)
+		if data:
+			self.parser.feed(data)
+		else:
+			self.parser.close()
+			self.eof = True
+		self.tables = self.xmldoc.getElementsByTagName(ligolw.Table.tagName)
+
+	@property
+	def position(self):
+		return len(self.tables), len(self.tables[-1]) if self.tables else 0
+
+	def complete(self, i):
+		"""
+		True if the i-th Table has been parsed completely.
+		"""
+		return self.eof or i < len(self.tables) - 1
+
+
+def _compare_params(a, b, ulps, messages):
+	a = a.getElementsByTagName(ligolw.Param.tagName)
+	b = b.getElementsByTagName(ligolw.Param.tagName)
+	if len(a) != len(b):
+		messages.append("documents contain different numbers of Params:  %d != %d" % (len(a), len(b)))
+	for x, y in zip(a, b):
+		if x.Name != y.Name or x.Type != y.Type:
+			messages.append("Params differ:  '%s' (%s) != '%s' (%s)" % (x.Name, x.Type, y.Name, y.Type))
+		elif x.value is None or y.value is None or ligolwtypes.ToBufferCode[x.Type] not in "dD":
+			# integers, including 64-bit values that
+			# float64 cannot represent, strings and blobs
+			# are compared exactly
+			if x.value != y.value:
+				messages.append("Param '%s' values differ:  %r != %r" % (x.Name, x.value, y.value))
+		elif _differ(x.Type, numpy.array([x.value], dtype = "complex128" if x.Type in ligolwtypes.ComplexTypes else "float64"), numpy.array([y.value], dtype = "complex128" if y.Type in ligolwtypes.ComplexTypes else "float64"), ulps).any():
+			messages.append("Param '%s' values differ:  %r != %r" % (x.Name, x.value, y.value))
+
+
+def _compare_arrays(a, b, ulps, messages):
+	a = a.getElementsByTagName(ligolw.Array.tagName)
+	b = b.getElementsByTagName(ligolw.Array.tagName)
+	if len(a) != len(b):
+		messages.append("documents contain different numbers of Arrays:  %d != %d" % (len(a), len(b)))
+	for x, y in zip(a, b):
+		if x.Name != y.Name or x.Type != y.Type or x.array.shape != y.array.shape:
+			messages.append("Arrays differ:  '%s' (%s %s) != '%s' (%s %s)" % (x.Name, x.Type, x.array.shape, y.Name, y.Type, y.array.shape))
+			continue
+		if x.Type in ligolwtypes.FloatTypes | ligolwtypes.ComplexTypes:
+			dtype = "complex128" if x.Type in ligolwtypes.ComplexTypes else "float64"
+			differ = _differ(x.Type, x.array.astype(dtype).ravel(), y.array.astype(dtype).ravel(), ulps)
+		else:
+			differ = x.array.ravel() != y.array.ravel()
+		if differ.any():
+			messages.append("Array '%s' values differ:  %d elements" % (x.Name, differ.sum()))
+
+
+def compare_fileobjs(fileobj_a, fileobj_b, ulps = None, max_differences = 10, compress = None, contenthandler = ligolw.LIGOLWContentHandler):
+	"""
+	Compare the documents in the binary file objects fileobj_a and
+	fileobj_b, and return a Comparison object describing the
+	differences.
+
+	ulps is a dictionary mapping LIGO Light Weight floating-point type
+	names, e.g., "real_4", to the number of units in the last place by
+	which values of that type may differ and still be considered equal.
+	Types that are not listed must be equal.  The two parts of complex
+	values are compared separately.  max_differences sets the number of
+	differences recorded for each Table, all differences are counted.
+	compress and contenthandler are as for ligo.lw.utils.load_fileobj().
+	The content handler must not retain the rows of Tables in any place
+	other than the Table elements.
+	"""
+	if ulps is None:
+		ulps = {}
+	readers = (_Reader(fileobj_a, compress, contenthandler), _Reader(fileobj_b, compress, contenthandler))
+	a, b = readers
+	result = Comparison()
+
+	while True:
+		#
+		# advance the reader that is behind the other, or both.
+		#
+
+		active = [reader for reader in readers if not reader.eof]
+		if not active:
+			break
+		position = min(reader.position for reader in active)
+		for reader in active:
+			if reader.position == position:
+				reader.feed()
+
+		#
+		# compare the rows that have been parsed in both documents,
+		# and discard them.  if one of a pair of Tables is complete,
+		# the other's remaining rows have no counterpart and are
+		# counted and discarded.
+		#
+
+		for i in range(max(len(a.tables), len(b.tables))):
+			x = a.tables[i] if i < len(a.tables) else None
+			y = b.tables[i] if i < len(b.tables) else None
+			if i == len(result.tables):
+				if (x is None and not a.eof) or (y is None and not b.eof):
+					break
+				result.tables.append(TableComparison(x, y, ulps, max_differences))
+			comparison = result.tables[i]
+			if x is not None and y is not None:
+				n = min(len(x), len(y))
+				if n:
+					comparison.compare(x, y, n)
+					del x[:n]
+					del y[:n]
+			if x is not None and (y is None or b.complete(i)):
+				comparison.rows[0] += len(x)
+				del x[:]
+			if y is not None and (x is None or a.complete(i)):
+				comparison.rows[1] += len(y)
+				del y[:]
+
+	#
+	# Tables without rows have not had their columns paired
+	#
+
+	for comparison, x, y in zip(result.tables, a.tables, b.tables):
+		if comparison.columns is None:
+			comparison._setup(x, y)
+	for comparison in result.tables[len(b.tables):]:
+		comparison.messages.append("table only in first document")
+	for comparison in result.tables[len(a.tables):]:
+		comparison.messages.append("table only in second document")
+
+	_compare_params(a.xmldoc, b.xmldoc, ulps, result.messages)
+	_compare_arrays(a.xmldoc, b.xmldoc, ulps, result.messages)
+	return result
+
+
+def compare_filenames(filename_a, filename_b, verbose = False, **kwargs):
+	"""
+	Compare the documents in the files named filename_a and
+	filename_b.  All other keyword arguments are passed to
+	compare_fileobjs(), see that function for more information.
+	"""
+	if verbose:
+		sys.stderr.write("comparing '%s' and '%s' ...\n" % (filename_a, filename_b))
+	with open(filename_a, "rb") as fileobj_a, open(filename_b, "rb") as fileobj_b:
+		return compare_fileobjs(fileobj_a, fileobj_b, **kwargs)
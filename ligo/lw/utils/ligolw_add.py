@@ -29,15 +29,21 @@ Add (merge) LIGO LW XML files containing LSC tables.
 """
 
 
+import contextlib
 import os
+import tempfile
 import urllib.parse
+import urllib.request
 import sys
+from xml.sax.saxutils import escape as xmlescape
 
 
 from tqdm import tqdm
 from .. import __author__, __date__, __version__
 from .. import ligolw
 from .. import lsctables
+from .. import tokenizer
+from .. import types as ligolwtypes
 from .. import utils as ligolw_utils
 
 
@@ -133,6 +139,25 @@ def merge_compatible_tables(elem):
 	That is, merge all SnglBurstTables that have the same columns into
 	a single table, etc..
 	"""
+	for dest, src in _compatible_tables(elem):
+		# copy src rows to dest
+		for row in src:
+			dest.append(row)
+		# unlink src from parent
+		if src.parentNode is not None:
+			src.parentNode.removeChild(src)
+		src.unlink()
+	return elem
+
+
+def _compatible_tables(elem):
+	"""
+	Below the given element, find all Tables whose structure is
+	described in lsctables, and yield (dest, src) pairs in which dest
+	is the first Table of its name and src is a later one that is to
+	be merged into it.  Raises ValueError if src and dest have
+	different columns.
+	"""
 	for name in ligolw.Table.TableByName.keys():
 		tables = ligolw.Table.getTablesByName(elem, name)
 		if tables:
@@ -146,14 +171,7 @@ def merge_compatible_tables(elem):
 					# but they have different columns
 					raise ValueError("document contains %s tables with incompatible columns" % dest.Name)
 				# and the have the same columns
-				# copy src rows to dest
-				for row in src:
-					dest.append(row)
-				# unlink src from parent
-				if src.parentNode is not None:
-					src.parentNode.removeChild(src)
-				src.unlink()
-	return elem
+				yield dest, src
 
 
 #
@@ -198,3 +216,286 @@ def ligolw_add(xmldoc, urls, non_lsc_tables_ok = False, verbose = False, **kwarg
 	merge_compatible_tables(xmldoc)
 
 	return xmldoc
+
+
+#
+# =============================================================================
+#
+#                               Streaming Merge
+#
+# =============================================================================
+#
+
+
+def _open_url(url):
+	"""
+	Open the document at url for reading, and return a binary file
+	object.  The streaming merge reads each document more than once,
+	so stdin cannot be used.
+	"""
+	try:
+		filename = ligolw_utils.local_path_from_url(url)
+	except ValueError:
+		# not a local file
+		return contextlib.closing(urllib.request.urlopen(url))
+	if filename is None:
+		raise ValueError("cannot stream-merge stdin")
+	return open(filename, "rb")
+
+
+def _parse(url, contenthandler):
+	"""
+	Generator to parse the document at url incrementally with the
+	given content handler.  Yields after each block of the file has
+	been parsed, and once more after the end of the document.
+	"""
+	parser = ligolw.make_parser(contenthandler)
+	with _open_url(url) as fileobj:
+		fileobj = ligolw_utils._decompressor(fileobj, None)
+		while True:
+			data = fileobj.read(1 << 20)
+			if not data:
+				break
+			parser.feed(data)
+			yield
+		parser.close()
+		yield
+
+
+def _scan(url):
+	"""
+	First pass of the streaming merge.  Parse the document at url
+	discarding the rows of its Tables as they are read, and return the
+	document tree and a list giving, for each Table in document order,
+	the number of rows and the smallest and largest row IDs.  The IDs
+	are None if the Table does not have an ID column.
+	"""
+	xmldoc = ligolw.Document()
+	stats = []
+	for nul in _parse(url, ligolw.LIGOLWContentHandler(xmldoc)):
+		tables = xmldoc.getElementsByTagName(ligolw.Table.tagName)
+		stats += [[0, None, None] for tbl in tables[len(stats):]]
+		for tbl, stat in zip(tables, stats):
+			if not tbl:
+				continue
+			if tbl.next_id is not None and tbl.next_id.column_name in tbl.columnnames:
+				ids = [getattr(row, tbl.next_id.column_name) for row in tbl]
+				if None in ids:
+					raise ValueError("null row ID encountered in Table '%s', row %d" % (tbl.Name, stat[0] + ids.index(None)))
+				lo, hi = min(ids), max(ids)
+				stat[1:] = (lo, hi) if stat[1] is None else (min(stat[1], lo), max(stat[2], hi))
+			stat[0] += len(tbl)
+			del tbl[:]
+	return xmldoc, stats
+
+
+def _ligo_lw_block(elem):
+	"""
+	Return the child of the document that contains elem.
+	"""
+	while elem.parentNode.parentNode is not None:
+		elem = elem.parentNode
+	return elem
+
+
+class _IDOffsets(object):
+	"""
+	Key mapping, for use with the .applyKeyMapping() methods of Tables,
+	that maps (table name, old ID) to old ID + offset using the
+	dictionary offsets of table name --> offset.  Raises KeyError for
+	Tables that are not in offsets, and for null IDs, so those are
+	left unchanged.
+	"""
+	def __init__(self, offsets):
+		self.offsets = offsets
+
+	def __getitem__(self, key):
+		table_name, old = key
+		if old is None:
+			raise KeyError(key)
+		return old + self.offsets[table_name]
+
+
+def _spool_rows(url, targets):
+	"""
+	Second pass of the streaming merge.  Parse the document at url
+	once, and as its rows are read apply the ID offsets to them and
+	append them, formatted, to the spool files of the output Tables.
+	targets is a list giving, for each Table in the document in order,
+	None if the Table has no rows otherwise the (spool, mapping) pair
+	for it.
+	"""
+	xmldoc = ligolw.Document()
+	for nul in _parse(url, ligolw.LIGOLWContentHandler(xmldoc)):
+		for tbl, target in zip(xmldoc.getElementsByTagName(ligolw.Table.tagName), targets):
+			if not tbl:
+				continue
+			if target is None:
+				raise ValueError("%s: Table '%s' has rows that were not present in the first pass" % (url, tbl.Name))
+			spool, mapping = target
+			if tbl.next_id is not None and tbl.next_id.column_name in tbl.columnnames:
+				column = tbl.getColumnByName(tbl.next_id.column_name)
+				for i, old in enumerate(column):
+					try:
+						column[i] = mapping[tbl.Name, old]
+					except KeyError:
+						pass
+			tbl.applyKeyMapping(mapping)
+			spool.write_rows(tbl)
+			del tbl[:]
+
+
+class _Spool(object):
+	"""
+	Temporary file holding the formatted rows of an output Table, in
+	the form expected by DocumentWriter.write_text().
+	"""
+	def __init__(self, tbl):
+		self.tbl = tbl
+		stream = tbl.getElementsByTagName(ligolw.Stream.tagName)[0]
+		self.rowdumper = tokenizer.RowDumper(tbl.columnnames, [ligolwtypes.FormatFunc[coltype] for coltype in tbl.columntypes], stream.Delimiter)
+		self.newline = stream.Delimiter + ligolw_utils.DocumentWriter.row_newline(tbl)
+		self.fileobj = tempfile.TemporaryFile(mode = "w+", encoding = "utf-8")
+		self.started = False
+		self.null_last = False
+
+	def write_rows(self, rows):
+		w = self.fileobj.write
+		rowdumper = self.rowdumper
+		rowdumper.dump(rows)
+		if not self.started:
+			try:
+				line = next(rowdumper)
+			except StopIteration:
+				return
+			w(xmlescape(line))
+			self.started = True
+		newline = self.newline
+		for line in rowdumper:
+			w(newline)
+			w(xmlescape(line))
+		self.null_last = rowdumper.tokens[-1] == ""
+
+	def copy_to(self, writer):
+		self.fileobj.seek(0)
+		writer.write_text(self.tbl, self.fileobj, null_last = self.null_last)
+		self.fileobj.close()
+
+
+def ligolw_add_streaming(urls, filename, non_lsc_tables_ok = False, verbose = False, **kwargs):
+	"""
+	An implementation of the LIGO LW add algorithm that does not hold
+	the rows of the documents in memory.  The documents at the URLs (or
+	filenames) in urls are merged, and the result written to the file
+	named filename (stdout if None).  non_lsc_tables_ok and verbose are
+	as for ligolw_add(), and all remaining keyword arguments are passed
+	to ligo.lw.utils.DocumentWriter.
+
+	The merge is done in two passes.  The first parses each document,
+	discarding the rows, and records the document's structure and the
+	range of row IDs in each of its Tables.  The elements are merged
+	and checked as by ligolw_add().  The second pass parses each
+	document again, once, and as its rows are read appends them,
+	formatted, to a temporary file for the output Table that will
+	receive them.  The output document is then written with a
+	DocumentWriter, the contents of the temporary files being copied
+	into the Tables' Streams.  The memory required is that of the
+	documents without their Table rows, and the temporary files hold
+	one copy of the output rows.  The documents must not be modified
+	during the merge.
+
+	Instead of being renumbered row-by-row, IDs are assigned by adding
+	an offset to the IDs of each Table in each LIGO_LW block, and to
+	the references to them in that block, the references being found
+	by the Tables' .applyKeyMapping() methods as for ligolw_add() so
+	that, for example, the coinc_event_map's event_id references are
+	offset according to each row's table_name.  The offset places the
+	smallest ID in the Table at the Table class' current .next_id, and
+	.next_id is advanced past the largest.  When a Table's IDs are
+	0, 1, 2, ... in row order, as is typical, the result is the same
+	as ligolw_add()'s.  Unlike ligolw_add(), a reference to an ID that
+	is not in the referenced Table is offset too, if the Table is in
+	the block.  Tables whose class replaces .updateKeyMapping(), so
+	that their IDs cannot be assigned by offsetting them, are not
+	supported and ValueError is raised.
+	"""
+	#
+	# first pass:  the documents without their rows, and the ID
+	# offsets.  inputs is a list of (url, targets) pairs, where targets
+	# gives for each of the document's Tables None if the Table has no
+	# rows otherwise the (Table, mapping) pair giving the Table in the
+	# merged document that contains it and the key mapping that
+	# applies the ID offsets of its LIGO_LW block.
+	#
+
+	xmldoc = ligolw.Document()
+	inputs = []
+	for n, url in enumerate(urls, 1):
+		if verbose:
+			sys.stderr.write("%d/%d: scanning %s ...\n" % (n, len(urls), url))
+		doc, stats = _scan(url)
+		tables = doc.getElementsByTagName(ligolw.Table.tagName)
+
+		for tbl in tables:
+			if tbl.next_id is not None and type(tbl).updateKeyMapping is not ligolw.Table.updateKeyMapping:
+				raise ValueError("%s: cannot stream-merge Table '%s':  its IDs are not assigned by ligolw.Table.updateKeyMapping()" % (url, tbl.Name))
+
+		id_ranges = {}
+		for tbl, (nul, lo, hi) in zip(tables, stats):
+			if lo is not None:
+				key = _ligo_lw_block(tbl), tbl.Name
+				id_ranges[key] = (lo, hi) if key not in id_ranges else (min(id_ranges[key][0], lo), max(id_ranges[key][1], hi))
+		mappings = {}
+		for tbl in tables:
+			block = _ligo_lw_block(tbl)
+			mapping = mappings.setdefault(block, _IDOffsets({}))
+			key = block, tbl.Name
+			if key in id_ranges and tbl.Name not in mapping.offsets:
+				lo, hi = id_ranges[key]
+				mapping.offsets[tbl.Name] = tbl.next_id - lo
+				tbl.set_next_id(tbl.next_id + (hi - lo + 1))
+
+		inputs.append((url, [(tbl, mappings[_ligo_lw_block(tbl)]) if count else None for tbl, (count, nul, nul) in zip(tables, stats)]))
+
+		for elem in list(doc.childNodes):
+			xmldoc.appendChild(doc.removeChild(elem))
+
+	if not non_lsc_tables_ok and lsctables.HasNonLSCTables(xmldoc):
+		raise ValueError("non-LSC tables found.  Use --non-lsc-tables-ok to force")
+
+	#
+	# merge the elements
+	#
+
+	if verbose:
+		sys.stderr.write("merging elements ...\n")
+	merge_ligolws(xmldoc)
+	dests = {}
+	for dest, src in _compatible_tables(xmldoc):
+		dests[id(src)] = dest
+		if src.parentNode is not None:
+			src.parentNode.removeChild(src)
+		src.unlink()
+
+	#
+	# second pass:  spool the rows
+	#
+
+	tables = xmldoc.getElementsByTagName(ligolw.Table.tagName)
+	spools = dict((id(tbl), _Spool(tbl)) for tbl in tables)
+	try:
+		for n, (url, targets) in enumerate(inputs, 1):
+			if verbose:
+				sys.stderr.write("%d/%d: reading rows from %s ...\n" % (n, len(inputs), url))
+			_spool_rows(url, [(spools[id(dests.get(id(target[0]), target[0]))], target[1]) if target is not None else None for target in targets])
+
+		#
+		# write the document
+		#
+
+		with ligolw_utils.DocumentWriter(xmldoc, filename, tables, verbose = verbose, **kwargs) as writer:
+			for tbl in tables:
+				spools.pop(id(tbl)).copy_to(writer)
+	finally:
+		for spool in spools.values():
+			spool.fileobj.close()
@@ -38,6 +38,10 @@ level operations provided by the ligolw_sqlite program.
 """
 
 
+import base64
+import collections
+import json
+import os
 import sys
 
 
@@ -56,12 +60,217 @@ from .. import utils as ligolw_utils
 #
 
 
+#
+# Progress records for resumable inserts
+#
+
+
+ProgressTableName = "_ligolw_sqlite_progress_"
+
+
+Progress = collections.namedtuple("Progress", ("stream", "position", "state", "source", "rowids"))
+Progress.__doc__ = """
+The progress of an interrupted insert.  stream is the Table Stream,
+counted from 0 in document order, whose rows were being inserted when the
+last commit occured, position is the number of characters of that
+Stream's text that had been parsed, and state is the Stream's parser
+state at that point (see ligo.lw.ligolw.Table.Stream.checkpoint()).
+source identifies the version of the document that was being read (see
+document_source()), and rowids maps the name of each table that existed
+before the insert began to the largest rowid it held then (None if it was
+empty).
+"""
+
+
+def document_source(url):
+	"""
+	Return the [size, modification time in ns] of the document at the
+	URL, or None if the URL is not a local file.  Resuming an insert
+	from a document whose size or modification time has changed starts
+	the insert again, but documents that are not local files are
+	assumed not to have changed.
+	"""
+	try:
+		path = ligolw_utils.local_path_from_url(url)
+	except ValueError:
+		return None
+	st = os.stat(path)
+	return [st.st_size, st.st_mtime_ns]
+
+
+def _state_default(obj):
+	# the values in a parser state that JSON has no type for
+	if isinstance(obj, (bytes, memoryview)):
+		return {"base64": base64.b64encode(obj).decode("ascii")}
+	if isinstance(obj, complex):
+		return {"complex": [obj.real, obj.imag]}
+	raise TypeError("cannot record %s in a progress record" % repr(obj))
+
+
+def _state_object_hook(obj):
+	if "base64" in obj:
+		return memoryview(base64.b64decode(obj["base64"]))
+	if "complex" in obj:
+		return complex(*obj["complex"])
+	return obj
+
+
+def get_progress(connection, url):
+	"""
+	Retrieve the progress record for the document at the URL from the
+	database at the given connection.  The return value is None if
+	there is no record, True if the document has been inserted
+	completely, or a Progress tuple.  The record is stored as plain
+	columns and JSON text, so reading it does not execute anything
+	found in the database.
+	"""
+	cursor = connection.cursor()
+	cursor.execute("CREATE TABLE IF NOT EXISTS %s (url TEXT PRIMARY KEY, complete INTEGER NOT NULL, stream INTEGER NOT NULL, position INTEGER NOT NULL, state TEXT, source TEXT, rowids TEXT)" % ProgressTableName)
+	cursor.execute("SELECT complete, stream, position, state, source, rowids FROM %s WHERE url == ?" % ProgressTableName, (url,))
+	progress = cursor.fetchone()
+	cursor.close()
+	if progress is None:
+		return None
+	complete, stream, position, state, source, rowids = progress
+	if complete:
+		return True
+	return Progress(stream, position, tuple(json.loads(state, object_hook = _state_object_hook)), json.loads(source), json.loads(rowids))
+
+
+def set_progress(connection, url, progress):
+	"""
+	Record the progress of the insert of the document at the URL in the
+	database at the given connection.  progress is True or a Progress
+	tuple as described in get_progress().  The record is not committed;
+	it is committed with the rows whose insertion it describes.
+	"""
+	if progress is True:
+		row = (url, 1, -1, 0, None, None, None)
+	else:
+		row = (url, 0, progress.stream, progress.position, json.dumps(progress.state, default = _state_default), json.dumps(progress.source), json.dumps(progress.rowids))
+	connection.cursor().execute("INSERT OR REPLACE INTO %s (url, complete, stream, position, state, source, rowids) VALUES (?, ?, ?, ?, ?, ?, ?)" % ProgressTableName, row)
+
+
+def _table_names(connection):
+	"""
+	Return the names of the tables in the database at the given
+	connection, other than the progress records.
+	"""
+	return [name for name, in connection.cursor().execute("SELECT name FROM sqlite_master WHERE type == 'table' AND name NOT LIKE 'sqlite_%%' AND name != '%s'" % ProgressTableName)]
+
+
+def _max_rowids(connection):
+	"""
+	Return a dictionary mapping the name of each table in the database
+	at the given connection to the largest rowid in it.
+	"""
+	cursor = connection.cursor()
+	return dict((name, cursor.execute("SELECT MAX(rowid) FROM %s" % name).fetchone()[0]) for name in _table_names(connection))
+
+
+def _discard_progress(connection, url, progress):
+	"""
+	Delete the rows committed by an interrupted insert of the document
+	at the URL, and its progress record.  Tables that did not exist
+	before the insert began are emptied.  Nothing is committed.
+	"""
+	cursor = connection.cursor()
+	for name in _table_names(connection):
+		maxrowid = progress.rowids.get(name)
+		if maxrowid is None:
+			cursor.execute("DELETE FROM %s" % name)
+		else:
+			cursor.execute("DELETE FROM %s WHERE rowid > ?" % name, (maxrowid,))
+	cursor.execute("DELETE FROM %s WHERE url == ?" % ProgressTableName, (url,))
+	cursor.close()
+
+
+def clear_progress(connection):
+	"""
+	Delete the progress records from the database at the given
+	connection.  This should be done when all the documents of a
+	resumable insert have been inserted, to leave only the tables
+	inserted from the documents in the database.
+	"""
+	connection.cursor().execute("DROP TABLE IF EXISTS %s" % ProgressTableName)
+	connection.commit()
+
+
+def _resumable_contenthandler(contenthandler, url, progress, checkpoint_interval):
+	"""
+	Return a subclass of contenthandler that records the progress of
+	the insert of the document at the URL every checkpoint_interval
+	characters of Table Stream text, committing the rows inserted so
+	far together with the record.  progress is the record left by an
+	earlier, interrupted, insert of the document, or a record at
+	position 0 of Stream 0 for a new insert.  The text of the Table
+	Streams whose rows were committed is skipped without being
+	tokenized.
+	"""
+	resume_stream, resume_position, resume_state = progress.stream, progress.position, progress.state
+
+	class ResumableContentHandler(contenthandler):
+		def __init__(self, *args, **kwargs):
+			super(ResumableContentHandler, self).__init__(*args, **kwargs)
+			self.stream = -1
+			self.in_stream = False
+			self.discard = False
+			self.skip = 0
+			self.position = self.last_checkpoint = 0
+
+		def startElementNS(self, uri_localname, qname, attrs):
+			super(ResumableContentHandler, self).startElementNS(uri_localname, qname, attrs)
+			if self.current.tagName == ligolw.Stream.tagName and self.current.parentNode.tagName == ligolw.Table.tagName:
+				self.stream += 1
+				self.in_stream = True
+				self.discard = self.stream < resume_stream
+				self.skip = resume_position if self.stream == resume_stream else 0
+				self.position = self.last_checkpoint = 0
+
+		def endElementNS(self, uri_localname, qname):
+			if self.in_stream:
+				self.in_stream = False
+				if self.discard:
+					# rows committed, don't flush
+					# the tokenizer
+					self.current = self.current.parentNode
+					return
+				if self.skip:
+					raise ValueError("%s: document does not match progress record" % url)
+			super(ResumableContentHandler, self).endElementNS(uri_localname, qname)
+
+		def characters(self, content):
+			if not self.in_stream:
+				super(ResumableContentHandler, self).characters(content)
+				return
+			if self.discard:
+				return
+			if self.skip:
+				n = min(self.skip, len(content))
+				self.skip -= n
+				self.position += n
+				if self.skip:
+					return
+				self.current.restore(resume_state)
+				content = content[n:]
+				if not content:
+					return
+			super(ResumableContentHandler, self).characters(content)
+			self.position += len(content)
+			if self.position - self.last_checkpoint >= checkpoint_interval:
+				set_progress(self.connection, url, progress._replace(stream = self.stream, position = self.position, state = self.current.checkpoint()))
+				self.connection.commit()
+				self.last_checkpoint = self.position
+
+	return ResumableContentHandler
+
+
 #
 # How to insert
 #
 
 
-def insert_from_url(url, preserve_ids = False, verbose = False, contenthandler = None):
+def insert_from_url(url, preserve_ids = False, verbose = False, contenthandler = None, resumable = False, checkpoint_interval = 1 << 26):
 	"""
 	Parse and insert the LIGO Light Weight document at the URL into the
 	database with which the content handler is associated.  If
@@ -74,12 +283,130 @@ def insert_from_url(url, preserve_ids = False, verbose = False, contenthandler =
 	empty database.  If verbose is True then progress reports will be
 	printed to stderr.  See ligo.lw.dbtables.use_in() for more
 	information about constructing a suitable content handler class.
+
+	If resumable is True, the progress of the insert is recorded in the
+	database (see get_progress()), and the insert can be continued by
+	calling this function again with the same arguments if it is
+	interrupted.  A document that has already been inserted is skipped.
+	If preserve_ids is False the document's rows are committed together
+	with the record of its completion, so an interrupted insert starts
+	again from the beginning of the document.  If preserve_ids is True
+	the rows are committed, together with the Table Stream parser's
+	state, every checkpoint_interval characters of Table Stream text,
+	and an interrupted insert continues from the last commit:  the
+	document is read again from the start to reconstruct the tables,
+	but the text of the rows already in the database is not parsed
+	again.  If the document has changed since the interruption (see
+	document_source()), the rows committed from it are deleted and the
+	insert starts again.  Use clear_progress() to remove the records
+	when done.
+
+	Example:
+
+	>>> import gzip
+	>>> import sqlite3
+	>>> import tempfile
+	>>> from ligo.lw import dbtables
+	>>> @dbtables.use_in
+	... class ContentHandler(ligolw.LIGOLWContentHandler):
+	...	pass
+	...
+
+	Write the rows of each Table Stream on one line, so the parser is
+	interrupted in the middle of rows and tokens.
+
+	>>> document = tempfile.NamedTemporaryFile(mode = "w", suffix = ".xml")
+	>>> with gzip.open("ligolw_sqlite_test_input.xml.gz", "rt") as fileobj:
+	...	n = document.write(fileobj.read().replace(",\\n\\t\\t\\t", ","))
+	...
+	>>> document.flush()
+	>>> ContentHandler.connection = reference = sqlite3.connect(":memory:")
+	>>> insert_from_url(document.name, contenthandler = ContentHandler, preserve_ids = True)
+
+	Insert it again, interrupting the insert after the third commit.
+	The rows that were not committed are rolled back, as they would be
+	if the program had been killed.
+
+	>>> class Interrupted(Exception):
+	...	pass
+	...
+	>>> from ligo.lw.utils import ligolw_sqlite
+	>>> def interrupted_insert(connection, commits):
+	...	def interrupting_set_progress(connection, url, progress):
+	...		if len(commits) >= 3:
+	...			raise Interrupted
+	...		commits.append(progress)
+	...		set_progress(connection, url, progress)
+	...	ligolw_sqlite.set_progress = interrupting_set_progress
+	...	ContentHandler.connection = connection
+	...	try:
+	...		insert_from_url(document.name, contenthandler = ContentHandler, preserve_ids = True, resumable = True, checkpoint_interval = 1 << 16)
+	...	except Interrupted:
+	...		connection.rollback()
+	...	finally:
+	...		ligolw_sqlite.set_progress = set_progress
+	...
+	>>> connection = sqlite3.connect(":memory:")
+	>>> interrupted_insert(connection, [])
+	>>> get_progress(connection, document.name).stream
+	3
+
+	Resume the insert.  The result is the same as the uninterrupted
+	insert's.
+
+	>>> insert_from_url(document.name, contenthandler = ContentHandler, preserve_ids = True, resumable = True, checkpoint_interval = 1 << 16)
+	>>> clear_progress(connection)
+	>>> list(connection.iterdump()) == list(reference.iterdump())
+	True
+
+	If the document changes after the interruption the saved positions
+	are meaningless, so the rows committed from it are deleted and the
+	insert starts again.
+
+	>>> connection = sqlite3.connect(":memory:")
+	>>> interrupted_insert(connection, [])
+	>>> n = document.write("\\n")
+	>>> document.flush()
+	>>> insert_from_url(document.name, contenthandler = ContentHandler, preserve_ids = True, resumable = True, checkpoint_interval = 1 << 16)
+	>>> clear_progress(connection)
+	>>> list(connection.iterdump()) == list(reference.iterdump())
+	True
+	>>> document.close()
 	"""
+	#
+	# check for an earlier, interrupted, insert
+	#
+
+	if resumable:
+		if url is None:
+			raise ValueError("cannot resume an insert from stdin")
+		progress = get_progress(contenthandler.connection, url)
+		if progress is True:
+			if verbose:
+				sys.stderr.write("'%s' already inserted, skipping\n" % url)
+			return
+		source = document_source(url)
+		if progress is not None:
+			if not preserve_ids:
+				raise ValueError("'%s': insert was started with preserve_ids = True" % url)
+			if progress.source != source:
+				if verbose:
+					sys.stderr.write("'%s' has changed since the interrupted insert, starting again\n" % url)
+				_discard_progress(contenthandler.connection, url, progress)
+				progress = None
+			elif verbose:
+				sys.stderr.write("resuming insert of '%s' at Table Stream %d, character %d\n" % (url, progress.stream, progress.position))
+		if preserve_ids:
+			if progress is None:
+				progress = Progress(0, 0, None, source, _max_rowids(contenthandler.connection))
+			contenthandler = _resumable_contenthandler(contenthandler, url, progress, checkpoint_interval)
+
 	#
 	# enable/disable ID remapping
 	#
 
 	orig_DBTable_append = dbtables.DBTable.append
+	orig_DBTable_Stream_endElement = dbtables.DBTable.Stream.endElement
 
 	if not preserve_ids:
 		idmapper = dbtables.idmapper(contenthandler.connection)
@@ -87,6 +414,13 @@ def insert_from_url(url, preserve_ids = False, verbose = False, contenthandler =
 	else:
 		dbtables.DBTable.append = dbtables.DBTable._append
 
+	#
+	# commit only when the progress record is updated
+	#
+
+	if resumable:
+		dbtables.DBTable.Stream.endElement = ligolw.Table.Stream.endElement
+
 	try:
 		#
 		# load document.  this process inserts the document's
@@ -112,8 +446,12 @@ def insert_from_url(url, preserve_ids = False, verbose = False, contenthandler =
 		if not preserve_ids:
 			idmapper.update_ids(xmldoc, verbose = verbose)
 
+		if resumable:
+			set_progress(contenthandler.connection, url, True)
+
 	finally:
 		dbtables.DBTable.append = orig_DBTable_append
+		dbtables.DBTable.Stream.endElement = orig_DBTable_Stream_endElement
 
 	#
 	# done.  unlink the document to delete database cursor objects it
@@ -219,7 +557,8 @@ def insert_from_urls(urls, contenthandler, **kwargs):
 	Iterate over a sequence of URLs, calling insert_from_url() on each,
 	then build the indexes indicated by the metadata in lsctables.py.
 	See insert_from_url() for a description of the additional
-	arguments.
+	arguments.  If the insert is resumable, the progress records are
+	removed when all documents have been inserted.
 	"""
 	verbose = kwargs.get("verbose", False)
 
@@ -232,6 +571,9 @@ def insert_from_urls(urls, contenthandler, **kwargs):
 			sys.stderr.write("%d/%d:" % (n, len(urls)))
 		insert_from_url(url, contenthandler = contenthandler, **kwargs)
 
+	if kwargs.get("resumable", False):
+		clear_progress(contenthandler.connection)
+
 	#
 	# done.  build indexes
 	#
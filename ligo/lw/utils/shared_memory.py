@@ -0,0 +1,379 @@
+# Copyright (C) 2026  Kipp Cannon
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#
+# =============================================================================
+#
+#                                   Preamble
+#
+# =============================================================================
+#
+
+
+"""
+Share the contents of a Table between processes with
+multiprocessing.shared_memory.
+
+One process loads a document and exports a Table's columns into a shared
+memory segment with export_table().  Other processes attach to the segment
+by name with attach_table() and obtain a read-only, columnar view of the
+Table that behaves like a sequence of row objects, without parsing the
+document or holding their own copy of the data.
+
+Example:
+
+>>> from ligo.lw import lsctables
+>>> from ligo.lw.utils import shared_memory
+>>> tbl = lsctables.SnglBurstTable.new(["event_id", "ifo", "snr"])
+>>> for i, ifo in enumerate(("H1", "L1", "V1")):
+...	tbl.append(tbl.RowType(event_id = i, ifo = ifo, snr = 5. + i))
+...
+>>> exported = shared_memory.export_table(tbl)
+>>> view = shared_memory.attach_table(exported.name)
+>>> len(view)
+3
+>>> view[1].ifo
+'L1'
+>>> [row.event_id for row in view]
+[0, 1, 2]
+>>> view.getColumnByName("snr")
+array([5., 6., 7.])
+>>> view.getColumnByName("ifo")
+['H1', 'L1', 'V1']
+>>> len(view.table())
+3
+>>> view.close()
+>>> exported.close()
+>>> exported.unlink()
+"""
+
+
+from multiprocessing import shared_memory
+import numpy
+import pickle
+import struct
+import sys
+
+
+from .. import __author__, __date__, __version__
+from .. import tokenizer
+from .. import types as ligolwtypes
+
+
+__all__ = ["SharedTable", "export_table", "attach_table"]
+
+
+#
+# =============================================================================
+#
+#                                Segment Layout
+#
+# =============================================================================
+#
+
+
+#
+# A segment begins with an 8 byte magic number and the length of the
+# header as a little-endian 64 bit integer, followed by the header, which
+# is a pickle of a dictionary describing the contents, followed by the
+# buffers produced by tokenizer.pack_columns() each starting on a 64 byte
+# boundary.  String and blob columns are stored as 64 bit offsets into a
+# concatenated blob.
+#
+
+
+MAGIC = b"LIGOLWT\x01"
+ALIGNMENT = 64
+
+
+def _align(n):
+	return (n + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+#
+# names of segments created by this process.  see attach_table()
+#
+
+
+_exported = set()
+
+
+#
+# used to unpack a single column
+#
+
+
+class _Value(object):
+	__slots__ = ("value",)
+
+
+#
+# =============================================================================
+#
+#                                 Shared Table
+#
+# =============================================================================
+#
+
+
+class SharedTable(object):
+	"""
+	A read-only, columnar view of a Table stored in a shared memory
+	segment.  Do not create instances of this class directly, use
+	export_table() or attach_table().
+
+	Indexing the view, or iterating over it, yields row objects of the
+	original Table's RowType class, so their properties (e.g., .end,
+	.instruments) work as usual.  The row objects are constructed on
+	demand and are copies:  modifying them does not modify the shared
+	data.  .getColumnByName() returns zero-copy numpy arrays for
+	numeric columns.  .table() constructs an ordinary Table containing
+	all the rows.
+
+	The view must be closed with .close() when it is no longer needed,
+	and the process that created the segment must eventually call
+	.unlink() to release the memory.  The instance can also be used as
+	a context manager, which calls .close() on exit.
+	"""
+	#
+	# number of rows constructed at a time while iterating
+	#
+
+	chunk_size = 4096
+
+	def __init__(self, shm):
+		self.shm = shm
+		buf = shm.buf
+		if bytes(buf[:len(MAGIC)]) != MAGIC:
+			raise ValueError("shared memory segment '%s' does not contain a Table" % shm.name)
+		header_length, = struct.unpack_from("<Q", buf, len(MAGIC))
+		start = len(MAGIC) + 8
+		header = pickle.loads(buf[start : start + header_length])
+		if header["byteorder"] != sys.byteorder:
+			raise ValueError("shared memory segment '%s' has the wrong byte order" % shm.name)
+		start = _align(start + header_length)
+		self._skeleton = header["skeleton"]
+		self._n = header["n"]
+		# read-only views of the buffers
+		buf = buf.toreadonly()
+		self._columns = tuple((code,) + tuple(None if extent is None else buf[start + extent[0] : start + extent[0] + extent[1]] for extent in extents) for code, extents in header["columns"])
+
+	@property
+	def name(self):
+		"""
+		The name of the shared memory segment.
+		"""
+		return self.shm.name
+
+	@property
+	def tableName(self):
+		return self._skeleton.tableName
+
+	@property
+	def RowType(self):
+		return self._skeleton.RowType
+
+	@property
+	def columnnames(self):
+		return self._skeleton.columnnames
+
+	@property
+	def columntypes(self):
+		return self._skeleton.columntypes
+
+	def __len__(self):
+		return self._n
+
+	def _rows(self, start, stop):
+		"""
+		Construct the row objects for rows start through stop - 1.
+		"""
+		def sliced(code, mask, data, blob):
+			width = 16 if code == "D" else 8
+			if code in "uy":
+				# offsets are absolute, so the blob is not
+				# sliced
+				return (code, mask and mask[start : stop], data[start * width : (stop + 1) * width], blob)
+			return (code, mask and mask[start : stop], data[start * width : stop * width], blob)
+		return tokenizer.unpack_columns(self.RowType, self.columnnames, stop - start, [sliced(*column) for column in self._columns])
+
+	def __getitem__(self, i):
+		if isinstance(i, slice):
+			start, stop, step = i.indices(self._n)
+			if step != 1:
+				return self._rows(0, self._n)[i]
+			return self._rows(start, max(start, stop))
+		if i < 0:
+			i += self._n
+		if not 0 <= i < self._n:
+			raise IndexError("row index out of range")
+		return self._rows(i, i + 1)[0]
+
+	def __iter__(self):
+		for start in range(0, self._n, self.chunk_size):
+			yield from self._rows(start, min(start + self.chunk_size, self._n))
+
+	def getColumnByName(self, name):
+		"""
+		Return the contents of a column.  For numeric columns, the
+		result is a read-only numpy array sharing the memory
+		segment's buffer (no copy is made), or a numpy masked array
+		if the column contains null values.  For string and blob
+		columns, the result is a list.  Arrays that share the
+		segment's buffer must be deleted before .close() is called.
+		"""
+		try:
+			code, mask, data, blob = self._columns[self.columnnames.index(name)]
+		except ValueError:
+			raise KeyError(name)
+		if code in "uy":
+			return [value.value for value in tokenizer.unpack_columns(_Value, ("value",), self._n, [(code, mask, data, blob)])]
+		array = numpy.frombuffer(data, dtype = {"q": "int64", "Q": "uint64", "d": "float64", "D": "complex128"}[code])
+		if mask is not None:
+			array = numpy.ma.MaskedArray(array, mask = numpy.frombuffer(mask, dtype = "uint8") != 0)
+		return array
+
+	def table(self):
+		"""
+		Construct and return a new Table element containing copies
+		of all the rows.
+		"""
+		new = self._skeleton.copy()
+		new.extend(self._rows(0, self._n))
+		return new
+
+	def close(self):
+		"""
+		Release this process' view of the memory segment.  The
+		segment itself is not destroyed, see .unlink().
+		"""
+		# drop the memoryviews, otherwise the segment's buffer
+		# cannot be released
+		self._columns = ()
+		self.shm.close()
+
+	def unlink(self):
+		"""
+		Request that the memory segment be destroyed.  Should be
+		called once, by the process that created the segment,
+		after all the other processes have attached to it.
+		"""
+		_exported.discard(self.shm.name)
+		self.shm.unlink()
+
+	def __enter__(self):
+		return self
+
+	def __exit__(self, *args):
+		self.close()
+
+
+#
+# =============================================================================
+#
+#                               Export, Attach
+#
+# =============================================================================
+#
+
+
+def export_table(tbl, name = None):
+	"""
+	Copy the contents of the Table tbl into a new shared memory
+	segment, and return a SharedTable view of it.  If name is not None
+	it sets the name of the segment, otherwise a unique name is
+	generated.  The name is available as the .name attribute of the
+	return value and is passed to attach_table() in other processes.
+
+	ValueError is raised if a column contains values that cannot be
+	stored in a typed buffer (see ligo.lw.tokenizer.pack_columns()).
+	"""
+	names = tbl.columnnames
+	columns = tokenizer.pack_columns(tbl, names, "".join(ligolwtypes.ToBufferCode[coltype] for coltype in tbl.columntypes))
+
+	#
+	# assign locations to the buffers
+	#
+
+	layout = []
+	buffers = []
+	size = 0
+	for colname, (code, mask, data, blob) in zip(names, columns):
+		if code == "O":
+			raise ValueError("column '%s' of table '%s' contains values that cannot be shared" % (colname, tbl.Name))
+		extents = []
+		for buf in (mask, data, blob):
+			if buf is None:
+				extents.append(None)
+				continue
+			extents.append((size, len(buf)))
+			buffers.append((size, buf))
+			size = _align(size + len(buf))
+		layout.append((code, tuple(extents)))
+
+	#
+	# a row-less copy of the Table carries the class, attributes and
+	# columns to the other processes
+	#
+
+	skeleton = tbl.copy()
+	skeleton.parentNode = None
+	header = pickle.dumps({"skeleton": skeleton, "n": len(tbl), "columns": layout, "byteorder": sys.byteorder}, protocol = pickle.HIGHEST_PROTOCOL)
+	start = _align(len(MAGIC) + 8 + len(header))
+
+	#
+	# create and populate the segment
+	#
+
+	shm = shared_memory.SharedMemory(name = name, create = True, size = start + size or 1)
+	try:
+		buf = shm.buf
+		buf[:len(MAGIC)] = MAGIC
+		struct.pack_into("<Q", buf, len(MAGIC), len(header))
+		buf[len(MAGIC) + 8 : len(MAGIC) + 8 + len(header)] = header
+		for offset, data in buffers:
+			buf[start + offset : start + offset + len(data)] = data
+		del buf
+		_exported.add(shm.name)
+		return SharedTable(shm)
+	except:
+		shm.close()
+		shm.unlink()
+		raise
+
+
+def attach_table(name):
+	"""
+	Attach to the shared memory segment named name, created by
+	export_table() possibly in another process, and return a
+	SharedTable view of it.
+	"""
+	if sys.version_info >= (3, 13):
+		shm = shared_memory.SharedMemory(name = name, track = False)
+	else:
+		shm = shared_memory.SharedMemory(name = name)
+		if name not in _exported:
+			# prior to Python 3.13 attaching registers the
+			# segment with the resource tracker, which would
+			# destroy it when this process exits
+			from multiprocessing import resource_tracker
+			resource_tracker.unregister(shm._name, "shared_memory")
+	try:
+		return SharedTable(shm)
+	except:
+		shm.close()
+		raise
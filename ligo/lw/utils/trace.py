@@ -0,0 +1,426 @@
+# Copyright (C) 2026  Kipp Cannon
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+#
+# =============================================================================
+#
+#                                   Preamble
+#
+# =============================================================================
+#
+
+
+"""
+Record a timeline of where the time goes when documents are loaded,
+written and inserted into databases.
+
+When tracing is enabled, the library's document I/O records spans of time
+with byte and row counts:  "load" and "write" spans for each document,
+with the time spent in, and the bytes passed through, the (de)compressor
+and the file;  "parse" and "format" spans for each Table Stream, with the
+time spent appending rows to the Table, which for database-backed tables
+is the time spent inserting them;  and "insert", "update_ids" and
+"build_indexes" spans for database ingests.  dump() writes the spans in
+the Chrome trace event format, which can be viewed with chrome://tracing
+or https://ui.perfetto.dev.
+
+Tracing works by replacing the instrumented functions with wrappers, so
+when it is disabled, which is the default, there is no overhead at all.
+
+Example:
+
+>>> import io
+>>> from ligo.lw import ligolw
+>>> from ligo.lw import utils as ligolw_utils
+>>> from ligo.lw.utils import trace
+>>> trace.enable()
+>>> xmldoc = ligolw_utils.load_filename("ligolw_sqlite_test_input.xml.gz")
+>>> ligolw_utils.write_fileobj(xmldoc, io.BytesIO(), compress = "gz")
+>>> trace.disable()
+>>> [event["name"] for event in trace.events if event["name"] in ("load", "write")]
+['load', 'write']
+>>> parse = [event for event in trace.events if event["name"] == "parse" and event["args"]["table"] == "sngl_burst"][0]
+>>> parse["args"]["rows"]
+17018
+>>> fileobj = io.StringIO()
+>>> trace.dump(fileobj)
+>>> trace.clear()
+
+The C tokenizer also provides static probes, in the "ligolw" provider,
+for use with perf and bpftrace, if the system's sys/sdt.h header was
+available when the extension module was built:  "tokenizer_append"
+(characters appended, characters buffered), "rowbuilder_row" (columns)
+and "rowdumper_row" (rows converted, characters).  These are a nop
+instruction when not in use.
+
+To trace a program without modifying it, run it with
+
+	python -m ligo.lw.utils.trace trace.json program [arguments ...]
+"""
+
+
+import json
+import os
+import runpy
+import shutil
+import sys
+import threading
+import time
+
+
+from .. import __author__, __date__, __version__
+from .. import dbtables
+from .. import ligolw
+from .. import utils as ligolw_utils
+from . import ligolw_sqlite
+
+
+__all__ = ["events", "span", "enable", "disable", "clear", "dump"]
+
+
+#
+# =============================================================================
+#
+#                                    Spans
+#
+# =============================================================================
+#
+
+
+events = []
+"""
+The recorded spans, as dictionaries in the Chrome trace event format.
+"""
+
+
+_local = threading.local()
+
+
+class span(object):
+	"""
+	Record the time between calls to .start() and .end() as a complete
+	("X") event in events.  Used as a context manager, the span starts
+	when the context is entered and ends when it is left.  args is a
+	dictionary of values to attach to the event, and can be updated
+	while the span is open.  Spans opened and not yet closed on a
+	thread are nested, the innermost one is returned by current().
+	"""
+	def __init__(self, name, **args):
+		self.name = name
+		self.args = args
+
+	def start(self):
+		try:
+			_local.stack.append(self)
+		except AttributeError:
+			_local.stack = [self]
+		self.t_start = time.perf_counter()
+		return self
+
+	def end(self):
+		t_end = time.perf_counter()
+		_local.stack.remove(self)
+		events.append({
+			"name": self.name,
+			"cat": "ligolw",
+			"ph": "X",
+			# microseconds
+			"ts": self.t_start * 1e6,
+			"dur": (t_end - self.t_start) * 1e6,
+			"pid": os.getpid(),
+			"tid": threading.get_ident(),
+			"args": self.args
+		})
+
+	def __enter__(self):
+		return self.start()
+
+	def __exit__(self, *args):
+		self.end()
+
+	@staticmethod
+	def current():
+		"""
+		Return the innermost open span on this thread, or None.
+		"""
+		stack = getattr(_local, "stack", None)
+		return stack[-1] if stack else None
+
+
+class _TimedFile(object):
+	"""
+	Wrap a file object, adding the time spent in, and the bytes passed
+	through, its .read() and .write() methods to the arguments of a
+	span as "<prefix>_s" and "<prefix>_bytes".
+	"""
+	def __init__(self, fileobj, span, prefix):
+		self.fileobj = fileobj
+		self.args = span.args
+		self.s = prefix + "_s"
+		self.bytes = prefix + "_bytes"
+		self.args.setdefault(self.s, 0.)
+		self.args.setdefault(self.bytes, 0)
+
+	def read(self, *args):
+		t = time.perf_counter()
+		data = self.fileobj.read(*args)
+		self.args[self.s] += time.perf_counter() - t
+		self.args[self.bytes] += len(data)
+		return data
+
+	def write(self, data):
+		t = time.perf_counter()
+		result = self.fileobj.write(data)
+		self.args[self.s] += time.perf_counter() - t
+		self.args[self.bytes] += len(data)
+		return result
+
+	def __getattr__(self, name):
+		return getattr(self.fileobj, name)
+
+
+#
+# =============================================================================
+#
+#                               Instrumentation
+#
+# =============================================================================
+#
+
+
+#
+# the originals of the functions replaced while tracing is enabled
+#
+
+
+_originals = {}
+
+
+#
+# the Table Streams being parsed and their Tables, by id() of the Stream.
+# the Tables' .append() methods have been shadowed, disable() restores
+# them if the Streams are still open
+#
+
+
+_streams = {}
+
+
+def _load_fileobj(*args, **kwargs):
+	with span("load"):
+		return _originals["load_fileobj"](*args, **kwargs)
+
+
+def _write_fileobj(*args, **kwargs):
+	with span("write"):
+		return _originals["write_fileobj"](*args, **kwargs)
+
+
+def _decompressor(fileobj, compress):
+	fileobj = _originals["_decompressor"](fileobj, compress)
+	current = span.current()
+	return _TimedFile(fileobj, current, "read") if current is not None else fileobj
+
+
+def _compressor(fileobj, compress, compresslevel):
+	fileobj = _originals["_compressor"](fileobj, compress, compresslevel)
+	current = span.current()
+	return _TimedFile(fileobj, current, "write") if current is not None else fileobj
+
+
+def _stream_config(self, parentNode):
+	_originals["Table.Stream.config"](self, parentNode)
+	# the span is not used as a context manager, it stays open until
+	# the end of the Stream element
+	self._span = span("parse", table = parentNode.Name, characters = 0, rows = 0, append_s = 0.).start()
+	# time the appending of rows by shadowing the Table's .append()
+	# method
+	append = parentNode.append
+	args = self._span.args
+	def timed_append(row):
+		t = time.perf_counter()
+		append(row)
+		args["append_s"] += time.perf_counter() - t
+		args["rows"] += 1
+	parentNode.append = timed_append
+	_streams[id(self)] = self, parentNode
+	return self
+
+
+def _stream_appendData(self, content):
+	try:
+		self._span.args["characters"] += len(content)
+	except AttributeError:
+		# Stream started before tracing was enabled
+		pass
+	_originals["Table.Stream.appendData"](self, content)
+
+
+def _end_stream(self):
+	"""
+	Remove the shadowing .append() method from the Stream's Table, and
+	end the Stream's span.
+	"""
+	tbl = _streams.pop(id(self))[1]
+	del tbl.append
+	self._span.end()
+	del self._span
+
+
+def _stream_endElement(self):
+	try:
+		_originals["Table.Stream.endElement"](self)
+	finally:
+		if hasattr(self, "_span"):
+			_end_stream(self)
+
+
+def _stream_write(self, *args, **kwargs):
+	with span("format", table = self.parentNode.Name, rows = len(self.parentNode)):
+		return _originals["Table.Stream.write"](self, *args, **kwargs)
+
+
+def _insert_from_url(url, *args, **kwargs):
+	with span("insert", url = url):
+		return _originals["insert_from_url"](url, *args, **kwargs)
+
+
+def _update_ids(*args, **kwargs):
+	with span("update_ids"):
+		return _originals["update_ids"](*args, **kwargs)
+
+
+def _build_indexes(*args, **kwargs):
+	with span("build_indexes"):
+		return _originals["build_indexes"](*args, **kwargs)
+
+
+#
+# (namespace, name, key in _originals, replacement)
+#
+
+
+_instrumentation = (
+	(ligolw_utils, "load_fileobj", "load_fileobj", _load_fileobj),
+	(ligolw_utils, "write_fileobj", "write_fileobj", _write_fileobj),
+	(ligolw_utils, "_decompressor", "_decompressor", _decompressor),
+	(ligolw_utils, "_compressor", "_compressor", _compressor),
+	(ligolw.Table.Stream, "config", "Table.Stream.config", _stream_config),
+	(ligolw.Table.Stream, "appendData", "Table.Stream.appendData", _stream_appendData),
+	(ligolw.Table.Stream, "endElement", "Table.Stream.endElement", _stream_endElement),
+	(ligolw.Table.Stream, "write", "Table.Stream.write", _stream_write),
+	(ligolw_sqlite, "insert_from_url", "insert_from_url", _insert_from_url),
+	(dbtables.idmapper, "update_ids", "update_ids", _update_ids),
+	(dbtables, "build_indexes", "build_indexes", _build_indexes),
+)
+
+
+#
+# =============================================================================
+#
+#                                  Interface
+#
+# =============================================================================
+#
+
+
+def enable():
+	"""
+	Start recording spans.  Functions imported by name from the
+	instrumented modules before this is called, for example with "from
+	ligo.lw.utils import load_filename", are not instrumented, but
+	load_filename() and the like call the instrumented versions.
+	"""
+	if _originals:
+		# already enabled
+		return
+	for namespace, name, key, replacement in _instrumentation:
+		_originals[key] = getattr(namespace, name)
+		setattr(namespace, name, replacement)
+
+
+def disable():
+	"""
+	Stop recording spans and restore the original functions.  The
+	recorded spans are kept.  The spans of Table Streams still being
+	parsed are ended, and the Tables' .append() methods restored.
+
+	Example:
+
+	>>> xmldoc = ligolw.Document()
+	>>> parser = ligolw.make_parser(ligolw.LIGOLWContentHandler(xmldoc))
+	>>> enable()
+	>>> parser.feed(b'<?xml version="1.0" encoding="utf-8" ?><LIGO_LW><Table Name="demo:table"><Column Name="x" Type="int_4s"/><Stream Name="demo:table" Type="Local" Delimiter=",">1,2,')
+	>>> tbl, = xmldoc.getElementsByTagName(ligolw.Table.tagName)
+	>>> "append" in vars(tbl)
+	True
+	>>> disable()
+	>>> "append" in vars(tbl)
+	False
+	>>> parser.feed(b'3</Stream></Table></LIGO_LW>')
+	>>> parser.close()
+	>>> [row.x for row in tbl]
+	[1, 2, 3]
+	>>> clear()
+	"""
+	for namespace, name, key, replacement in _instrumentation:
+		if key in _originals:
+			setattr(namespace, name, _originals.pop(key))
+	for stream, tbl in list(_streams.values()):
+		_end_stream(stream)
+
+
+def clear():
+	"""
+	Discard the recorded spans.
+	"""
+	del events[:]
+
+
+def dump(fileobj):
+	"""
+	Write the recorded spans to the text-mode file object in the Chrome
+	trace event (JSON) format.
+	"""
+	json.dump({"traceEvents": events, "displayTimeUnit": "ms", "otherData": {"version": __version__}}, fileobj)
+
+
+#
+# =============================================================================
+#
+#                                     Main
+#
+# =============================================================================
+#
+
+
+if __name__ == "__main__":
+	if len(sys.argv) < 3:
+		sys.exit("usage: %s trace.json program [arguments ...]" % sys.argv[0])
+	filename = sys.argv[1]
+	sys.argv = sys.argv[2:]
+	# like the shell, look for the program in $PATH, so installed
+	# programs like ligolw_add can be traced by name
+	if os.sep not in sys.argv[0] and not os.path.exists(sys.argv[0]):
+		sys.argv[0] = shutil.which(sys.argv[0]) or sys.argv[0]
+	enable()
+	try:
+		runpy.run_path(sys.argv[0], run_name = "__main__")
+	finally:
+		disable()
+		with open(filename, "w") as fileobj:
+			dump(fileobj)
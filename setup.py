@@ -1,4 +1,10 @@
+import os
+import tempfile
 from setuptools import setup, Extension
+# setuptools provides distutils if Python does not
+import distutils.ccompiler
+import distutils.errors
+import distutils.sysconfig
 
 
 __version__ = "1.8.3"
@@ -23,6 +29,49 @@ def macroreplace(filenames, substs):
 				outfile.write(line)
 
 
+def have(header, function = None, libraries = []):
+	"""
+	Autoconf-style feature test:  return True if a program that
+	includes header, and refers to function if not None, can be
+	compiled, and linked with libraries, by the compiler Python's
+	extension modules are built with.
+	"""
+	compiler = distutils.ccompiler.new_compiler()
+	distutils.sysconfig.customize_compiler(compiler)
+	with tempfile.TemporaryDirectory() as tmpdir:
+		source = os.path.join(tmpdir, "conftest.c")
+		with open(source, "w") as f:
+			f.write("#include <%s>\nint main(void) { %sreturn 0; }\n" % (header, ("(void) &%s; " % function) if function is not None else ""))
+		# a failed test is not an error, don't show the compiler's
+		# messages
+		stderr = os.dup(2)
+		with open(os.devnull, "w") as devnull:
+			os.dup2(devnull.fileno(), 2)
+		try:
+			objects = compiler.compile([source], output_dir = tmpdir)
+			compiler.link_executable(objects, "conftest", output_dir = tmpdir, libraries = libraries)
+		except (distutils.errors.CompileError, distutils.errors.LinkError):
+			return False
+		finally:
+			os.dup2(stderr, 2)
+			os.close(stderr)
+	return True
+
+
+# static probes for perf and bpftrace, and the SQLite virtual table
+# module, if available.  the virtual table module uses dlopen() to check
+# which SQLite library Python's sqlite3 module uses
+define_macros = []
+libraries = []
+if have("sys/sdt.h"):
+	define_macros.append(("HAVE_SYS_SDT_H", None))
+if have("sqlite3.h", "sqlite3_libversion", ["sqlite3"]):
+	define_macros.append(("HAVE_SQLITE3_H", None))
+	libraries.append("sqlite3")
+	if have("dlfcn.h", "dlopen", ["dl"]):
+		libraries.append("dl")
+
+
 macroreplace([
 	"ligo/lw/__init__.py.in",
 	"python-ligo-lw.spec.in",
@@ -57,12 +106,21 @@ setup(
 				"ligo/lw/tokenizer.Tokenizer.c",
 				"ligo/lw/tokenizer.RowBuilder.c",
 				"ligo/lw/tokenizer.RowDumper.c",
+				"ligo/lw/tokenizer.pack.c",
+				"ligo/lw/tokenizer.sort.c",
+				"ligo/lw/tokenizer.index.c",
+				"ligo/lw/tokenizer.hash.c",
+				"ligo/lw/tokenizer.properties.c",
+				"ligo/lw/tokenizer.vtab.c",
 			],
-			include_dirs = ["ligo/lw"]
+			include_dirs = ["ligo/lw"],
+			define_macros = define_macros,
+			libraries = libraries
 		),
 	],
 	scripts = [
 		"bin/ligolw_add",
+		"bin/ligolw_compare",
 		"bin/ligolw_cut",
 		"bin/ligolw_no_ilwdchar",
 		"bin/ligolw_print",
@@ -0,0 +1,336 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2026  Kipp Cannon
+#
+# This program is free software; you can redistribute it and/or modify it
+# under the terms of the GNU General Public License as published by the
+# Free Software Foundation; either version 2 of the License, or (at your
+# option) any later version.
+#
+# This program is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General
+# Public License for more details.
+#
+# You should have received a copy of the GNU General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+
+
+"""
+Measure the throughput of the command-line tools on synthetic inputs.
+
+Generates many small documents, like the output of individual analysis
+jobs, and a few large documents, like the result of merging them, with
+the large documents in uncompressed, gzip, bzip2 and xz variants.  Each
+tool is run in its common modes on these, several times, and the best
+wall-clock time is reported along with the CPU time and peak RSS of that
+run (from the rusage of the child process).  The report is JSON, keyed by
+tool and mode so reports from different versions can be compared, which
+--compare does.  The inputs are generated from a fixed random seed so they
+are the same every time for the same size options.
+"""
+
+
+import datetime
+import json
+from optparse import OptionParser
+import os
+import platform
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+
+from ligo.lw import __version__
+from ligo.lw import ligolw
+from ligo.lw import lsctables
+from ligo.lw import utils as ligolw_utils
+
+
+#
+# =============================================================================
+#
+#                                 Command Line
+#
+# =============================================================================
+#
+
+
+def parse_command_line():
+	parser = OptionParser(
+		description = "Time the command-line tools on synthetic inputs and write a JSON report."
+	)
+	parser.add_option("--small-files", metavar = "n", type = "int", default = 200, help = "Number of small documents (default = 200).")
+	parser.add_option("--small-rows", metavar = "n", type = "int", default = 200, help = "Number of sngl_inspiral rows in each small document (default = 200).")
+	parser.add_option("--large-files", metavar = "n", type = "int", default = 2, help = "Number of large documents (default = 2).")
+	parser.add_option("--large-rows", metavar = "n", type = "int", default = 50000, help = "Number of sngl_inspiral rows in each large document (default = 50000).")
+	parser.add_option("--repeat", metavar = "n", type = "int", default = 3, help = "Run each benchmark this many times and report the fastest (default = 3).")
+	parser.add_option("--bindir", metavar = "path", help = "Directory containing the tools (default = search $PATH).")
+	parser.add_option("--workdir", metavar = "path", help = "Directory in which to generate the inputs (default = a temporary directory, deleted when done).")
+	parser.add_option("-o", "--output", metavar = "filename", help = "Write the JSON report to this file (default = stdout).")
+	parser.add_option("--compare", metavar = "filename", help = "Compare the results to this earlier report, and print the ratios of the times to stderr.")
+	parser.add_option("-v", "--verbose", action = "store_true", help = "Be verbose.")
+	options, args = parser.parse_args()
+	if args:
+		raise ValueError("unexpected arguments %s" % ", ".join(args))
+	if options.repeat < 1:
+		raise ValueError("--repeat must be at least 1")
+	return options
+
+
+#
+# =============================================================================
+#
+#                                    Inputs
+#
+# =============================================================================
+#
+
+
+def row_factory(tbl, rng):
+	"""
+	Return a function that returns sngl_inspiral rows with values of
+	the right types in every column, given the event and process IDs.
+	"""
+	strings = {"ifo": ("H1", "L1", "V1"), "search": ("gstlal",), "channel": ("GDS-CALIB_STRAIN", "Hrec_hoft_16384Hz")}
+	columns = []
+	for colname, coltype in zip(tbl.columnnames, tbl.columntypes):
+		if coltype == "lstring":
+			columns.append((colname, lambda choices = strings.get(colname, ("",)): rng.choice(choices)))
+		elif colname == "end_time":
+			columns.append((colname, lambda: rng.randint(1000000000, 1400000000)))
+		elif colname == "end_time_ns":
+			columns.append((colname, lambda: rng.randint(0, 999999999)))
+		elif coltype in ("int_4s", "int_8s"):
+			columns.append((colname, lambda: rng.randint(0, 1 << 30)))
+		else:
+			columns.append((colname, lambda: rng.uniform(-1e3, 1e3)))
+	def make_row(event_id, process_id):
+		row = tbl.RowType()
+		for colname, value in columns:
+			setattr(row, colname, value())
+		row.event_id = event_id
+		row.process_id = process_id
+		return row
+	return make_row
+
+
+def make_document(filename, rng, nprocesses, nrows):
+	"""
+	Write a document containing nprocesses process rows with their
+	process_params, and nrows sngl_inspiral rows divided among them.
+	"""
+	xmldoc = ligolw.Document()
+	xmldoc.appendChild(ligolw.LIGO_LW())
+	tbl = xmldoc.childNodes[-1].appendChild(lsctables.SnglInspiralTable.new())
+	make_row = row_factory(tbl, rng)
+	event_ids = iter(range(nrows))
+	for i in range(nprocesses):
+		process = xmldoc.register_process("benchmark", {"job": i, "seed": rng.randint(0, 1 << 30), "approximant": "TaylorF2"})
+		for j in range(nrows // nprocesses + (i < nrows % nprocesses)):
+			tbl.append(make_row(next(event_ids), process.process_id))
+		process.set_end_time_now()
+	ligolw_utils.write_filename(xmldoc, filename)
+	xmldoc.unlink()
+
+
+def make_inputs(workdir, options):
+	"""
+	Generate the input documents.  Returns a dictionary mapping input
+	set names to lists of filenames.
+	"""
+	rng = random.Random(5541)
+	inputs = {}
+	inputs["small"] = []
+	for i in range(options.small_files):
+		filename = os.path.join(workdir, "small_%04d.xml.gz" % i)
+		make_document(filename, rng, 1, options.small_rows)
+		inputs["small"].append(filename)
+	for ext in ("xml", "xml.gz", "xml.bz2", "xml.xz"):
+		inputs["large." + ext] = []
+	for i in range(options.large_files):
+		filename = os.path.join(workdir, "large_%d.xml" % i)
+		make_document(filename, rng, 20, options.large_rows)
+		inputs["large.xml"].append(filename)
+		xmldoc = ligolw_utils.load_filename(filename)
+		for ext in ("xml.gz", "xml.bz2", "xml.xz"):
+			variant = "%s.%s" % (filename[:-4], ext)
+			ligolw_utils.write_filename(xmldoc, variant)
+			inputs["large." + ext].append(variant)
+		xmldoc.unlink()
+	return inputs
+
+
+#
+# =============================================================================
+#
+#                                  Benchmarks
+#
+# =============================================================================
+#
+
+
+def run(argv, setup = None):
+	"""
+	Run setup() if not None (untimed), then the command, and return the
+	wall-clock time and the child's rusage.
+	"""
+	if setup is not None:
+		setup()
+	with open(os.devnull, "wb") as devnull:
+		t = time.perf_counter()
+		proc = subprocess.Popen(argv, stdout = devnull)
+		pid, status, rusage = os.wait4(proc.pid, 0)
+		t = time.perf_counter() - t
+	proc.returncode = os.waitstatus_to_exitcode(status)
+	if proc.returncode:
+		raise subprocess.CalledProcessError(proc.returncode, argv)
+	return t, rusage
+
+
+def benchmarks(tool, inputs, workdir):
+	"""
+	Yield (mode, input set name, argv, setup) tuples for the tool.
+	"""
+	def db(name):
+		return os.path.join(workdir, name + ".sqlite")
+	output = os.path.join(workdir, "output.xml")
+	large = [name for name in sorted(inputs) if name.startswith("large.")]
+
+	if tool == "ligolw_add":
+		yield "merge", "small", ["--output", output] + inputs["small"], None
+		yield "merge --streaming", "small", ["--streaming", "--output", output] + inputs["small"], None
+		for name in large:
+			yield "merge", name, ["--output", output] + inputs[name], None
+		yield "merge --streaming", "large.xml.gz", ["--streaming", "--output", output] + inputs["large.xml.gz"], None
+		yield "merge to .xml.gz", "large.xml", ["--output", output + ".gz"] + inputs["large.xml"], None
+	elif tool == "ligolw_sqlite":
+		yield "insert", "small", ["--replace", "--database", db("small")] + inputs["small"], None
+		for name in large:
+			yield "insert", name, ["--replace", "--database", db("large")] + inputs[name], None
+		yield "insert --preserve-ids", "large.xml.gz", ["--replace", "--preserve-ids", "--database", db("large_preserve")] + inputs["large.xml.gz"][:1], None
+		# the database from the "insert" benchmarks of the large
+		# inputs
+		yield "extract", "large.xml.gz", ["--database", db("large"), "--extract", output], None
+	elif tool == "ligolw_print":
+		for name in large:
+			yield "print", name, inputs[name], None
+			yield "print columns", name, ["--table", "sngl_inspiral", "--column", "end_time", "--column", "snr"] + inputs[name], None
+	elif tool == "ligolw_cut":
+		# ligolw_cut modifies its inputs, so work on copies
+		for name in large:
+			copies = [os.path.join(workdir, "cut_" + os.path.basename(filename)) for filename in inputs[name]]
+			setup = lambda inputs = inputs[name], copies = copies: [shutil.copyfile(src, dst) for src, dst in zip(inputs, copies)]
+			yield "delete-column", name, ["--delete-column", "sngl_inspiral:Gamma0", "--delete-column", "sngl_inspiral:Gamma1"] + copies, setup
+			yield "delete-table", name, ["--delete-table", "sngl_inspiral"] + copies, setup
+
+
+def run_benchmarks(inputs, workdir, options):
+	"""
+	Run all benchmarks, and return a list of results.
+	"""
+	results = []
+	for tool in ("ligolw_add", "ligolw_sqlite", "ligolw_print", "ligolw_cut"):
+		path = shutil.which(tool, path = options.bindir)
+		if path is None:
+			raise ValueError("cannot find %s" % tool)
+		for mode, name, args, setup in benchmarks(tool, inputs, workdir):
+			if options.verbose:
+				sys.stderr.write("%s %s %s ..." % (tool, mode, name))
+				sys.stderr.flush()
+			runs = [run([sys.executable, path] + args, setup) for i in range(options.repeat)]
+			t, rusage = min(runs, key = lambda t_rusage: t_rusage[0])
+			input_bytes = sum(os.stat(filename).st_size for filename in inputs[name])
+			rows = len(inputs[name]) * (options.small_rows if name == "small" else options.large_rows)
+			results.append({
+				"tool": tool,
+				"mode": mode,
+				"input": name,
+				"input_files": len(inputs[name]),
+				"input_bytes": input_bytes,
+				"input_rows": rows,
+				"seconds": t,
+				"all_seconds": [t for t, rusage in runs],
+				"user_seconds": rusage.ru_utime,
+				"system_seconds": rusage.ru_stime,
+				"peak_rss": rusage.ru_maxrss,
+				"rows_per_second": rows / t,
+				"input_bytes_per_second": input_bytes / t
+			})
+			if options.verbose:
+				sys.stderr.write(" %.3f s, %.0f rows/s\n" % (t, rows / t))
+	return results
+
+
+def compare(report, filename):
+	"""
+	Print the ratio of the times in the report to those in the earlier
+	report in the file.
+	"""
+	with open(filename) as f:
+		old_report = json.load(f)
+	if old_report["parameters"] != report["parameters"]:
+		sys.stderr.write("warning: '%s' was made with different input sizes or repeats\n" % filename)
+	old = dict(((result["tool"], result["mode"], result["input"]), result) for result in old_report["results"])
+	results = report["results"]
+	for result in results:
+		key = result["tool"], result["mode"], result["input"]
+		if key in old:
+			sys.stderr.write("%-14s %-22s %-14s %8.3f s -> %8.3f s  (x %.2f)\n" % (key + (old[key]["seconds"], result["seconds"], result["seconds"] / old[key]["seconds"])))
+		else:
+			sys.stderr.write("%-14s %-22s %-14s %-12s -> %8.3f s\n" % (key + ("(new)", result["seconds"])))
+
+
+#
+# =============================================================================
+#
+#                                     Main
+#
+# =============================================================================
+#
+
+
+options = parse_command_line()
+
+workdir = options.workdir or tempfile.mkdtemp(prefix = "ligolw_benchmark_")
+try:
+	if options.verbose:
+		sys.stderr.write("generating inputs in '%s' ...\n" % workdir)
+	inputs = make_inputs(workdir, options)
+	results = run_benchmarks(inputs, workdir, options)
+finally:
+	if options.workdir is None:
+		shutil.rmtree(workdir)
+
+report = {
+	"version": __version__,
+	"date": datetime.datetime.now(datetime.timezone.utc).isoformat(),
+	"python": platform.python_version(),
+	"platform": platform.platform(),
+	"machine": platform.machine(),
+	"cpus": os.cpu_count(),
+	"peak_rss_units": "bytes" if sys.platform == "darwin" else "kiB",
+	"parameters": {
+		"small_files": options.small_files,
+		"small_rows": options.small_rows,
+		"large_files": options.large_files,
+		"large_rows": options.large_rows,
+		"repeat": options.repeat
+	},
+	"results": results
+}
+
+if options.output is None:
+	json.dump(report, sys.stdout, indent = "\t")
+	sys.stdout.write("\n")
+else:
+	with open(options.output, "w") as f:
+		json.dump(report, f, indent = "\t")
+		f.write("\n")
+
+if options.compare is not None:
+	compare(report, options.compare)
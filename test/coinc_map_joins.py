@@ -0,0 +1,34 @@
+"""
+Print the rows of the coinc_event_map Table of a document with each of
+their IDs replaced by the position of the row it identifies in its Table,
+so that documents in which the same rows have been assigned different IDs
+can be compared.
+
+Usage:  python coinc_map_joins.py document.xml
+"""
+
+
+import sys
+
+
+from ligo.lw import ligolw
+from ligo.lw import lsctables
+from ligo.lw import utils as ligolw_utils
+
+
+xmldoc = ligolw_utils.load_filename(sys.argv[1])
+coinc_map = lsctables.CoincMapTable.get_table(xmldoc)
+if not coinc_map:
+	sys.exit("no coinc_event_map rows")
+
+index = {}
+for name in {"coinc_event"} | {row.table_name for row in coinc_map}:
+	tbl = ligolw.Table.get_table(xmldoc, name)
+	for i, row in enumerate(tbl):
+		key = name, getattr(row, tbl.next_id.column_name)
+		if key in index:
+			sys.exit("duplicate ID %s:%d" % key)
+		index[key] = i
+
+for row in coinc_map:
+	print(index["coinc_event", row.coinc_event_id], row.table_name, index[row.table_name, row.event_id])
@@ -41,6 +41,22 @@ echo
 echo "ligolw_sqlite test 2:  success"
 echo "ligolw_add and ligolw_sqlite produced identical merged documents"
 
+#
+# does a resumable insert produce the same document?
+#
+
+echo
+echo "ligolw_sqlite test 3:  resumable merge and compare to ligolw_add"
+echo "--------------------------------------------------------------------"
+ligolw_sqlite --verbose --resumable --database ${BASE}.sqlite file://${PWD}/${BASE}_input.xml.gz ${BASE}_input.xml.gz
+ligolw_sqlite --verbose --database ${BASE}.sqlite --extract ${BASE}_output.xml
+xmlcanonicalize ${BASE}_output.xml || exit
+cmp ${BASE}_ref.xml ${BASE}_output.xml || exit
+rm -vf ${BASE}.sqlite ${BASE}_output.xml
+echo
+echo "ligolw_sqlite test 3:  success"
+echo "ligolw_add and a resumable ligolw_sqlite produced identical merged documents"
+
 #
 # does ligolw_sqlite produce the same document as above if the input
 # documents are .sqlite files (converted from the original .xml input).
@@ -48,7 +64,7 @@ echo "ligolw_add and ligolw_sqlite produced identical merged documents"
 #
 
 echo
-echo "ligolw_sqlite test 3:  merge .sqlite files and compare to ligolw_add"
+echo "ligolw_sqlite test 4:  merge .sqlite files and compare to ligolw_add"
 echo "--------------------------------------------------------------------"
 ligolw_sqlite --verbose --preserve-ids --replace --database ${BASE}_input.sqlite ${BASE}_input.xml.gz
 ligolw_sqlite --verbose --replace --tmp-space ${TMPDIR:-/tmp} --database ${BASE}.sqlite --extract ${BASE}_output.xml file://${PWD}/${BASE}_input.sqlite ${BASE}_input.sqlite
@@ -56,5 +72,5 @@ xmlcanonicalize ${BASE}_ref.xml ${BASE}_output.xml || exit
 cmp ${BASE}_ref.xml ${BASE}_output.xml || exit
 rm -vf ${BASE}_ref.xml ${BASE}_input.sqlite ${BASE}.sqlite ${BASE}_output.xml
 echo
-echo "ligolw_sqlite test 3:  success"
+echo "ligolw_sqlite test 4:  success"
 echo "ligolw_add and ligolw_sqlite produced identical merged documents"
@@ -0,0 +1,9 @@
+#!/usr/bin/env python3
+
+import doctest
+import sys
+from ligo.lw import dbtables
+
+if __name__ == '__main__':
+	failures = doctest.testmod(dbtables)[0]
+	sys.exit(bool(failures))
@@ -0,0 +1,9 @@
+#!/usr/bin/env python3
+
+import doctest
+import sys
+from ligo.lw.utils import compare
+
+if __name__ == '__main__':
+	failures = doctest.testmod(compare)[0]
+	sys.exit(bool(failures))
@@ -0,0 +1,9 @@
+#!/usr/bin/env python3
+
+import doctest
+import sys
+from ligo.lw.utils import ligolw_sqlite
+
+if __name__ == '__main__':
+	failures = doctest.testmod(ligolw_sqlite)[0]
+	sys.exit(bool(failures))